@@ -4,8 +4,26 @@
 void LoadDataApp::Init()
 {
     auto Filename = std::filesystem::current_path() / "../Resources/Data/data.txt";
-    auto Data = Utility::LoadFile(Filename.string().c_str());
-    DEBUG_DISPLAY("%s", Data.c_str());
+
+    m_FileReader.Init();
+
+    // Nothing else to do meanwhile, an application would poll the future or use the callback
+    ReadRequest Request;
+    Request.Path = Filename;
+    ReadResult Result = m_FileReader.Read(std::move(Request)).get();
+
+    CHECK(Result.Status == ReadStatus::COMPLETED, "Failed to load file at %s",
+        Filename.string().c_str());
+
+    // The data is not null terminated, a string view is copied by its size
+    DEBUG_DISPLAY("%.*s", static_cast<int>(Result.Size),
+        std::string_view(reinterpret_cast<const char*>(Result.Data), Result.Size));
+}
+
+void LoadDataApp::Destroy()
+{
+    m_FileReader.LogStatistics();
+    m_FileReader.Destroy();
 }
 
 START_APPLICATION(LoadDataApp);
\ No newline at end of file
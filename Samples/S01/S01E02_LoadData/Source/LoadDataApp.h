@@ -1,10 +1,14 @@
 #pragma once
 #include "Core/Application.h"
+#include "Core/AsyncFileReader.h"
 
 class LoadDataApp : public IApplication
 {
 public:
     void Init() override;
-    void Destroy() override {};
+    void Destroy() override;
     void Run() override {};
+
+private:
+    AsyncFileReader m_FileReader;
 };
\ No newline at end of file
@@ -1,7 +1,15 @@
 #include "WindowApp.h"
 #include "Core/Entrypoint.h"
 
-WindowApp::WindowApp() : Application({"S01E03 Window", 800, 600}) {}
+static ApplicationInfo GetApplicationInfo()
+{
+    ApplicationInfo Info = {"S01E03 Window", 800, 600};
+    // Keeps the event log readable and the loop from spinning a core
+    Info.TargetFrameRate = 10.0f;
+    return Info;
+}
+
+WindowApp::WindowApp() : Application(GetApplicationInfo()) {}
 
 void WindowApp::OnInit()
 {
@@ -16,7 +24,6 @@ void WindowApp::OnDestroy()
 void WindowApp::OnUpdate(float DeltaTime)
 {
     DEBUG_DISPLAY("OnUpdate(%.2f)", DeltaTime);
-    Sleep(100);
 }
 
 void WindowApp::OnKeyDown(int KeyCode)
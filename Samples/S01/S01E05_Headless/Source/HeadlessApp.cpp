@@ -0,0 +1,52 @@
+#include "HeadlessApp.h"
+#include "Core/Entrypoint.h"
+
+#define NUM_BENCHMARK_FRAMES 1000
+
+HeadlessApp::HeadlessApp()
+    : VulkanApplication({.WindowTitle = "Headless",
+          .WindowWidth = 800,
+          .WindowHeight = 600,
+          .Headless = true}),
+      m_NumFrames(0),
+      m_TotalTime(0.0f)
+{
+}
+
+void HeadlessApp::OnInit() {}
+
+void HeadlessApp::OnDestroy()
+{
+    DEBUG_DISPLAY("Rendered %u frames in %.2f ms (%.3f ms/frame)", m_NumFrames, m_TotalTime,
+        m_TotalTime / m_NumFrames);
+}
+
+void HeadlessApp::OnUpdate(float DeltaTime)
+{
+    uint32_t ImageIndex = 0;
+    if (!AcquireImageIndex(&ImageIndex))
+    {
+        return;
+    }
+
+    VkCommandBuffer CommandBuffer = BeginCommandBuffer();
+
+    BeginRenderPass(CommandBuffer);
+
+    EndRenderPass(CommandBuffer);
+
+    EndCommandBuffer(CommandBuffer);
+
+    Submit(CommandBuffer);
+
+    Present();
+
+    m_TotalTime += DeltaTime;
+
+    if (++m_NumFrames == NUM_BENCHMARK_FRAMES)
+    {
+        Close();
+    }
+}
+
+START_APPLICATION(HeadlessApp);
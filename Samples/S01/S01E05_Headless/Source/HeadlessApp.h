@@ -0,0 +1,18 @@
+#pragma once
+#include "Core/VulkanApplication.h"
+#include "pch.h"
+
+class HeadlessApp : public VulkanApplication
+{
+public:
+    HeadlessApp();
+    ~HeadlessApp() = default;
+
+protected:
+    void OnInit();
+    void OnDestroy();
+    void OnUpdate(float DeltaTime);
+
+    uint32_t m_NumFrames;
+    float m_TotalTime;
+};
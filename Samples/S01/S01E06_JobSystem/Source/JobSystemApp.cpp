@@ -0,0 +1,95 @@
+#include "JobSystemApp.h"
+
+#define NUM_ELEMENTS (1 << 22)
+#define BATCH_SIZE 4096
+#define NUM_ITERATIONS 8
+
+void JobSystemApp::Init()
+{
+    m_Input.resize(NUM_ELEMENTS);
+    m_Output.resize(NUM_ELEMENTS);
+
+    for (uint32_t Index = 0; Index < NUM_ELEMENTS; ++Index)
+    {
+        m_Input[Index] = static_cast<float>(Index % 1024) * 0.01f;
+    }
+}
+
+void JobSystemApp::Destroy()
+{
+    m_Input.clear();
+    m_Output.clear();
+}
+
+void JobSystemApp::Run()
+{
+    uint32_t MaxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    float BaseTime = 0.0f;
+
+    // Powers of two up to the core count, then the core count itself
+    std::vector<uint32_t> ThreadCounts;
+    for (uint32_t NumThreads = 1; NumThreads < MaxThreads; NumThreads *= 2)
+    {
+        ThreadCounts.push_back(NumThreads);
+    }
+    ThreadCounts.push_back(MaxThreads);
+
+    for (uint32_t NumThreads : ThreadCounts)
+    {
+        float Time = RunBenchmark(NumThreads);
+        BaseTime = NumThreads == 1 ? Time : BaseTime;
+
+        Utility::Printf("Threads: %2u | Time: %8.2f ms | Speedup: %5.2fx | Efficiency: %5.1f%%\n",
+            NumThreads, Time, BaseTime / Time, 100.0f * BaseTime / (Time * NumThreads));
+    }
+}
+
+float JobSystemApp::RunBenchmark(uint32_t NumThreads)
+{
+    JobSystem Jobs;
+    Jobs.Init(NumThreads);
+
+    Timer BenchmarkTimer;
+
+    for (uint32_t Iteration = 0; Iteration < NUM_ITERATIONS; ++Iteration)
+    {
+        JobCounter TransformCounter;
+        JobCounter ReduceCounter;
+        std::atomic<uint32_t> NumPositive = 0;
+
+        Jobs.ParallelFor(NUM_ELEMENTS, BATCH_SIZE,
+            [this](uint32_t Begin, uint32_t End)
+            {
+                for (uint32_t Index = Begin; Index < End; ++Index)
+                {
+                    float Value = m_Input[Index];
+                    m_Output[Index] = std::sin(Value) * std::cos(Value) + std::sqrt(Value);
+                }
+            },
+            &TransformCounter);
+
+        // The reduction only starts once every transform batch has retired
+        Jobs.ParallelFor(NUM_ELEMENTS, BATCH_SIZE,
+            [this, &NumPositive](uint32_t Begin, uint32_t End)
+            {
+                uint32_t Count = 0;
+                for (uint32_t Index = Begin; Index < End; ++Index)
+                {
+                    Count += m_Output[Index] > 0.0f ? 1 : 0;
+                }
+                NumPositive.fetch_add(Count, std::memory_order_relaxed);
+            },
+            &ReduceCounter, &TransformCounter);
+
+        Jobs.Wait(ReduceCounter);
+    }
+
+    BenchmarkTimer.Tick();
+
+    Jobs.Destroy();
+
+    return BenchmarkTimer.GetDeltaTime();
+}
+
+START_APPLICATION(JobSystemApp);
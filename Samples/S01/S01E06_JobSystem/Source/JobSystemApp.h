@@ -0,0 +1,19 @@
+#pragma once
+#include "pch.h"
+#include "Core/Entrypoint.h"
+#include "Core/JobSystem.h"
+#include "Core/Timer.h"
+
+class JobSystemApp : public IApplication
+{
+public:
+    void Init() override;
+    void Destroy() override;
+    void Run() override;
+
+private:
+    float RunBenchmark(uint32_t NumThreads);
+
+    std::vector<float> m_Input;
+    std::vector<float> m_Output;
+};
@@ -0,0 +1,4 @@
+vec3 Palette(float T)
+{
+    return 0.5 + 0.5 * cos(6.28318 * (T + vec3(0.0, 0.33, 0.67)));
+}
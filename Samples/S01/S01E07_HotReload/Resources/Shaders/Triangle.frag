@@ -0,0 +1,15 @@
+#version 450
+#include "Common.glsl"
+
+layout(push_constant) uniform PushConstants
+{
+    float Time;
+};
+
+layout(location = 0) in vec2 InPosition;
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+    OutColor = vec4(Palette(Time * 0.25 + InPosition.x * 0.5), 1.0);
+}
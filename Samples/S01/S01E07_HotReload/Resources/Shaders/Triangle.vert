@@ -0,0 +1,11 @@
+#version 450
+
+layout(location = 0) out vec2 OutPosition;
+
+const vec2 Positions[3] = vec2[](vec2(0.0, -0.6), vec2(0.6, 0.6), vec2(-0.6, 0.6));
+
+void main()
+{
+    OutPosition = Positions[gl_VertexIndex];
+    gl_Position = vec4(Positions[gl_VertexIndex], 0.0, 1.0);
+}
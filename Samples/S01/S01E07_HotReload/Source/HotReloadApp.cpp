@@ -0,0 +1,190 @@
+#include "HotReloadApp.h"
+#include "Core/Entrypoint.h"
+#include "Core/VulkanUtility.h"
+
+// Horizontal strips of the screen, each recorded by one job
+#define NUM_BANDS 8
+
+static ApplicationInfo GetApplicationInfo()
+{
+    ApplicationInfo Info = {"Hot Reload", 800, 600};
+    Info.ShaderDirectories = {"Resources/Shaders"};
+    Info.ShaderHotReload = true;
+    // Pipelines no longer depend on a render pass, rebuilds only need the back buffer format
+    Info.DynamicRendering = true;
+    // Every job system thread, the main one included, records into a command pool of its own
+    Info.WorkerThreads = 4;
+    Info.RecordingThreads = Info.WorkerThreads;
+    return Info;
+}
+
+HotReloadApp::HotReloadApp()
+    : VulkanApplication(GetApplicationInfo()),
+      m_PipelineLayout(VK_NULL_HANDLE),
+      m_Pipeline(nullptr),
+      m_Generation(0),
+      m_Time(0.0f),
+      m_BandCommandBuffers(NUM_BANDS, VK_NULL_HANDLE)
+{
+}
+
+void HotReloadApp::OnInit()
+{
+    VkPushConstantRange PushConstantRange = {};
+    PushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    PushConstantRange.size = sizeof(float);
+
+    VkPipelineLayoutCreateInfo LayoutInfo = {};
+    LayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    LayoutInfo.pushConstantRangeCount = 1;
+    LayoutInfo.pPushConstantRanges = &PushConstantRange;
+    VULKAN_RESULT(vkCreatePipelineLayout(m_Device, &LayoutInfo, nullptr, &m_PipelineLayout));
+
+    // Editing either shader or Common.glsl while running rebuilds the pipeline
+    std::vector<ShaderDesc> Shaders = {
+        {"Resources/Shaders/Triangle.vert", ShaderStage::VERTEX},
+        {"Resources/Shaders/Triangle.frag", ShaderStage::FRAGMENT},
+    };
+
+    m_Pipeline = CreateReloadablePipeline(Shaders,
+        [this](const std::vector<VkPipelineShaderStageCreateInfo>& Stages)
+        { return BuildPipeline(Stages); });
+}
+
+void HotReloadApp::OnDestroy()
+{
+    DeviceWaitIdle();
+
+    DestroyReloadablePipeline(m_Pipeline);
+
+    vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+    m_PipelineLayout = VK_NULL_HANDLE;
+}
+
+void HotReloadApp::OnUpdate(float DeltaTime)
+{
+    m_Time += DeltaTime;
+
+    uint32_t ImageIndex = 0;
+    if (!AcquireImageIndex(&ImageIndex))
+    {
+        return;
+    }
+
+    if (m_Pipeline->Generation != m_Generation)
+    {
+        m_Generation = m_Pipeline->Generation;
+        DEBUG_DISPLAY("Pipeline reloaded (generation %u)", m_Generation);
+    }
+
+    VkCommandBuffer CommandBuffer = BeginCommandBuffer();
+
+    BeginRenderPass(CommandBuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    JobCounter Counter;
+    m_JobSystem.ParallelFor(NUM_BANDS, 1,
+        [this](uint32_t Begin, uint32_t End)
+        {
+            for (uint32_t Band = Begin; Band < End; ++Band)
+            {
+                m_BandCommandBuffers[Band] = RecordBand(Band);
+            }
+        },
+        &Counter);
+    m_JobSystem.Wait(Counter);
+
+    // Executed in band order whichever thread recorded them
+    ExecuteCommandBuffers(CommandBuffer, m_BandCommandBuffers);
+
+    EndRenderPass(CommandBuffer);
+
+    EndCommandBuffer(CommandBuffer);
+
+    Submit(CommandBuffer);
+
+    Present();
+}
+
+VkCommandBuffer HotReloadApp::RecordBand(uint32_t Band)
+{
+    VkCommandBuffer CommandBuffer = BeginSecondaryCommandBuffer(m_JobSystem.GetThreadIndex());
+
+    uint32_t Top = m_Info.WindowHeight * Band / NUM_BANDS;
+    uint32_t Bottom = m_Info.WindowHeight * (Band + 1) / NUM_BANDS;
+
+    // The triangle still covers the whole screen, the scissor keeps it to the band
+    VkViewport Viewport = {0.0f, 0.0f, static_cast<float>(m_Info.WindowWidth),
+        static_cast<float>(m_Info.WindowHeight), 0.0f, 1.0f};
+    VkRect2D Scissor = {{0, static_cast<int32_t>(Top)}, {m_Info.WindowWidth, Bottom - Top}};
+    vkCmdSetViewport(CommandBuffer, 0, 1, &Viewport);
+    vkCmdSetScissor(CommandBuffer, 0, 1, &Scissor);
+
+    vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline->Handle);
+    vkCmdPushConstants(CommandBuffer, m_PipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+        sizeof(float), &m_Time);
+    vkCmdDraw(CommandBuffer, 3, 1, 0, 0);
+
+    EndCommandBuffer(CommandBuffer);
+
+    return CommandBuffer;
+}
+
+VkPipeline HotReloadApp::BuildPipeline(const std::vector<VkPipelineShaderStageCreateInfo>& Stages)
+{
+    VkPipelineVertexInputStateCreateInfo VertexInputState = {};
+    VertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo InputAssemblyState = {};
+    InputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    InputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo ViewportState = {};
+    ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    ViewportState.viewportCount = 1;
+    ViewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo RasterizationState = {};
+    RasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    RasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    RasterizationState.cullMode = VK_CULL_MODE_NONE;
+    RasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    RasterizationState.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo MultisampleState = {};
+    MultisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    MultisampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendAttachmentState BlendAttachment = {};
+    BlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                     VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo ColorBlendState = {};
+    ColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    ColorBlendState.attachmentCount = 1;
+    ColorBlendState.pAttachments = &BlendAttachment;
+
+    VkDynamicState DynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo DynamicState = {};
+    DynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    DynamicState.dynamicStateCount = 2;
+    DynamicState.pDynamicStates = DynamicStates;
+
+    VkGraphicsPipelineCreateInfo PipelineInfo = {};
+    PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    PipelineInfo.stageCount = static_cast<uint32_t>(Stages.size());
+    PipelineInfo.pStages = Stages.data();
+    PipelineInfo.pVertexInputState = &VertexInputState;
+    PipelineInfo.pInputAssemblyState = &InputAssemblyState;
+    PipelineInfo.pViewportState = &ViewportState;
+    PipelineInfo.pRasterizationState = &RasterizationState;
+    PipelineInfo.pMultisampleState = &MultisampleState;
+    PipelineInfo.pColorBlendState = &ColorBlendState;
+    PipelineInfo.pDynamicState = &DynamicState;
+    PipelineInfo.layout = m_PipelineLayout;
+    PipelineInfo.renderPass = m_RenderPass;
+    PipelineInfo.subpass = 0;
+
+    return CreateGraphicsPipeline(PipelineInfo);
+}
+
+START_APPLICATION(HotReloadApp);
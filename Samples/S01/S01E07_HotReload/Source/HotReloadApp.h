@@ -0,0 +1,25 @@
+#pragma once
+#include "Core/VulkanApplication.h"
+#include "pch.h"
+
+class HotReloadApp : public VulkanApplication
+{
+public:
+    HotReloadApp();
+    ~HotReloadApp() = default;
+
+protected:
+    void OnInit();
+    void OnDestroy();
+    void OnUpdate(float DeltaTime);
+
+private:
+    VkPipeline BuildPipeline(const std::vector<VkPipelineShaderStageCreateInfo>& Stages);
+    VkCommandBuffer RecordBand(uint32_t Band);
+
+    VkPipelineLayout m_PipelineLayout;
+    ReloadablePipeline* m_Pipeline;
+    uint32_t m_Generation;
+    float m_Time;
+    std::vector<VkCommandBuffer> m_BandCommandBuffers;
+};
@@ -0,0 +1,12 @@
+#version 450
+
+layout(location = 0) out vec3 OutColor;
+
+const vec2 Positions[3] = vec2[](vec2(0.0, -0.6), vec2(0.6, 0.6), vec2(-0.6, 0.6));
+const vec3 Colors[3] = vec3[](vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0));
+
+void main()
+{
+    OutColor = Colors[gl_VertexIndex];
+    gl_Position = vec4(Positions[gl_VertexIndex], 0.0, 1.0);
+}
@@ -0,0 +1,237 @@
+#include "RenderGraphApp.h"
+#include "Core/Entrypoint.h"
+#include "Core/VulkanUtility.h"
+
+static void BlitImage(VkCommandBuffer CommandBuffer, VkImage Source, VkExtent2D SourceExtent,
+    VkImage Destination, VkExtent2D DestinationExtent)
+{
+    VkImageBlit Region = {};
+    Region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    Region.srcOffsets[1] = {static_cast<int32_t>(SourceExtent.width),
+        static_cast<int32_t>(SourceExtent.height), 1};
+    Region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    Region.dstOffsets[1] = {static_cast<int32_t>(DestinationExtent.width),
+        static_cast<int32_t>(DestinationExtent.height), 1};
+
+    vkCmdBlitImage(CommandBuffer, Source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Destination,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region, VK_FILTER_LINEAR);
+}
+
+static ApplicationInfo GetApplicationInfo()
+{
+    ApplicationInfo Info = {"Render Graph", 800, 600};
+    // CPU and GPU frame times of the run, the GPU times span the passes timed by the graph
+    Info.FrameStatisticsPath = "FrameStatistics.json";
+    return Info;
+}
+
+RenderGraphApp::RenderGraphApp()
+    : VulkanApplication(GetApplicationInfo()),
+      m_BackBuffer(RENDER_GRAPH_INVALID_RESOURCE),
+      m_PipelineLayout(VK_NULL_HANDLE),
+      m_Pipeline(VK_NULL_HANDLE)
+{
+}
+
+void RenderGraphApp::OnInit()
+{
+    m_Graph.Init(m_Device, m_MemoryAllocator);
+
+    VkFormat Format = m_BackBuffers[0].Format;
+    VkExtent2D Extent = {m_Info.WindowWidth, m_Info.WindowHeight};
+    VkExtent2D HalfExtent = {Extent.width / 2, Extent.height / 2};
+
+    RenderGraphResource SceneColor =
+        m_Graph.CreateImage("SceneColor", {Extent.width, Extent.height, Format});
+    RenderGraphResource HalfColor =
+        m_Graph.CreateImage("HalfColor", {HalfExtent.width, HalfExtent.height, Format});
+    // Same size as SceneColor but only alive after it, so both share one allocation
+    RenderGraphResource Upscaled =
+        m_Graph.CreateImage("Upscaled", {Extent.width, Extent.height, Format});
+    RenderGraphResource DebugView =
+        m_Graph.CreateImage("DebugView", {Extent.width, Extent.height, Format});
+
+    m_BackBuffer = m_Graph.ImportImage("BackBuffer", {Extent.width, Extent.height, Format},
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    RenderGraphPassBuilder ScenePass = m_Graph.AddPass("Scene",
+        [this](const RenderGraphContext& Context)
+        {
+            VkViewport Viewport = {0.0f, 0.0f, static_cast<float>(Context.Extent.width),
+                static_cast<float>(Context.Extent.height), 0.0f, 1.0f};
+            VkRect2D Scissor = {{0, 0}, Context.Extent};
+            vkCmdSetViewport(Context.CommandBuffer, 0, 1, &Viewport);
+            vkCmdSetScissor(Context.CommandBuffer, 0, 1, &Scissor);
+            vkCmdBindPipeline(Context.CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+            vkCmdDraw(Context.CommandBuffer, 3, 1, 0, 0);
+        });
+    ScenePass.WriteColor(SceneColor, VK_ATTACHMENT_LOAD_OP_CLEAR, {{0.1f, 0.1f, 0.1f, 1.0f}});
+
+    m_Graph
+        .AddPass("Downsample",
+            [=](const RenderGraphContext& Context)
+            {
+                BlitImage(Context.CommandBuffer, Context.Graph->GetImage(SceneColor), Extent,
+                    Context.Graph->GetImage(HalfColor), HalfExtent);
+            })
+        .Read(SceneColor, RenderGraphAccess::TRANSFER_SRC)
+        .Write(HalfColor, RenderGraphAccess::TRANSFER_DST);
+
+    m_Graph
+        .AddPass("Upsample",
+            [=](const RenderGraphContext& Context)
+            {
+                BlitImage(Context.CommandBuffer, Context.Graph->GetImage(HalfColor), HalfExtent,
+                    Context.Graph->GetImage(Upscaled), Extent);
+            })
+        .Read(HalfColor, RenderGraphAccess::TRANSFER_SRC)
+        .Write(Upscaled, RenderGraphAccess::TRANSFER_DST);
+
+    // Nothing reads DebugView, the pass is culled at compile time
+    m_Graph
+        .AddPass("Debug",
+            [=](const RenderGraphContext& Context)
+            {
+                BlitImage(Context.CommandBuffer, Context.Graph->GetImage(SceneColor), Extent,
+                    Context.Graph->GetImage(DebugView), Extent);
+            })
+        .Read(SceneColor, RenderGraphAccess::TRANSFER_SRC)
+        .Write(DebugView, RenderGraphAccess::TRANSFER_DST);
+
+    RenderGraphResource BackBuffer = m_BackBuffer;
+    m_Graph
+        .AddPass("Present",
+            [=](const RenderGraphContext& Context)
+            {
+                BlitImage(Context.CommandBuffer, Context.Graph->GetImage(Upscaled), Extent,
+                    Context.Graph->GetImage(BackBuffer), Extent);
+            })
+        .Read(Upscaled, RenderGraphAccess::TRANSFER_SRC)
+        .Write(BackBuffer, RenderGraphAccess::TRANSFER_DST);
+
+    m_Graph.Compile();
+    m_Graph.LogStatistics();
+
+    CreateScenePipeline(m_Graph.GetRenderPass(ScenePass.GetPass()));
+}
+
+void RenderGraphApp::OnDestroy()
+{
+    DeviceWaitIdle();
+
+    DestroyPipeline(m_Pipeline);
+
+    vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+    m_PipelineLayout = VK_NULL_HANDLE;
+
+    m_Graph.Destroy();
+}
+
+void RenderGraphApp::OnUpdate(float DeltaTime)
+{
+    uint32_t ImageIndex = 0;
+    if (!AcquireImageIndex(&ImageIndex))
+    {
+        return;
+    }
+
+    m_Graph.SetImportedImage(
+        m_BackBuffer, m_BackBuffers[ImageIndex].Image, m_BackBuffers[ImageIndex].ImageView);
+
+    VkCommandBuffer CommandBuffer = BeginCommandBuffer();
+
+    m_Graph.Execute(CommandBuffer, &m_GpuProfiler);
+
+    EndCommandBuffer(CommandBuffer);
+
+    Submit(CommandBuffer);
+
+    Present();
+}
+
+void RenderGraphApp::CreateScenePipeline(VkRenderPass RenderPass)
+{
+    VkPipelineLayoutCreateInfo LayoutInfo = {};
+    LayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    VULKAN_RESULT(vkCreatePipelineLayout(m_Device, &LayoutInfo, nullptr, &m_PipelineLayout));
+
+    std::vector<std::unique_ptr<ShaderBinary>> Binaries = CompileShaders({
+        {"Resources/Shaders/Triangle.vert", ShaderStage::VERTEX},
+        {"Resources/Shaders/Triangle.frag", ShaderStage::FRAGMENT},
+    });
+
+    VkPipelineShaderStageCreateInfo Stages[2] = {};
+    for (uint32_t Index = 0; Index < 2; ++Index)
+    {
+        CHECK(Binaries[Index]->IsValid(), "%s", Binaries[Index]->Log.c_str());
+
+        Stages[Index].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        Stages[Index].stage =
+            Index == 0 ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
+        Stages[Index].module = CreateShaderModule(*Binaries[Index]);
+        Stages[Index].pName = "main";
+    }
+
+    VkPipelineVertexInputStateCreateInfo VertexInputState = {};
+    VertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo InputAssemblyState = {};
+    InputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    InputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo ViewportState = {};
+    ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    ViewportState.viewportCount = 1;
+    ViewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo RasterizationState = {};
+    RasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    RasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    RasterizationState.cullMode = VK_CULL_MODE_NONE;
+    RasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    RasterizationState.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo MultisampleState = {};
+    MultisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    MultisampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendAttachmentState BlendAttachment = {};
+    BlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                     VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo ColorBlendState = {};
+    ColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    ColorBlendState.attachmentCount = 1;
+    ColorBlendState.pAttachments = &BlendAttachment;
+
+    VkDynamicState DynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo DynamicState = {};
+    DynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    DynamicState.dynamicStateCount = 2;
+    DynamicState.pDynamicStates = DynamicStates;
+
+    VkGraphicsPipelineCreateInfo PipelineInfo = {};
+    PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    PipelineInfo.stageCount = 2;
+    PipelineInfo.pStages = Stages;
+    PipelineInfo.pVertexInputState = &VertexInputState;
+    PipelineInfo.pInputAssemblyState = &InputAssemblyState;
+    PipelineInfo.pViewportState = &ViewportState;
+    PipelineInfo.pRasterizationState = &RasterizationState;
+    PipelineInfo.pMultisampleState = &MultisampleState;
+    PipelineInfo.pColorBlendState = &ColorBlendState;
+    PipelineInfo.pDynamicState = &DynamicState;
+    PipelineInfo.layout = m_PipelineLayout;
+    PipelineInfo.renderPass = RenderPass;
+    PipelineInfo.subpass = 0;
+
+    m_Pipeline = CreateGraphicsPipeline(PipelineInfo);
+
+    for (auto& Stage : Stages)
+    {
+        DestroyShaderModule(Stage.module);
+    }
+}
+
+START_APPLICATION(RenderGraphApp);
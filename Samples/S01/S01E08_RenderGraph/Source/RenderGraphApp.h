@@ -0,0 +1,24 @@
+#pragma once
+#include "Core/RenderGraph.h"
+#include "Core/VulkanApplication.h"
+#include "pch.h"
+
+class RenderGraphApp : public VulkanApplication
+{
+public:
+    RenderGraphApp();
+    ~RenderGraphApp() = default;
+
+protected:
+    void OnInit();
+    void OnDestroy();
+    void OnUpdate(float DeltaTime);
+
+private:
+    void CreateScenePipeline(VkRenderPass RenderPass);
+
+    RenderGraph m_Graph;
+    RenderGraphResource m_BackBuffer;
+    VkPipelineLayout m_PipelineLayout;
+    VkPipeline m_Pipeline;
+};
@@ -0,0 +1,21 @@
+#version 450
+
+layout(std430, binding = 0) readonly buffer Particles
+{
+    vec4 Positions[];
+};
+
+layout(location = 0) out vec3 OutColor;
+
+const float Size = 0.005;
+const vec2 Corners[6] =
+    vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, -1.0), vec2(1.0, 1.0),
+        vec2(-1.0, 1.0));
+
+void main()
+{
+    vec4 Particle = Positions[gl_VertexIndex / 6];
+
+    OutColor = mix(vec3(1.0, 0.6, 0.2), vec3(0.2, 0.6, 1.0), Particle.z);
+    gl_Position = vec4(Particle.xy + Corners[gl_VertexIndex % 6] * Size, 0.0, 1.0);
+}
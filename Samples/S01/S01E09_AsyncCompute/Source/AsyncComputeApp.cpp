@@ -0,0 +1,257 @@
+#include "AsyncComputeApp.h"
+#include "Core/Entrypoint.h"
+#include "Core/VulkanUtility.h"
+
+// A whole number of compute groups
+#define NUM_PARTICLES 65536
+// Matches local_size_x in Particles.comp
+#define PARTICLE_GROUP_SIZE 64
+
+AsyncComputeApp::AsyncComputeApp()
+    : VulkanApplication({"Async Compute", 800, 600}),
+      m_SetLayout(VK_NULL_HANDLE),
+      m_PipelineLayout(VK_NULL_HANDLE),
+      m_ComputePipeline(VK_NULL_HANDLE),
+      m_GraphicsPipeline(VK_NULL_HANDLE),
+      m_Time(0.0f)
+{
+}
+
+void AsyncComputeApp::OnInit()
+{
+    m_ParticleBuffers.resize(m_Frames.size());
+    for (auto& Buffer : m_ParticleBuffers)
+    {
+        Buffer = CreateBuffer(NUM_PARTICLES * 4 * sizeof(float),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+
+    CreatePipelines();
+}
+
+void AsyncComputeApp::OnDestroy()
+{
+    DeviceWaitIdle();
+
+    DestroyPipeline(m_GraphicsPipeline);
+    DestroyPipeline(m_ComputePipeline);
+
+    vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+    m_PipelineLayout = VK_NULL_HANDLE;
+
+    vkDestroyDescriptorSetLayout(m_Device, m_SetLayout, nullptr);
+    m_SetLayout = VK_NULL_HANDLE;
+
+    for (auto& Buffer : m_ParticleBuffers)
+    {
+        DestroyBuffer(Buffer);
+    }
+    m_ParticleBuffers.clear();
+}
+
+void AsyncComputeApp::OnUpdate(float DeltaTime)
+{
+    m_Time += DeltaTime;
+
+    uint32_t ImageIndex = 0;
+    if (!AcquireImageIndex(&ImageIndex))
+    {
+        return;
+    }
+
+    VulkanBuffer& Particles = m_ParticleBuffers[m_FrameIndex];
+    VkDescriptorSet Set = AllocateParticleSet(Particles);
+    VulkanOwnershipTransfer Transfer = GetParticleTransfer(Particles);
+
+    // The last draw from this buffer retired before the slot was handed out again. Its contents
+    // are overwritten, so the compute queue uses it without acquiring it back from graphics
+    VkCommandBuffer ComputeCommandBuffer = BeginComputeCommandBuffer();
+
+    vkCmdBindPipeline(ComputeCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipeline);
+    vkCmdBindDescriptorSets(ComputeCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_PipelineLayout, 0, 1, &Set, 0, nullptr);
+    vkCmdPushConstants(ComputeCommandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+        sizeof(float), &m_Time);
+    vkCmdDispatch(ComputeCommandBuffer, NUM_PARTICLES / PARTICLE_GROUP_SIZE, 1, 1);
+
+    ReleaseOwnership(ComputeCommandBuffer, Transfer);
+
+    EndCommandBuffer(ComputeCommandBuffer);
+
+    // Only the vertex shader waits, the graphics queue may start on anything before it
+    uint64_t ComputeValue = SubmitCompute(&ComputeCommandBuffer, 1);
+    AddGraphicsWait(GetComputeWait(ComputeValue, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT));
+
+    VkCommandBuffer CommandBuffer = BeginCommandBuffer();
+
+    AcquireOwnership(CommandBuffer, Transfer);
+
+    BeginRenderPass(CommandBuffer);
+
+    VkViewport Viewport = {0.0f, 0.0f, static_cast<float>(m_Info.WindowWidth),
+        static_cast<float>(m_Info.WindowHeight), 0.0f, 1.0f};
+    VkRect2D Scissor = {{0, 0}, {m_Info.WindowWidth, m_Info.WindowHeight}};
+    vkCmdSetViewport(CommandBuffer, 0, 1, &Viewport);
+    vkCmdSetScissor(CommandBuffer, 0, 1, &Scissor);
+
+    vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
+    vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0,
+        1, &Set, 0, nullptr);
+    vkCmdDraw(CommandBuffer, NUM_PARTICLES * 6, 1, 0, 0);
+
+    EndRenderPass(CommandBuffer);
+
+    EndCommandBuffer(CommandBuffer);
+
+    Submit(CommandBuffer);
+
+    Present();
+}
+
+VkDescriptorSet AsyncComputeApp::AllocateParticleSet(const VulkanBuffer& Buffer)
+{
+    VkDescriptorSet Set = AllocateDescriptorSet(m_SetLayout);
+
+    VkDescriptorBufferInfo BufferInfo = {Buffer.Handle, 0, VK_WHOLE_SIZE};
+
+    VkWriteDescriptorSet Write = {};
+    Write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    Write.dstSet = Set;
+    Write.dstBinding = 0;
+    Write.descriptorCount = 1;
+    Write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    Write.pBufferInfo = &BufferInfo;
+    vkUpdateDescriptorSets(m_Device, 1, &Write, 0, nullptr);
+
+    return Set;
+}
+
+VulkanOwnershipTransfer AsyncComputeApp::GetParticleTransfer(const VulkanBuffer& Buffer) const
+{
+    // Without a dedicated compute family both sides are one family and this is a plain barrier
+    VulkanOwnershipTransfer Transfer;
+    Transfer.Buffer = Buffer.Handle;
+    Transfer.SourceFamilyIndex = m_ComputeQueue.FamilyIndex;
+    Transfer.DestinationFamilyIndex = m_GraphicsQueue.FamilyIndex;
+    Transfer.SourceStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    Transfer.SourceAccess = VK_ACCESS_SHADER_WRITE_BIT;
+    Transfer.DestinationStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    Transfer.DestinationAccess = VK_ACCESS_SHADER_READ_BIT;
+    return Transfer;
+}
+
+void AsyncComputeApp::CreatePipelines()
+{
+    VkDescriptorSetLayoutBinding Binding = {};
+    Binding.binding = 0;
+    Binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    Binding.descriptorCount = 1;
+    Binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo SetLayoutInfo = {};
+    SetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    SetLayoutInfo.bindingCount = 1;
+    SetLayoutInfo.pBindings = &Binding;
+    VULKAN_RESULT(vkCreateDescriptorSetLayout(m_Device, &SetLayoutInfo, nullptr, &m_SetLayout));
+
+    VkPushConstantRange PushConstantRange = {};
+    PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    PushConstantRange.size = sizeof(float);
+
+    VkPipelineLayoutCreateInfo LayoutInfo = {};
+    LayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    LayoutInfo.setLayoutCount = 1;
+    LayoutInfo.pSetLayouts = &m_SetLayout;
+    LayoutInfo.pushConstantRangeCount = 1;
+    LayoutInfo.pPushConstantRanges = &PushConstantRange;
+    VULKAN_RESULT(vkCreatePipelineLayout(m_Device, &LayoutInfo, nullptr, &m_PipelineLayout));
+
+    std::vector<std::unique_ptr<ShaderBinary>> Binaries = CompileShaders({
+        {"Resources/Shaders/Particles.comp", ShaderStage::COMPUTE},
+        {"Resources/Shaders/Particles.vert", ShaderStage::VERTEX},
+        {"Resources/Shaders/Particles.frag", ShaderStage::FRAGMENT},
+    });
+
+    VkShaderStageFlagBits StageFlags[3] = {VK_SHADER_STAGE_COMPUTE_BIT,
+        VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT};
+
+    VkPipelineShaderStageCreateInfo Stages[3] = {};
+    for (uint32_t Index = 0; Index < 3; ++Index)
+    {
+        CHECK(Binaries[Index]->IsValid(), "%s", Binaries[Index]->Log.c_str());
+
+        Stages[Index].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        Stages[Index].stage = StageFlags[Index];
+        Stages[Index].module = CreateShaderModule(*Binaries[Index]);
+        Stages[Index].pName = "main";
+    }
+
+    VkComputePipelineCreateInfo ComputePipelineInfo = {};
+    ComputePipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    ComputePipelineInfo.stage = Stages[0];
+    ComputePipelineInfo.layout = m_PipelineLayout;
+
+    m_ComputePipeline = CreateComputePipeline(ComputePipelineInfo);
+
+    VkPipelineVertexInputStateCreateInfo VertexInputState = {};
+    VertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo InputAssemblyState = {};
+    InputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    InputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo ViewportState = {};
+    ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    ViewportState.viewportCount = 1;
+    ViewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo RasterizationState = {};
+    RasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    RasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    RasterizationState.cullMode = VK_CULL_MODE_NONE;
+    RasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    RasterizationState.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo MultisampleState = {};
+    MultisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    MultisampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendAttachmentState BlendAttachment = {};
+    BlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                     VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo ColorBlendState = {};
+    ColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    ColorBlendState.attachmentCount = 1;
+    ColorBlendState.pAttachments = &BlendAttachment;
+
+    VkDynamicState DynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo DynamicState = {};
+    DynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    DynamicState.dynamicStateCount = 2;
+    DynamicState.pDynamicStates = DynamicStates;
+
+    VkGraphicsPipelineCreateInfo PipelineInfo = {};
+    PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    PipelineInfo.stageCount = 2;
+    PipelineInfo.pStages = &Stages[1];
+    PipelineInfo.pVertexInputState = &VertexInputState;
+    PipelineInfo.pInputAssemblyState = &InputAssemblyState;
+    PipelineInfo.pViewportState = &ViewportState;
+    PipelineInfo.pRasterizationState = &RasterizationState;
+    PipelineInfo.pMultisampleState = &MultisampleState;
+    PipelineInfo.pColorBlendState = &ColorBlendState;
+    PipelineInfo.pDynamicState = &DynamicState;
+    PipelineInfo.layout = m_PipelineLayout;
+    PipelineInfo.renderPass = m_RenderPass;
+    PipelineInfo.subpass = 0;
+
+    m_GraphicsPipeline = CreateGraphicsPipeline(PipelineInfo);
+
+    for (auto& Stage : Stages)
+    {
+        DestroyShaderModule(Stage.module);
+    }
+}
+
+START_APPLICATION(AsyncComputeApp);
@@ -0,0 +1,28 @@
+#pragma once
+#include "Core/VulkanApplication.h"
+#include "pch.h"
+
+class AsyncComputeApp : public VulkanApplication
+{
+public:
+    AsyncComputeApp();
+    ~AsyncComputeApp() = default;
+
+protected:
+    void OnInit();
+    void OnDestroy();
+    void OnUpdate(float DeltaTime);
+
+private:
+    void CreatePipelines();
+    VkDescriptorSet AllocateParticleSet(const VulkanBuffer& Buffer);
+    VulkanOwnershipTransfer GetParticleTransfer(const VulkanBuffer& Buffer) const;
+
+    VkDescriptorSetLayout m_SetLayout;
+    VkPipelineLayout m_PipelineLayout;
+    VkPipeline m_ComputePipeline;
+    VkPipeline m_GraphicsPipeline;
+    // One per frame in flight, compute only overwrites a buffer once its last draw retired
+    std::vector<VulkanBuffer> m_ParticleBuffers;
+    float m_Time;
+};
@@ -5,8 +5,14 @@ Application::Application(const ApplicationInfo& Info)
       m_Fullscreen(Info.Fullscreen),
       m_WindowHandle(nullptr),
       m_ElapsedTime(0.0f),
-      m_FrameCount(0)
+      m_FrameCount(0),
+      m_CloseRequested(false)
 {
+    if (m_Info.Headless)
+    {
+        return;
+    }
+
     glfwSetErrorCallback(
         [](int ErrorCode, const char* Description) { DEBUG_ERROR("%s", Description); });
 
@@ -18,7 +24,24 @@ Application::Application(const ApplicationInfo& Info)
 
 void Application::Init()
 {
-    InitWindow();
+    Logger::Init();
+
+    if (!m_Info.LogFilePath.empty())
+    {
+        auto Sink = std::make_unique<FileLogSink>(m_Info.LogFilePath);
+        CHECK(Sink->IsOpen(), "Failed to open log file %s", m_Info.LogFilePath.c_str());
+        Logger::AddSink(std::move(Sink));
+    }
+
+    Profiler::Init();
+    PROFILE_THREAD("Main");
+
+    if (!m_Info.Headless)
+    {
+        InitWindow();
+    }
+
+    InitFrameLimiter();
 };
 
 void Application::InitWindow()
@@ -112,52 +135,122 @@ void Application::SetupWindowEvents()
 
 void Application::Run()
 {
-    DEBUG_ASSERT(m_WindowHandle != nullptr);
+    DEBUG_ASSERT(m_Info.Headless || m_WindowHandle != nullptr);
 
-    OnInit();
+    {
+        PROFILE_SCOPE("OnInit");
+        OnInit();
+    }
 
     m_Timer.Reset();
+    m_FrameLimiter.Reset();
 
-    while (!glfwWindowShouldClose(m_WindowHandle))
+    while (!ShouldClose())
     {
-        glfwPollEvents();
+        PROFILE_SCOPE("Frame");
+
+        if (!m_Info.Headless)
+        {
+            PROFILE_SCOPE("PollEvents");
+            glfwPollEvents();
+        }
 
         m_Timer.Tick();
-        CalculateFrameStats();
+        UpdateFrameStatistics();
+
+        {
+            PROFILE_SCOPE("OnUpdate");
+            OnUpdate(m_Timer.GetDeltaTime());
+        }
 
-        OnUpdate(m_Timer.GetDeltaTime());
+        PROFILE_SCOPE("FrameLimiter");
+        m_FrameLimiter.Wait();
     }
 
+    PROFILE_SCOPE("OnDestroy");
     OnDestroy();
 }
 
 void Application::Close()
 {
-    glfwSetWindowShouldClose(m_WindowHandle, GLFW_TRUE);
+    m_CloseRequested = true;
+
+    if (m_WindowHandle != nullptr)
+    {
+        glfwSetWindowShouldClose(m_WindowHandle, GLFW_TRUE);
+    }
+}
+
+bool Application::ShouldClose()
+{
+    if (m_WindowHandle != nullptr)
+    {
+        return glfwWindowShouldClose(m_WindowHandle);
+    }
+
+    return m_CloseRequested;
 }
 
 void Application::Destroy()
 {
+    m_FrameLimiter.LogStatistics();
+    m_FrameStatistics.LogStatistics();
+
+    if (!m_Info.FrameStatisticsPath.empty())
+    {
+        m_FrameStatistics.Write(std::filesystem::current_path() / m_Info.FrameStatisticsPath);
+    }
+
     if (m_WindowHandle != nullptr)
     {
         glfwDestroyWindow(m_WindowHandle);
         m_WindowHandle = nullptr;
     }
+
+#if PROFILING_ENABLED
+    // Worker threads have been joined by now
+    if (!m_Info.ProfileCapturePath.empty())
+    {
+        Profiler::WriteChromeTrace(std::filesystem::current_path() / m_Info.ProfileCapturePath);
+    }
+#endif
+
+    // Last, so that everything logged during shutdown is still written
+    Logger::Destroy();
 };
 
-void Application::CalculateFrameStats()
+void Application::UpdateFrameStatistics()
 {
     m_FrameCount++;
     m_ElapsedTime += m_Timer.GetDeltaTime();
+    m_FrameStatistics.AddCpuFrame(m_Timer.GetDeltaTime());
 
     if (m_ElapsedTime >= 1000.0f)
     {
-        float FrameTime = 1000.0f / m_FrameCount;
+        // Percentiles over the rolling window show the stutters an average per second hides
+        FrameTimePercentiles Cpu = m_FrameStatistics.GetCpuPercentiles();
 
-        std::string WindowTitle = Utility::Format("%s | Rate: %u fps, Time: %.2f ms",
-            m_Info.WindowTitle.c_str(), m_FrameCount, FrameTime);
+        char WindowTitle[256];
+        int Length = std::snprintf(WindowTitle, sizeof(WindowTitle),
+            "%s | Rate: %u fps, Time: %.2f ms p50, %.2f ms p99, %.2f ms max",
+            m_Info.WindowTitle.c_str(), m_FrameCount, Cpu.P50, Cpu.P99, Cpu.Max);
 
-        glfwSetWindowTitle(m_WindowHandle, WindowTitle.c_str());
+        if (m_FrameStatistics.HasGpuFrames() && Length > 0 &&
+            static_cast<size_t>(Length) < sizeof(WindowTitle))
+        {
+            FrameTimePercentiles Gpu = m_FrameStatistics.GetGpuPercentiles();
+            std::snprintf(WindowTitle + Length, sizeof(WindowTitle) - Length,
+                " | GPU: %.2f ms p50, %.2f ms p99", Gpu.P50, Gpu.P99);
+        }
+
+        if (m_WindowHandle != nullptr)
+        {
+            glfwSetWindowTitle(m_WindowHandle, WindowTitle);
+        }
+        else
+        {
+            DEBUG_DISPLAY("%s", WindowTitle);
+        }
 
         m_FrameCount = 0;
         m_ElapsedTime = 0;
@@ -240,3 +333,23 @@ void Application::SetFullscreen(bool Fullscreen)
 
     InternalSetFullscreen(m_Fullscreen);
 }
+
+void Application::InitFrameLimiter()
+{
+    m_FrameLimiter.SetTargetFrameRate(m_Info.TargetFrameRate);
+
+    if (!m_Info.AlignToDisplayRefresh || m_WindowHandle == nullptr)
+    {
+        return;
+    }
+
+    GLFWmonitor* Monitor = GetCurrentMonitor(m_WindowHandle);
+
+    if (Monitor == nullptr)
+    {
+        Monitor = glfwGetPrimaryMonitor();
+    }
+
+    const GLFWvidmode* Mode = glfwGetVideoMode(Monitor);
+    m_FrameLimiter.SetDisplayRefreshRate(Mode->refreshRate);
+}
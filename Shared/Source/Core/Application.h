@@ -1,4 +1,6 @@
 #pragma once
+#include "FrameLimiter.h"
+#include "FrameStatistics.h"
 #include "IApplication.h"
 #include "Timer.h"
 #include "pch.h"
@@ -10,6 +12,30 @@ struct ApplicationInfo
     uint32_t WindowHeight;
     bool Fullscreen = false;
     uint32_t ApiVersion = VK_API_VERSION_1_2;
+    uint32_t FramesInFlight = 2;
+    bool TimelineSemaphores = true;
+    uint32_t RecordingThreads = 0;
+    bool Headless = false;
+    std::string PipelineCachePath = "PipelineCache.bin";
+    std::string ShaderCachePath = "ShaderCache";
+    // Include directories, also watched for changes when hot reload is enabled
+    std::vector<std::string> ShaderDirectories;
+    bool ShaderHotReload = false;
+    bool BindlessDescriptors = false;
+    // Render without render pass and frame buffer objects when the device supports it
+    bool DynamicRendering = false;
+    // Chrome trace of the CPU profile zones written at exit, empty disables the capture
+    std::string ProfileCapturePath = "Profile.json";
+    // Frames per second the main loop is held to, zero runs it as fast as possible
+    float TargetFrameRate = 0.0f;
+    // Rounds the target frame time to whole refresh intervals of the monitor showing the window
+    bool AlignToDisplayRefresh = false;
+    // Frame times of the whole run written at exit, as JSON when the extension is .json and as CSV
+    // otherwise, empty disables the export
+    std::string FrameStatisticsPath;
+    // Log messages are also written to this file, empty disables the file sink
+    std::string LogFilePath;
+    uint32_t WorkerThreads = 0;
 };
 
 class Application : public IApplication
@@ -18,13 +44,16 @@ public:
     Application(const ApplicationInfo& Info);
     ~Application() = default;
     void Close();
+    bool ShouldClose();
+    bool IsHeadless() const { return m_Info.Headless; }
     virtual void Init() override;
     virtual void Destroy() override;
     virtual void Run() override;
 
 protected:
     void InitWindow();
-    void CalculateFrameStats();
+    void InitFrameLimiter();
+    void UpdateFrameStatistics();
     void SetupWindowEvents();
     void InternalSetFullscreen(bool Fullscreen);
     bool IsFullscreen() { return m_Fullscreen; }
@@ -51,7 +80,10 @@ protected:
     ApplicationInfo m_Info;
     GLFWwindow* m_WindowHandle;
     Timer m_Timer;
+    FrameLimiter m_FrameLimiter;
+    FrameStatistics m_FrameStatistics;
     float m_ElapsedTime;
     uint32_t m_FrameCount;
     bool m_Fullscreen;
+    bool m_CloseRequested;
 };
\ No newline at end of file
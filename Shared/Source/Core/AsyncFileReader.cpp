@@ -0,0 +1,828 @@
+#include "AsyncFileReader.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+// Completion tag of the eventfd read that wakes the ring thread, chunks use their slot index
+#define ASYNC_FILE_READER_WAKE_TAG UINT64_MAX
+
+// io_uring set up through the raw system calls. Only the ring thread touches the application side
+// of the queues, and at most one entry per chunk slot plus the wake read is ever outstanding, so
+// the submission queue cannot overflow
+struct AsyncFileReader::IoUringQueue
+{
+    ~IoUringQueue()
+    {
+        if (Sqes != MAP_FAILED)
+        {
+            munmap(Sqes, SqesSize);
+        }
+
+        if (CqRing != MAP_FAILED && CqRing != SqRing)
+        {
+            munmap(CqRing, CqRingSize);
+        }
+
+        if (SqRing != MAP_FAILED)
+        {
+            munmap(SqRing, SqRingSize);
+        }
+
+        if (Descriptor >= 0)
+        {
+            close(Descriptor);
+        }
+
+        if (WakeDescriptor >= 0)
+        {
+            close(WakeDescriptor);
+        }
+    }
+
+    bool Init(uint32_t NumEntries)
+    {
+        io_uring_params Params = {};
+        Descriptor = static_cast<int>(syscall(__NR_io_uring_setup, NumEntries, &Params));
+
+        if (Descriptor < 0)
+        {
+            return false;
+        }
+
+        SqRingSize = Params.sq_off.array + Params.sq_entries * sizeof(uint32_t);
+        CqRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+        SqesSize = Params.sq_entries * sizeof(io_uring_sqe);
+
+        // Since 5.4 both rings live in one mapping
+        bool SingleMapping = (Params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (SingleMapping)
+        {
+            SqRingSize = CqRingSize = std::max(SqRingSize, CqRingSize);
+        }
+
+        SqRing = mmap(nullptr, SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            Descriptor, IORING_OFF_SQ_RING);
+        if (SqRing == MAP_FAILED)
+        {
+            return false;
+        }
+
+        CqRing = SingleMapping ? SqRing
+                               : mmap(nullptr, CqRingSize, PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_POPULATE, Descriptor, IORING_OFF_CQ_RING);
+        if (CqRing == MAP_FAILED)
+        {
+            return false;
+        }
+
+        Sqes = mmap(nullptr, SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            Descriptor, IORING_OFF_SQES);
+        if (Sqes == MAP_FAILED)
+        {
+            return false;
+        }
+
+        uint8_t* Sq = static_cast<uint8_t*>(SqRing);
+        SqTail = reinterpret_cast<uint32_t*>(Sq + Params.sq_off.tail);
+        SqMask = *reinterpret_cast<uint32_t*>(Sq + Params.sq_off.ring_mask);
+        SqArray = reinterpret_cast<uint32_t*>(Sq + Params.sq_off.array);
+        LocalTail = *SqTail;
+
+        uint8_t* Cq = static_cast<uint8_t*>(CqRing);
+        CqHead = reinterpret_cast<uint32_t*>(Cq + Params.cq_off.head);
+        CqTail = reinterpret_cast<uint32_t*>(Cq + Params.cq_off.tail);
+        CqMask = *reinterpret_cast<uint32_t*>(Cq + Params.cq_off.ring_mask);
+        Cqes = reinterpret_cast<io_uring_cqe*>(Cq + Params.cq_off.cqes);
+
+        WakeDescriptor = eventfd(0, EFD_CLOEXEC);
+        return WakeDescriptor >= 0;
+    }
+
+    // Vectored reads need nothing newer than the first io_uring kernels
+    void PrepareRead(uint64_t Tag, int File, const iovec& Vector, uint64_t Offset)
+    {
+        uint32_t Index = LocalTail & SqMask;
+        io_uring_sqe& Entry = static_cast<io_uring_sqe*>(Sqes)[Index];
+
+        std::memset(&Entry, 0, sizeof(Entry));
+        Entry.opcode = IORING_OP_READV;
+        Entry.fd = File;
+        Entry.addr = reinterpret_cast<uint64_t>(&Vector);
+        Entry.len = 1;
+        Entry.off = Offset;
+        Entry.user_data = Tag;
+
+        SqArray[Index] = Index;
+        LocalTail++;
+        NumToSubmit++;
+    }
+
+    void PrepareWake()
+    {
+        WakeVector = {&WakeValue, sizeof(WakeValue)};
+        PrepareRead(ASYNC_FILE_READER_WAKE_TAG, WakeDescriptor, WakeVector, 0);
+    }
+
+    // The wake read is always outstanding, so there is something to wait for
+    void SubmitAndWait()
+    {
+        std::atomic_ref<uint32_t>(*SqTail).store(LocalTail, std::memory_order_release);
+
+        while (true)
+        {
+            int Result = static_cast<int>(syscall(__NR_io_uring_enter, Descriptor, NumToSubmit, 1,
+                IORING_ENTER_GETEVENTS, nullptr, 0));
+
+            if (Result >= 0)
+            {
+                NumToSubmit -= static_cast<uint32_t>(Result);
+                return;
+            }
+
+            if (errno != EINTR)
+            {
+                DEBUG_ERROR("io_uring_enter failed: %s", std::strerror(errno));
+                return;
+            }
+        }
+    }
+
+    template <typename Function>
+    void ForEachCompletion(const Function& Callback)
+    {
+        uint32_t Head = std::atomic_ref<uint32_t>(*CqHead).load(std::memory_order_relaxed);
+        uint32_t Tail = std::atomic_ref<uint32_t>(*CqTail).load(std::memory_order_acquire);
+
+        for (; Head != Tail; ++Head)
+        {
+            const io_uring_cqe& Entry = Cqes[Head & CqMask];
+            Callback(Entry.user_data, Entry.res);
+        }
+
+        std::atomic_ref<uint32_t>(*CqHead).store(Head, std::memory_order_release);
+    }
+
+    int Descriptor = -1;
+    int WakeDescriptor = -1;
+    uint64_t WakeValue = 0;
+    iovec WakeVector = {};
+    std::array<iovec, ASYNC_FILE_READER_QUEUE_DEPTH> Vectors = {};
+
+    void* SqRing = MAP_FAILED;
+    void* CqRing = MAP_FAILED;
+    void* Sqes = MAP_FAILED;
+    size_t SqRingSize = 0;
+    size_t CqRingSize = 0;
+    size_t SqesSize = 0;
+
+    uint32_t* SqTail = nullptr;
+    uint32_t* SqArray = nullptr;
+    uint32_t SqMask = 0;
+    uint32_t LocalTail = 0;
+    uint32_t NumToSubmit = 0;
+
+    uint32_t* CqHead = nullptr;
+    uint32_t* CqTail = nullptr;
+    uint32_t CqMask = 0;
+    io_uring_cqe* Cqes = nullptr;
+};
+#else
+struct AsyncFileReader::IoUringQueue
+{
+};
+#endif
+
+AsyncFileReader::AsyncFileReader()
+    : m_NextHandle(1),
+      m_Running(false),
+      m_NumCompleted(0),
+      m_NumFailed(0),
+      m_NumCancelled(0),
+      m_BytesRead(0)
+{
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    Destroy();
+}
+
+void AsyncFileReader::Init(AsyncReadBackend Backend, uint32_t NumThreads)
+{
+    DEBUG_ASSERT(!m_Running, "Async file reader already initialized");
+
+    m_Running = true;
+
+#ifdef __linux__
+    if (Backend != AsyncReadBackend::THREAD_POOL)
+    {
+        auto Ring = std::make_unique<IoUringQueue>();
+
+        if (Ring->Init(ASYNC_FILE_READER_QUEUE_DEPTH + 1))
+        {
+            m_Ring = std::move(Ring);
+            m_Chunks.resize(ASYNC_FILE_READER_QUEUE_DEPTH);
+
+            for (uint32_t Slot = ASYNC_FILE_READER_QUEUE_DEPTH; Slot > 0; --Slot)
+            {
+                m_FreeChunks.push_back(Slot - 1);
+            }
+
+            m_Threads.emplace_back(&AsyncFileReader::RingLoop, this);
+
+            DEBUG_DISPLAY("Async file reader: io_uring, %u chunks in flight",
+                ASYNC_FILE_READER_QUEUE_DEPTH);
+            return;
+        }
+
+        // Old kernels, seccomp filters of container runtimes and the io_uring_disabled sysctl
+        DEBUG_INFO("io_uring is unavailable, async file reads use a thread pool");
+    }
+#endif
+
+    CHECK(Backend != AsyncReadBackend::IO_URING, "io_uring is not available");
+
+    if (NumThreads == 0)
+    {
+        NumThreads = ASYNC_FILE_READER_THREADS;
+    }
+
+    for (uint32_t ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+    {
+        m_Threads.emplace_back(&AsyncFileReader::WorkerLoop, this, ThreadIndex);
+    }
+
+    DEBUG_DISPLAY("Async file reader: thread pool, %u threads", NumThreads);
+}
+
+void AsyncFileReader::Destroy()
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        if (!m_Running)
+        {
+            return;
+        }
+
+        m_Running = false;
+
+        for (auto& [Handle, Target] : m_Operations)
+        {
+            Target->Cancelled = true;
+        }
+    }
+
+    Wake();
+
+    for (auto& Thread : m_Threads)
+    {
+        Thread.join();
+    }
+
+    m_Threads.clear();
+    m_Ring.reset();
+    m_Chunks.clear();
+    m_FreeChunks.clear();
+}
+
+ReadHandle AsyncFileReader::Submit(ReadRequest Request)
+{
+    ReadHandle Handle = 0;
+    Submit(std::span<ReadRequest>(&Request, 1), &Handle);
+    return Handle;
+}
+
+void AsyncFileReader::Submit(std::span<ReadRequest> Requests, ReadHandle* OutHandles)
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        DEBUG_ASSERT(m_Running, "Async file reader not initialized");
+
+        for (size_t Index = 0; Index < Requests.size(); ++Index)
+        {
+            DEBUG_ASSERT(!Requests[Index].Destination || Requests[Index].Size != UINT64_MAX,
+                "Reading into a destination needs an explicit size");
+
+            Operation* Target = new Operation();
+            Target->Handle = m_NextHandle++;
+            Target->Request = std::move(Requests[Index]);
+            Target->Queued = true;
+
+            m_Pending[static_cast<uint32_t>(Target->Request.Priority)].push_back(Target);
+            m_Operations[Target->Handle] = Target;
+
+            if (OutHandles)
+            {
+                OutHandles[Index] = Target->Handle;
+            }
+        }
+    }
+
+    Wake();
+}
+
+std::future<ReadResult> AsyncFileReader::Read(ReadRequest Request)
+{
+    // Callbacks are copyable, the promise is not
+    auto Promise = std::make_shared<std::promise<ReadResult>>();
+    std::future<ReadResult> Future = Promise->get_future();
+
+    Request.Callback = [Promise, Callback = std::move(Request.Callback)](ReadResult& Result)
+    {
+        if (Callback)
+        {
+            Callback(Result);
+        }
+
+        Promise->set_value(std::move(Result));
+    };
+
+    Submit(std::move(Request));
+    return Future;
+}
+
+bool AsyncFileReader::Cancel(ReadHandle Handle)
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        auto Found = m_Operations.find(Handle);
+        if (Found == m_Operations.end())
+        {
+            return false;
+        }
+
+        Operation* Target = Found->second;
+        Target->Cancelled = true;
+
+        // Its callback should not wait for everything queued ahead of it
+        if (Target->Queued)
+        {
+            auto& Queue = m_Pending[static_cast<uint32_t>(Target->Request.Priority)];
+            Queue.erase(std::find(Queue.begin(), Queue.end(), Target));
+            m_Pending[static_cast<uint32_t>(ReadPriority::HIGH)].push_front(Target);
+        }
+    }
+
+    Wake();
+    return true;
+}
+
+AsyncFileReaderStatistics AsyncFileReader::GetStatistics() const
+{
+    AsyncFileReaderStatistics Statistics;
+    Statistics.NumCompleted = m_NumCompleted.load(std::memory_order_relaxed);
+    Statistics.NumFailed = m_NumFailed.load(std::memory_order_relaxed);
+    Statistics.NumCancelled = m_NumCancelled.load(std::memory_order_relaxed);
+    Statistics.BytesRead = m_BytesRead.load(std::memory_order_relaxed);
+    return Statistics;
+}
+
+void AsyncFileReader::LogStatistics() const
+{
+    AsyncFileReaderStatistics Statistics = GetStatistics();
+
+    DEBUG_DISPLAY("Async file reader: %llu reads, %llu failed, %llu cancelled, %.2f MiB read",
+        Statistics.NumCompleted, Statistics.NumFailed, Statistics.NumCancelled,
+        Statistics.BytesRead / (1024.0 * 1024.0));
+}
+
+void AsyncFileReader::WorkerLoop(uint32_t ThreadIndex)
+{
+    PROFILE_THREAD(Utility::Format("IO %u", ThreadIndex));
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+
+    while (true)
+    {
+        Operation* Target = PopPending();
+
+        if (!Target)
+        {
+            // Leaves once the queues drained, pending requests were cancelled by Destroy
+            if (!m_Running)
+            {
+                break;
+            }
+
+            m_Condition.wait(Lock);
+            continue;
+        }
+
+        if (!Target->Opened && !Target->Cancelled)
+        {
+            Lock.unlock();
+            OpenFile(Target);
+            Lock.lock();
+        }
+
+        ReadChunk Chunk;
+        if (TakeChunk(Target, Chunk))
+        {
+            // The rest of the request went back to the queue, another thread can read it
+            if (Target->Queued)
+            {
+                m_Condition.notify_one();
+            }
+
+            Lock.unlock();
+
+            uint64_t NumRead = 0;
+            int Error = 0;
+            {
+                PROFILE_SCOPE("Read");
+                Error = ReadBlocking(Chunk, NumRead);
+            }
+
+            Lock.lock();
+
+            if (!FinishChunk(Chunk, NumRead, Error))
+            {
+                continue;
+            }
+        }
+        else if (!Retire(Target))
+        {
+            continue;
+        }
+
+        Lock.unlock();
+        Complete(Target);
+        Lock.lock();
+    }
+}
+
+void AsyncFileReader::RingLoop()
+{
+#ifdef __linux__
+    PROFILE_THREAD("IO");
+
+    IoUringQueue& Ring = *m_Ring;
+    std::vector<Operation*> Finished;
+
+    Ring.PrepareWake();
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+
+    while (true)
+    {
+        // Fills the free slots in priority order
+        while (!m_FreeChunks.empty())
+        {
+            Operation* Target = PopPending();
+            if (!Target)
+            {
+                break;
+            }
+
+            if (!Target->Opened && !Target->Cancelled)
+            {
+                Lock.unlock();
+                OpenFile(Target);
+                Lock.lock();
+            }
+
+            ReadChunk Chunk;
+            if (!TakeChunk(Target, Chunk))
+            {
+                if (Retire(Target))
+                {
+                    Lock.unlock();
+                    Complete(Target);
+                    Lock.lock();
+                }
+
+                continue;
+            }
+
+            uint32_t Slot = m_FreeChunks.back();
+            m_FreeChunks.pop_back();
+            m_Chunks[Slot] = Chunk;
+
+            Ring.Vectors[Slot] = {Target->Result.Data + Chunk.Offset, Chunk.Size};
+            Ring.PrepareRead(Slot, Target->Descriptor, Ring.Vectors[Slot],
+                Target->Request.Offset + Chunk.Offset);
+        }
+
+        // The queues are empty once the loop above stopped with free slots
+        if (!m_Running && m_FreeChunks.size() == m_Chunks.size())
+        {
+            break;
+        }
+
+        Lock.unlock();
+        Ring.SubmitAndWait();
+        Lock.lock();
+
+        Ring.ForEachCompletion(
+            [&](uint64_t Tag, int32_t Result)
+            {
+                if (Tag == ASYNC_FILE_READER_WAKE_TAG)
+                {
+                    Ring.PrepareWake();
+                    return;
+                }
+
+                ReadChunk& Chunk = m_Chunks[Tag];
+                uint64_t NumRead = Result > 0 ? static_cast<uint64_t>(Result) : 0;
+
+                // Short reads continue where they stopped
+                if (NumRead > 0 && NumRead < Chunk.Size && !Chunk.Target->Cancelled)
+                {
+                    Chunk.Target->NumRead += NumRead;
+                    Chunk.Offset += NumRead;
+                    Chunk.Size -= NumRead;
+
+                    Ring.Vectors[Tag] = {Chunk.Target->Result.Data + Chunk.Offset, Chunk.Size};
+                    Ring.PrepareRead(Tag, Chunk.Target->Descriptor, Ring.Vectors[Tag],
+                        Chunk.Target->Request.Offset + Chunk.Offset);
+                    return;
+                }
+
+                // Reaching the end early means the file got shorter since it was opened
+                int Error = Result < 0 ? -Result : (Result == 0 && Chunk.Size > 0 ? EIO : 0);
+
+                if (FinishChunk(Chunk, NumRead, Error))
+                {
+                    Finished.push_back(Chunk.Target);
+                }
+
+                m_FreeChunks.push_back(static_cast<uint32_t>(Tag));
+            });
+
+        if (!Finished.empty())
+        {
+            Lock.unlock();
+
+            for (Operation* Target : Finished)
+            {
+                Complete(Target);
+            }
+
+            Finished.clear();
+            Lock.lock();
+        }
+    }
+#endif
+}
+
+void AsyncFileReader::Wake()
+{
+#ifdef __linux__
+    if (m_Ring)
+    {
+        eventfd_write(m_Ring->WakeDescriptor, 1);
+        return;
+    }
+#endif
+
+    m_Condition.notify_all();
+}
+
+AsyncFileReader::Operation* AsyncFileReader::PopPending()
+{
+    for (auto& Queue : m_Pending)
+    {
+        if (!Queue.empty())
+        {
+            Operation* Target = Queue.front();
+            Queue.pop_front();
+            Target->Queued = false;
+            return Target;
+        }
+    }
+
+    return nullptr;
+}
+
+bool AsyncFileReader::TakeChunk(Operation* Target, ReadChunk& OutChunk)
+{
+    uint64_t Size = Target->Result.Size;
+
+    if (!Target->Opened || Target->Cancelled || Target->Result.Error != 0 ||
+        Target->NumIssued == Size)
+    {
+        return false;
+    }
+
+    OutChunk.Target = Target;
+    OutChunk.Offset = Target->NumIssued;
+    OutChunk.Size = std::min<uint64_t>(ASYNC_FILE_READER_CHUNK_SIZE, Size - Target->NumIssued);
+
+    Target->NumIssued += OutChunk.Size;
+    Target->NumInFlight++;
+
+    // Stays at the front, so that requests of the same priority finish in submission order
+    if (Target->NumIssued < Size)
+    {
+        m_Pending[static_cast<uint32_t>(Target->Request.Priority)].push_front(Target);
+        Target->Queued = true;
+    }
+
+    return true;
+}
+
+bool AsyncFileReader::FinishChunk(const ReadChunk& Chunk, uint64_t NumRead, int Error)
+{
+    Operation* Target = Chunk.Target;
+    Target->NumInFlight--;
+    Target->NumRead += NumRead;
+
+    if (Error != 0 && Target->Result.Error == 0)
+    {
+        Target->Result.Error = Error;
+    }
+
+    return Retire(Target);
+}
+
+bool AsyncFileReader::Retire(Operation* Target)
+{
+    // Nothing refers to an operation that is neither queued nor being read
+    bool Finished = !Target->Queued && Target->NumInFlight == 0 &&
+                    (!Target->Opened || Target->Cancelled || Target->Result.Error != 0 ||
+                        Target->NumIssued == Target->Result.Size);
+
+    if (Finished)
+    {
+        m_Operations.erase(Target->Handle);
+    }
+
+    return Finished;
+}
+
+void AsyncFileReader::OpenFile(Operation* Target)
+{
+    const ReadRequest& Request = Target->Request;
+    ReadResult& Result = Target->Result;
+    uint64_t FileSize = 0;
+
+    Target->Opened = true;
+
+#ifdef _WIN32
+    HANDLE File = CreateFileW(Request.Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        Result.Error = static_cast<int>(GetLastError());
+        return;
+    }
+
+    Target->FileHandle = File;
+
+    LARGE_INTEGER Size;
+    if (!GetFileSizeEx(File, &Size))
+    {
+        Result.Error = static_cast<int>(GetLastError());
+        return;
+    }
+
+    FileSize = static_cast<uint64_t>(Size.QuadPart);
+#else
+    Target->Descriptor = open(Request.Path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (Target->Descriptor < 0)
+    {
+        Result.Error = errno;
+        return;
+    }
+
+    struct stat Status;
+    if (fstat(Target->Descriptor, &Status) != 0)
+    {
+        Result.Error = errno;
+        return;
+    }
+
+    FileSize = static_cast<uint64_t>(Status.st_size);
+#endif
+
+    if (Request.Offset > FileSize ||
+        (Request.Size != UINT64_MAX && Request.Size > FileSize - Request.Offset))
+    {
+        Result.Error = EINVAL;
+        return;
+    }
+
+    Result.Size = Request.Size == UINT64_MAX ? FileSize - Request.Offset : Request.Size;
+
+    if (Request.Destination)
+    {
+        Result.Data = Request.Destination;
+    }
+    else
+    {
+        Result.Buffer = std::make_unique_for_overwrite<uint8_t[]>(Result.Size);
+        Result.Data = Result.Buffer.get();
+    }
+}
+
+int AsyncFileReader::ReadBlocking(const ReadChunk& Chunk, uint64_t& OutNumRead)
+{
+    Operation* Target = Chunk.Target;
+    uint8_t* Data = Target->Result.Data + Chunk.Offset;
+    uint64_t Offset = Target->Request.Offset + Chunk.Offset;
+
+    OutNumRead = 0;
+
+    while (OutNumRead < Chunk.Size)
+    {
+#ifdef _WIN32
+        // Positional read on a synchronous handle, the threads do not share a file pointer
+        OVERLAPPED Overlapped = {};
+        Overlapped.Offset = static_cast<DWORD>(Offset + OutNumRead);
+        Overlapped.OffsetHigh = static_cast<DWORD>((Offset + OutNumRead) >> 32);
+
+        DWORD Read = 0;
+        if (!ReadFile(Target->FileHandle, Data + OutNumRead,
+                static_cast<DWORD>(Chunk.Size - OutNumRead), &Read, &Overlapped))
+        {
+            return static_cast<int>(GetLastError());
+        }
+#else
+        ssize_t Read = pread(Target->Descriptor, Data + OutNumRead, Chunk.Size - OutNumRead,
+            static_cast<off_t>(Offset + OutNumRead));
+
+        if (Read < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return errno;
+        }
+#endif
+
+        // The file got shorter since it was opened
+        if (Read == 0)
+        {
+            return EIO;
+        }
+
+        OutNumRead += static_cast<uint64_t>(Read);
+    }
+
+    return 0;
+}
+
+void AsyncFileReader::Complete(Operation* Target)
+{
+    ReadResult& Result = Target->Result;
+
+#ifdef _WIN32
+    if (Target->FileHandle)
+    {
+        CloseHandle(Target->FileHandle);
+    }
+#else
+    if (Target->Descriptor >= 0)
+    {
+        close(Target->Descriptor);
+    }
+#endif
+
+    Result.Handle = Target->Handle;
+
+    if (Target->Opened && Result.Error == 0 && Target->NumRead == Result.Size)
+    {
+        Result.Status = ReadStatus::COMPLETED;
+        m_NumCompleted.fetch_add(1, std::memory_order_relaxed);
+        m_BytesRead.fetch_add(Result.Size, std::memory_order_relaxed);
+    }
+    else
+    {
+        Result.Status = Target->Cancelled && Result.Error == 0 ? ReadStatus::CANCELLED
+                                                               : ReadStatus::FAILED;
+        Result.Buffer.reset();
+        Result.Data = nullptr;
+        Result.Size = 0;
+
+        (Result.Status == ReadStatus::CANCELLED ? m_NumCancelled : m_NumFailed)
+            .fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (Target->Request.Callback)
+    {
+        Target->Request.Callback(Result);
+    }
+
+    delete Target;
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include "pch.h"
+
+// Largest single read, a long request gives way to higher priorities and cancellation between
+// chunks and its chunks are read in parallel
+#define ASYNC_FILE_READER_CHUNK_SIZE (1024 * 1024)
+// Chunks in flight at once, also the depth of the io_uring submission queue
+#define ASYNC_FILE_READER_QUEUE_DEPTH 64
+// Threads of the fallback pool unless Init is given a count
+#define ASYNC_FILE_READER_THREADS 4
+#define ASYNC_FILE_READER_PRIORITIES 3
+
+enum class ReadPriority
+{
+    HIGH = 0,
+    NORMAL,
+    LOW,
+};
+
+enum class ReadStatus
+{
+    COMPLETED = 0,
+    FAILED,
+    CANCELLED,
+};
+
+enum class AsyncReadBackend
+{
+    // io_uring when the kernel allows it, the thread pool otherwise
+    AUTO = 0,
+    IO_URING,
+    THREAD_POOL,
+};
+
+using ReadHandle = uint64_t;
+
+struct ReadResult
+{
+    ReadHandle Handle = 0;
+    ReadStatus Status = ReadStatus::FAILED;
+    // errno value, or the GetLastError code of a failed system call on Windows
+    int Error = 0;
+    // Owns the data unless the request named a destination, may be moved out by the callback
+    std::unique_ptr<uint8_t[]> Buffer;
+    uint8_t* Data = nullptr;
+    size_t Size = 0;
+
+    std::span<const uint8_t> GetSpan() const { return {Data, Size}; }
+};
+
+using ReadCallback = std::function<void(ReadResult& Result)>;
+
+struct ReadRequest
+{
+    std::filesystem::path Path;
+    uint64_t Offset = 0;
+    // Reads to the end of the file when left at the default
+    uint64_t Size = UINT64_MAX;
+    // Read into this memory instead of a new buffer, for instance a mapped staging buffer. Needs
+    // an explicit size and must stay valid until the callback ran
+    uint8_t* Destination = nullptr;
+    ReadPriority Priority = ReadPriority::NORMAL;
+    // Runs on an I/O thread exactly once, whatever the outcome, and should hand work off quickly
+    ReadCallback Callback;
+};
+
+struct AsyncFileReaderStatistics
+{
+    uint64_t NumCompleted = 0;
+    uint64_t NumFailed = 0;
+    uint64_t NumCancelled = 0;
+    uint64_t BytesRead = 0;
+};
+
+// Reads files in the background. Requests wait in one queue per priority and are split into
+// chunks, on Linux the chunks go through a single io_uring serviced by one thread, elsewhere or
+// when io_uring is unavailable a pool of threads issues positional reads. Submitting and
+// cancelling only take a short lock, so they are safe to call from the frame loop
+class AsyncFileReader
+{
+public:
+    AsyncFileReader();
+    ~AsyncFileReader();
+    void Init(AsyncReadBackend Backend = AsyncReadBackend::AUTO, uint32_t NumThreads = 0);
+    // Pending requests complete as cancelled, reads in flight are waited for
+    void Destroy();
+
+    ReadHandle Submit(ReadRequest Request);
+    // Queues the whole batch with a single wakeup, handles are written in request order
+    void Submit(std::span<ReadRequest> Requests, ReadHandle* OutHandles = nullptr);
+    // The result is handed to the future after the callback of the request, if any, ran
+    std::future<ReadResult> Read(ReadRequest Request);
+    // The request completes as cancelled unless all of it was read already. False when the
+    // handle is unknown or has completed
+    bool Cancel(ReadHandle Handle);
+
+    bool IsUsingIoUring() const { return m_Ring != nullptr; }
+    AsyncFileReaderStatistics GetStatistics() const;
+    void LogStatistics() const;
+
+private:
+    struct Operation
+    {
+        ReadHandle Handle;
+        ReadRequest Request;
+        ReadResult Result;
+#ifdef _WIN32
+        void* FileHandle = nullptr;
+#else
+        int Descriptor = -1;
+#endif
+        bool Opened = false;
+        bool Queued = false;
+        bool Cancelled = false;
+        // Bytes handed out as chunks and bytes read back, relative to the request offset
+        uint64_t NumIssued = 0;
+        uint64_t NumRead = 0;
+        uint32_t NumInFlight = 0;
+    };
+
+    struct ReadChunk
+    {
+        Operation* Target;
+        uint64_t Offset;
+        uint64_t Size;
+    };
+
+    struct IoUringQueue;
+
+    void WorkerLoop(uint32_t ThreadIndex);
+    void RingLoop();
+    void Wake();
+
+    // Called with the lock held
+    Operation* PopPending();
+    bool TakeChunk(Operation* Target, ReadChunk& OutChunk);
+    bool FinishChunk(const ReadChunk& Chunk, uint64_t NumRead, int Error);
+    // Forgets the operation and returns true once it is ready to complete
+    bool Retire(Operation* Target);
+
+    // Called without the lock, on the thread that owns the operation at that point
+    void OpenFile(Operation* Target);
+    int ReadBlocking(const ReadChunk& Chunk, uint64_t& OutNumRead);
+    void Complete(Operation* Target);
+
+    std::array<std::deque<Operation*>, ASYNC_FILE_READER_PRIORITIES> m_Pending;
+    std::unordered_map<ReadHandle, Operation*> m_Operations;
+    ReadHandle m_NextHandle;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::vector<std::thread> m_Threads;
+    bool m_Running;
+
+    std::unique_ptr<IoUringQueue> m_Ring;
+    std::vector<ReadChunk> m_Chunks;
+    std::vector<uint32_t> m_FreeChunks;
+
+    std::atomic<uint64_t> m_NumCompleted;
+    std::atomic<uint64_t> m_NumFailed;
+    std::atomic<uint64_t> m_NumCancelled;
+    std::atomic<uint64_t> m_BytesRead;
+};
@@ -10,6 +10,7 @@ bool StartApplication(IApplication& App)
     }
     catch (const std::exception& Exception)
     {
+        Logger::Flush();
         PRINT_ERROR(Exception.what());
         return false;
     }
@@ -0,0 +1,262 @@
+#include "FileWatcher.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher()
+    : m_Running(false)
+#ifdef __linux__
+      ,
+      m_Descriptor(-1)
+#endif
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+    Destroy();
+}
+
+void FileWatcher::Init(
+    const std::vector<std::filesystem::path>& Directories, const FileChangeFunction& Callback)
+{
+    DEBUG_ASSERT(!m_Running, "File watcher already running");
+
+    m_Callback = Callback;
+
+#ifdef __linux__
+    m_Descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    CHECK(m_Descriptor >= 0, "Failed to initialize inotify");
+#endif
+
+    for (auto& Directory : Directories)
+    {
+        std::filesystem::path AbsoluteDirectory =
+            std::filesystem::absolute(Directory).lexically_normal();
+
+        if (!std::filesystem::is_directory(AbsoluteDirectory))
+        {
+            DEBUG_WARNING("Not watching missing directory %s", AbsoluteDirectory.string().c_str());
+            continue;
+        }
+
+        m_Directories.push_back(AbsoluteDirectory);
+        AddDirectory(AbsoluteDirectory);
+
+        // A directory vanishing or turning unreadable mid scan leaves the rest of it unwatched
+        std::error_code Error;
+        std::filesystem::recursive_directory_iterator It(AbsoluteDirectory,
+            std::filesystem::directory_options::skip_permission_denied, Error);
+
+        for (; !Error && It != std::filesystem::recursive_directory_iterator(); It.increment(Error))
+        {
+            std::error_code EntryError;
+            if (It->is_directory(EntryError))
+            {
+                AddDirectory(It->path());
+            }
+#ifndef __linux__
+            else
+            {
+                m_WriteTimes[It->path().lexically_normal().string()] =
+                    It->last_write_time(EntryError);
+            }
+#endif
+        }
+
+        if (Error)
+        {
+            DEBUG_WARNING("Failed to scan %s: %s", AbsoluteDirectory.string().c_str(),
+                Error.message().c_str());
+        }
+
+        DEBUG_DISPLAY("Watching %s", AbsoluteDirectory.string().c_str());
+    }
+
+    m_Running = true;
+    m_Thread = std::thread(&FileWatcher::WatchLoop, this);
+}
+
+void FileWatcher::Destroy()
+{
+    if (m_Running.exchange(false))
+    {
+        m_Thread.join();
+    }
+
+#ifdef __linux__
+    if (m_Descriptor >= 0)
+    {
+        close(m_Descriptor);
+        m_Descriptor = -1;
+    }
+    m_WatchedDirectories.clear();
+#else
+    m_WriteTimes.clear();
+#endif
+
+    m_Directories.clear();
+}
+
+void FileWatcher::WatchLoop()
+{
+    std::vector<std::filesystem::path> Changes;
+
+    while (m_Running.load(std::memory_order_acquire))
+    {
+        // Editors save in several steps, report once nothing new arrived for a short while
+        size_t NumChanges = Changes.size();
+        CollectChanges(Changes,
+            Changes.empty() ? FILE_WATCHER_POLL_MILLISECONDS : FILE_WATCHER_SETTLE_MILLISECONDS);
+
+        if (Changes.empty() || Changes.size() != NumChanges)
+        {
+            continue;
+        }
+
+        std::sort(Changes.begin(), Changes.end());
+        Changes.erase(std::unique(Changes.begin(), Changes.end()), Changes.end());
+
+        m_Callback(Changes);
+        Changes.clear();
+    }
+}
+
+#ifdef __linux__
+void FileWatcher::AddDirectory(const std::filesystem::path& Directory)
+{
+    int Watch = inotify_add_watch(m_Descriptor, Directory.c_str(),
+        IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF);
+
+    if (Watch < 0)
+    {
+        DEBUG_WARNING("Failed to watch %s", Directory.string().c_str());
+        return;
+    }
+
+    m_WatchedDirectories[Watch] = Directory.lexically_normal();
+}
+
+void FileWatcher::CollectChanges(
+    std::vector<std::filesystem::path>& OutChanges, int TimeoutMilliseconds)
+{
+    pollfd Descriptor = {m_Descriptor, POLLIN, 0};
+
+    if (poll(&Descriptor, 1, TimeoutMilliseconds) <= 0)
+    {
+        return;
+    }
+
+    alignas(inotify_event) char Buffer[4096];
+
+    while (true)
+    {
+        ssize_t Length = read(m_Descriptor, Buffer, sizeof(Buffer));
+
+        if (Length <= 0)
+        {
+            return;
+        }
+
+        for (ssize_t Offset = 0; Offset < Length;)
+        {
+            const inotify_event* Event = reinterpret_cast<const inotify_event*>(Buffer + Offset);
+            Offset += sizeof(inotify_event) + Event->len;
+
+            auto Found = m_WatchedDirectories.find(Event->wd);
+            if (Found == m_WatchedDirectories.end())
+            {
+                continue;
+            }
+
+            if (Event->mask & (IN_DELETE_SELF | IN_IGNORED))
+            {
+                m_WatchedDirectories.erase(Found);
+                continue;
+            }
+
+            if (Event->len == 0)
+            {
+                continue;
+            }
+
+            std::filesystem::path Path = Found->second / Event->name;
+
+            // Watches are per directory, new subdirectories need their own
+            if (Event->mask & IN_ISDIR)
+            {
+                if (Event->mask & (IN_CREATE | IN_MOVED_TO))
+                {
+                    AddDirectory(Path);
+                }
+                continue;
+            }
+
+            if (Event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+            {
+                OutChanges.push_back(Path);
+            }
+        }
+    }
+}
+#else
+void FileWatcher::AddDirectory([[maybe_unused]] const std::filesystem::path& Directory)
+{
+}
+
+void FileWatcher::CollectChanges(
+    std::vector<std::filesystem::path>& OutChanges, int TimeoutMilliseconds)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(TimeoutMilliseconds));
+
+    std::unordered_set<std::string> SeenFiles;
+    bool CompleteScan = true;
+
+    for (auto& Directory : m_Directories)
+    {
+        // Runs on the watcher thread, a throwing iterator would terminate the process
+        std::error_code Error;
+        std::filesystem::recursive_directory_iterator It(
+            Directory, std::filesystem::directory_options::skip_permission_denied, Error);
+
+        for (; !Error && It != std::filesystem::recursive_directory_iterator(); It.increment(Error))
+        {
+            std::error_code EntryError;
+            if (!It->is_regular_file(EntryError))
+            {
+                continue;
+            }
+
+            auto WriteTime = It->last_write_time(EntryError);
+            if (EntryError)
+            {
+                continue;
+            }
+
+            std::string Path = It->path().lexically_normal().string();
+            SeenFiles.insert(Path);
+
+            auto& KnownWriteTime = m_WriteTimes[Path];
+            if (KnownWriteTime != WriteTime)
+            {
+                KnownWriteTime = WriteTime;
+                OutChanges.push_back(It->path().lexically_normal());
+            }
+        }
+
+        CompleteScan = CompleteScan && !Error;
+    }
+
+    // Forget deleted files, but only when every directory was fully scanned
+    if (CompleteScan)
+    {
+        for (auto It = m_WriteTimes.begin(); It != m_WriteTimes.end();)
+        {
+            It = SeenFiles.count(It->first) ? std::next(It) : m_WriteTimes.erase(It);
+        }
+    }
+}
+#endif
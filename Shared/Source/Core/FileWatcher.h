@@ -0,0 +1,35 @@
+#pragma once
+#include "pch.h"
+
+#define FILE_WATCHER_POLL_MILLISECONDS 100
+#define FILE_WATCHER_SETTLE_MILLISECONDS 50
+
+using FileChangeFunction = std::function<void(const std::vector<std::filesystem::path>& Paths)>;
+
+// Watches directory trees on a background thread and reports modified files in batches, once
+// writes have settled. Uses inotify on Linux and compares modification times elsewhere
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+    void Init(const std::vector<std::filesystem::path>& Directories,
+        const FileChangeFunction& Callback);
+    void Destroy();
+
+private:
+    void WatchLoop();
+    void AddDirectory(const std::filesystem::path& Directory);
+    void CollectChanges(std::vector<std::filesystem::path>& OutChanges, int TimeoutMilliseconds);
+
+    std::vector<std::filesystem::path> m_Directories;
+    FileChangeFunction m_Callback;
+    std::thread m_Thread;
+    std::atomic<bool> m_Running;
+#ifdef __linux__
+    int m_Descriptor;
+    std::unordered_map<int, std::filesystem::path> m_WatchedDirectories;
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_WriteTimes;
+#endif
+};
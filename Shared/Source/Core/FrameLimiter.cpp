@@ -0,0 +1,159 @@
+#include "FrameLimiter.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+FrameLimiter::FrameLimiter()
+    : m_TargetFrameTime(0),
+      m_RefreshInterval(0),
+      m_FrameTime(0),
+      m_SpinThreshold(std::chrono::microseconds(FRAME_LIMITER_MAX_SPIN_MICROSECONDS)),
+      m_NumFrames(0),
+      m_NumMissedDeadlines(0),
+      m_MaxLateness(0),
+      m_TotalWakeError(0),
+      m_MaxWakeError(0)
+{
+#ifdef _WIN32
+    // Plain sleeps are rounded to the scheduler tick, high resolution timers need Windows 10 1803
+    m_TimerHandle = CreateWaitableTimerExW(
+        nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+}
+
+FrameLimiter::~FrameLimiter()
+{
+#ifdef _WIN32
+    if (m_TimerHandle != nullptr)
+    {
+        CloseHandle(m_TimerHandle);
+    }
+#endif
+}
+
+void FrameLimiter::SetTargetFrameRate(double FramesPerSecond)
+{
+    m_TargetFrameTime = FramesPerSecond > 0.0
+                            ? std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double>(1.0 / FramesPerSecond))
+                            : Clock::duration(0);
+
+    UpdateFrameTime();
+}
+
+void FrameLimiter::SetDisplayRefreshRate(double RefreshRate)
+{
+    m_RefreshInterval = RefreshRate > 0.0
+                            ? std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double>(1.0 / RefreshRate))
+                            : Clock::duration(0);
+
+    UpdateFrameTime();
+}
+
+void FrameLimiter::Reset()
+{
+    m_Deadline = Clock::now() + m_FrameTime;
+}
+
+void FrameLimiter::Wait()
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    m_NumFrames++;
+
+    Clock::time_point Now = Clock::now();
+
+    if (Now >= m_Deadline)
+    {
+        m_NumMissedDeadlines++;
+        m_MaxLateness = std::max(m_MaxLateness, Now - m_Deadline);
+        m_Deadline = Now + m_FrameTime;
+        return;
+    }
+
+    Clock::time_point WakeTime = m_Deadline - m_SpinThreshold;
+    if (Now < WakeTime)
+    {
+        SleepFor(WakeTime - Now);
+
+        // Leave twice the latest oversleep to the spin, and let the margin shrink back slowly
+        Clock::duration Oversleep = Clock::now() - WakeTime;
+        Clock::duration Decayed = m_SpinThreshold - m_SpinThreshold / 16;
+        Clock::duration MinSpin = std::chrono::microseconds(FRAME_LIMITER_MIN_SPIN_MICROSECONDS);
+        Clock::duration MaxSpin = std::chrono::microseconds(FRAME_LIMITER_MAX_SPIN_MICROSECONDS);
+        m_SpinThreshold = std::clamp(std::max(Decayed, 2 * Oversleep), MinSpin, MaxSpin);
+    }
+
+    while ((Now = Clock::now()) < m_Deadline)
+    {
+        std::this_thread::yield();
+    }
+
+    m_TotalWakeError += Now - m_Deadline;
+    m_MaxWakeError = std::max(m_MaxWakeError, Now - m_Deadline);
+    m_Deadline += m_FrameTime;
+}
+
+void FrameLimiter::LogStatistics() const
+{
+    if (m_NumFrames == 0)
+    {
+        return;
+    }
+
+    using Microseconds = std::chrono::duration<double, std::micro>;
+    uint64_t NumWaits = m_NumFrames - m_NumMissedDeadlines;
+
+    DEBUG_DISPLAY("Frame limiter: %.3f ms frames, %llu of %llu deadlines missed (%.3f ms worst)",
+        Microseconds(m_FrameTime).count() / 1000.0, m_NumMissedDeadlines, m_NumFrames,
+        Microseconds(m_MaxLateness).count() / 1000.0);
+
+    DEBUG_DISPLAY("Frame limiter: %.1f us average wake up error, %.1f us worst, %.1f us spin",
+        NumWaits ? Microseconds(m_TotalWakeError).count() / NumWaits : 0.0,
+        Microseconds(m_MaxWakeError).count(), Microseconds(m_SpinThreshold).count());
+}
+
+void FrameLimiter::UpdateFrameTime()
+{
+    m_FrameTime = m_TargetFrameTime;
+
+    if (m_FrameTime.count() > 0 && m_RefreshInterval.count() > 0)
+    {
+        double Ratio = std::chrono::duration<double>(m_TargetFrameTime) / m_RefreshInterval;
+        m_FrameTime = std::max<int64_t>(1, std::llround(Ratio)) * m_RefreshInterval;
+    }
+
+    Reset();
+}
+
+void FrameLimiter::SleepFor(Clock::duration Duration)
+{
+#ifdef _WIN32
+    if (m_TimerHandle != nullptr)
+    {
+        // Negative due times are relative, in 100 ns units
+        int64_t Ticks = Duration / std::chrono::nanoseconds(100);
+        LARGE_INTEGER DueTime;
+        DueTime.QuadPart = -std::max<int64_t>(Ticks, 1);
+
+        if (SetWaitableTimerEx(m_TimerHandle, &DueTime, 0, nullptr, nullptr, nullptr, 0))
+        {
+            WaitForSingleObject(m_TimerHandle, INFINITE);
+            return;
+        }
+    }
+#endif
+
+    std::this_thread::sleep_for(Duration);
+}
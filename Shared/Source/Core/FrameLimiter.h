@@ -0,0 +1,52 @@
+#pragma once
+#include "pch.h"
+
+// Bounds of the time before a deadline that is spun rather than slept
+#define FRAME_LIMITER_MIN_SPIN_MICROSECONDS 100
+#define FRAME_LIMITER_MAX_SPIN_MICROSECONDS 4000
+
+// Holds the main loop to a target frame time. Most of the wait is an OS sleep that ends short of
+// the deadline by the worst oversleep seen recently, the rest is spun on the clock. Deadlines
+// advance by whole frame times so that wake up errors do not accumulate, and a frame finishing past
+// its deadline is counted as a miss and restarts the schedule instead of causing catch-up frames
+class FrameLimiter
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FrameLimiter();
+    ~FrameLimiter();
+    // Zero disables the limiter
+    void SetTargetFrameRate(double FramesPerSecond);
+    // Rounds the frame time to whole refresh intervals, so that every frame is shown for the same
+    // number of refreshes instead of beating against the display when the rates are close
+    void SetDisplayRefreshRate(double RefreshRate);
+    bool IsEnabled() const { return m_FrameTime.count() > 0; }
+
+    void Reset();
+    // Blocks until the next frame is due
+    void Wait();
+
+    uint64_t GetNumFrames() const { return m_NumFrames; }
+    uint64_t GetNumMissedDeadlines() const { return m_NumMissedDeadlines; }
+    void LogStatistics() const;
+
+private:
+    void UpdateFrameTime();
+    void SleepFor(Clock::duration Duration);
+
+    Clock::duration m_TargetFrameTime;
+    Clock::duration m_RefreshInterval;
+    Clock::duration m_FrameTime;
+    Clock::duration m_SpinThreshold;
+    Clock::time_point m_Deadline;
+
+    uint64_t m_NumFrames;
+    uint64_t m_NumMissedDeadlines;
+    Clock::duration m_MaxLateness;
+    Clock::duration m_TotalWakeError;
+    Clock::duration m_MaxWakeError;
+#ifdef _WIN32
+    void* m_TimerHandle;
+#endif
+};
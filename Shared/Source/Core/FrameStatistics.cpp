@@ -0,0 +1,223 @@
+#include "FrameStatistics.h"
+
+// Fixed precision without going through the stream formatting state
+static void WriteNumber(std::ofstream& File, float Number)
+{
+    char Text[32];
+    int Length = std::snprintf(Text, sizeof(Text), "%.4f", Number);
+    File.write(Text, Length);
+}
+
+FrameStatistics::FrameStatistics()
+{
+    m_Scratch.reserve(FRAME_STATISTICS_WINDOW);
+}
+
+void FrameStatistics::Reset()
+{
+    m_Cpu = {};
+    m_Gpu = {};
+}
+
+void FrameStatistics::Series::Add(float Milliseconds)
+{
+    Window[NumFrames & (FRAME_STATISTICS_WINDOW - 1)] = Milliseconds;
+
+    // Chunks never reallocate, so a long run does not copy its history in the middle of a frame
+    if (Chunks.empty() || Chunks.back().size() == FRAME_STATISTICS_CHUNK)
+    {
+        Chunks.emplace_back().reserve(FRAME_STATISTICS_CHUNK);
+    }
+
+    Chunks.back().push_back(Milliseconds);
+    NumFrames++;
+}
+
+bool FrameStatistics::Write(const std::filesystem::path& Path) const
+{
+    std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+    if (!File)
+    {
+        DEBUG_WARNING("Failed to write frame statistics to %s", Path.string().c_str());
+        return false;
+    }
+
+    bool Written = Path.extension() == ".json" ? WriteJson(File) : WriteCsv(File);
+
+    DEBUG_DISPLAY("Frame statistics: %llu frames written to %s", m_Cpu.NumFrames,
+        Path.string().c_str());
+
+    return Written;
+}
+
+void FrameStatistics::LogStatistics() const
+{
+    std::vector<float> Cpu = GetRun(m_Cpu);
+    std::vector<float> Gpu = GetRun(m_Gpu);
+
+    const char* Names[] = {"CPU", "GPU"};
+    FrameTimePercentiles Run[] = {ComputePercentiles(Cpu), ComputePercentiles(Gpu)};
+
+    for (uint32_t Index = 0; Index < 2; ++Index)
+    {
+        if (Run[Index].NumFrames == 0)
+        {
+            continue;
+        }
+
+        DEBUG_DISPLAY("%s frame time over %llu frames: %.3f ms avg, %.3f ms p50, %.3f ms p95, "
+                      "%.3f ms p99, %.3f ms max",
+            Names[Index], Run[Index].NumFrames, Run[Index].Average, Run[Index].P50,
+            Run[Index].P95, Run[Index].P99, Run[Index].Max);
+    }
+}
+
+FrameTimePercentiles FrameStatistics::GetPercentiles(const Series& Source) const
+{
+    m_Scratch.assign(Source.Window.begin(), Source.Window.begin() + Source.GetWindowSize());
+    return ComputePercentiles(m_Scratch);
+}
+
+FrameTimeHistogram FrameStatistics::GetHistogram(const Series& Source) const
+{
+    m_Scratch.assign(Source.Window.begin(), Source.Window.begin() + Source.GetWindowSize());
+    return ComputeHistogram(m_Scratch);
+}
+
+FrameTimePercentiles FrameStatistics::ComputePercentiles(std::vector<float>& Times)
+{
+    FrameTimePercentiles Percentiles;
+    Percentiles.NumFrames = Times.size();
+
+    if (Times.empty())
+    {
+        return Percentiles;
+    }
+
+    std::sort(Times.begin(), Times.end());
+
+    // Nearest rank, the smallest time that at least the given share of frames does not exceed
+    auto GetPercentile = [&Times](double Percentile)
+    {
+        size_t Rank = static_cast<size_t>(std::ceil(Percentile * Times.size()));
+        return Times[std::clamp<size_t>(Rank, 1, Times.size()) - 1];
+    };
+
+    double Total = 0.0;
+    for (float Time : Times)
+    {
+        Total += Time;
+    }
+
+    Percentiles.Average = static_cast<float>(Total / Times.size());
+    Percentiles.P50 = GetPercentile(0.50);
+    Percentiles.P95 = GetPercentile(0.95);
+    Percentiles.P99 = GetPercentile(0.99);
+    Percentiles.Max = Times.back();
+
+    return Percentiles;
+}
+
+FrameTimeHistogram FrameStatistics::ComputeHistogram(const std::vector<float>& Times)
+{
+    FrameTimeHistogram Histogram = {};
+
+    for (float Time : Times)
+    {
+        uint32_t Bucket = static_cast<uint32_t>(std::max(Time, 0.0f) /
+                                                FRAME_STATISTICS_BUCKET_MILLISECONDS);
+        Histogram[std::min<uint32_t>(Bucket, FRAME_STATISTICS_HISTOGRAM_BUCKETS - 1)]++;
+    }
+
+    return Histogram;
+}
+
+std::vector<float> FrameStatistics::GetRun(const Series& Source)
+{
+    std::vector<float> Times;
+    Times.reserve(Source.NumFrames);
+
+    for (auto& Chunk : Source.Chunks)
+    {
+        Times.insert(Times.end(), Chunk.begin(), Chunk.end());
+    }
+
+    return Times;
+}
+
+bool FrameStatistics::WriteCsv(std::ofstream& File) const
+{
+    std::vector<float> Cpu = GetRun(m_Cpu);
+    std::vector<float> Gpu = GetRun(m_Gpu);
+
+    // GPU times trail by the frames in flight, the row of a frame is its position in each series
+    File << "Frame,CpuMilliseconds,GpuMilliseconds\n";
+
+    for (size_t Index = 0; Index < std::max(Cpu.size(), Gpu.size()); ++Index)
+    {
+        File << Index << ',';
+        if (Index < Cpu.size())
+        {
+            WriteNumber(File, Cpu[Index]);
+        }
+
+        File << ',';
+        if (Index < Gpu.size())
+        {
+            WriteNumber(File, Gpu[Index]);
+        }
+
+        File << '\n';
+    }
+
+    return File.good();
+}
+
+bool FrameStatistics::WriteJson(std::ofstream& File) const
+{
+    const char* Names[] = {"cpu", "gpu"};
+    const Series* Sources[] = {&m_Cpu, &m_Gpu};
+
+    File << "{\n\"histogramBucketMilliseconds\":";
+    WriteNumber(File, FRAME_STATISTICS_BUCKET_MILLISECONDS);
+
+    for (uint32_t Index = 0; Index < 2; ++Index)
+    {
+        std::vector<float> Times = GetRun(*Sources[Index]);
+        FrameTimeHistogram Histogram = ComputeHistogram(Times);
+
+        File << ",\n\"" << Names[Index] << "\":{\"times\":[";
+
+        for (size_t Frame = 0; Frame < Times.size(); ++Frame)
+        {
+            File << (Frame > 0 ? "," : "");
+            WriteNumber(File, Times[Frame]);
+        }
+
+        File << "],\"histogram\":[";
+
+        for (uint32_t Bucket = 0; Bucket < FRAME_STATISTICS_HISTOGRAM_BUCKETS; ++Bucket)
+        {
+            File << (Bucket > 0 ? "," : "") << Histogram[Bucket];
+        }
+
+        // Sorts the times, so it comes after they have been written
+        FrameTimePercentiles Run = ComputePercentiles(Times);
+
+        File << "],\"frames\":" << Run.NumFrames << ",\"average\":";
+        WriteNumber(File, Run.Average);
+        File << ",\"p50\":";
+        WriteNumber(File, Run.P50);
+        File << ",\"p95\":";
+        WriteNumber(File, Run.P95);
+        File << ",\"p99\":";
+        WriteNumber(File, Run.P99);
+        File << ",\"max\":";
+        WriteNumber(File, Run.Max);
+        File << "}";
+    }
+
+    File << "\n}\n";
+
+    return File.good();
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "pch.h"
+
+// Frames in the rolling window, a power of two
+#define FRAME_STATISTICS_WINDOW 1024
+#define FRAME_STATISTICS_CHUNK 4096
+#define FRAME_STATISTICS_HISTOGRAM_BUCKETS 32
+// The last bucket also counts every longer frame
+#define FRAME_STATISTICS_BUCKET_MILLISECONDS 1.0f
+
+struct FrameTimePercentiles
+{
+    uint64_t NumFrames = 0;
+    float Average = 0.0f;
+    float P50 = 0.0f;
+    float P95 = 0.0f;
+    float P99 = 0.0f;
+    float Max = 0.0f;
+};
+
+using FrameTimeHistogram = std::array<uint32_t, FRAME_STATISTICS_HISTOGRAM_BUCKETS>;
+
+// Per frame CPU and GPU times in milliseconds. The latest frames are kept in fixed rings for the
+// rolling percentiles and histograms, and every frame of the run is kept in chunks for the export
+// at exit. GPU times are read back a few frames late and are recorded as their own series
+class FrameStatistics
+{
+public:
+    FrameStatistics();
+    ~FrameStatistics() = default;
+    void Reset();
+
+    void AddCpuFrame(float Milliseconds) { m_Cpu.Add(Milliseconds); }
+    void AddGpuFrame(float Milliseconds) { m_Gpu.Add(Milliseconds); }
+    bool HasGpuFrames() const { return m_Gpu.NumFrames > 0; }
+
+    FrameTimePercentiles GetCpuPercentiles() const { return GetPercentiles(m_Cpu); }
+    FrameTimePercentiles GetGpuPercentiles() const { return GetPercentiles(m_Gpu); }
+    FrameTimeHistogram GetCpuHistogram() const { return GetHistogram(m_Cpu); }
+    FrameTimeHistogram GetGpuHistogram() const { return GetHistogram(m_Gpu); }
+
+    // Writes every frame of the run, as JSON when the extension is .json and as CSV otherwise
+    bool Write(const std::filesystem::path& Path) const;
+    void LogStatistics() const;
+
+private:
+    struct Series
+    {
+        std::array<float, FRAME_STATISTICS_WINDOW> Window = {};
+        std::vector<std::vector<float>> Chunks;
+        uint64_t NumFrames = 0;
+
+        void Add(float Milliseconds);
+        uint32_t GetWindowSize() const
+        {
+            return static_cast<uint32_t>(std::min<uint64_t>(NumFrames, FRAME_STATISTICS_WINDOW));
+        }
+    };
+
+    FrameTimePercentiles GetPercentiles(const Series& Source) const;
+    FrameTimeHistogram GetHistogram(const Series& Source) const;
+    static FrameTimePercentiles ComputePercentiles(std::vector<float>& Times);
+    static FrameTimeHistogram ComputeHistogram(const std::vector<float>& Times);
+    static std::vector<float> GetRun(const Series& Source);
+    bool WriteCsv(std::ofstream& File) const;
+    bool WriteJson(std::ofstream& File) const;
+
+    Series m_Cpu;
+    Series m_Gpu;
+    mutable std::vector<float> m_Scratch;
+};
@@ -0,0 +1,338 @@
+#include "JobSystem.h"
+
+thread_local const JobSystem* JobSystem::sm_ThreadOwner = nullptr;
+thread_local uint32_t JobSystem::sm_ThreadIndex = UINT32_MAX;
+
+JobQueue::JobQueue() : m_Top(0), m_Bottom(0)
+{
+    for (auto& Slot : m_Jobs)
+    {
+        Slot.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+bool JobQueue::Push(Job* NewJob)
+{
+    int64_t Bottom = m_Bottom.load(std::memory_order_relaxed);
+    int64_t Top = m_Top.load(std::memory_order_acquire);
+
+    if (Bottom - Top >= JOB_QUEUE_CAPACITY)
+    {
+        return false;
+    }
+
+    m_Jobs[Bottom & (JOB_QUEUE_CAPACITY - 1)].store(NewJob, std::memory_order_relaxed);
+    m_Bottom.store(Bottom + 1, std::memory_order_release);
+    return true;
+}
+
+Job* JobQueue::Pop()
+{
+    int64_t Bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+    m_Bottom.store(Bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t Top = m_Top.load(std::memory_order_relaxed);
+
+    if (Top > Bottom)
+    {
+        m_Bottom.store(Bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* CurrentJob = m_Jobs[Bottom & (JOB_QUEUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+
+    // Last job left, race against the thieves for it
+    if (Top == Bottom)
+    {
+        if (!m_Top.compare_exchange_strong(
+                Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            CurrentJob = nullptr;
+        }
+        m_Bottom.store(Bottom + 1, std::memory_order_relaxed);
+    }
+
+    return CurrentJob;
+}
+
+Job* JobQueue::Steal()
+{
+    int64_t Top = m_Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t Bottom = m_Bottom.load(std::memory_order_acquire);
+
+    if (Top >= Bottom)
+    {
+        return nullptr;
+    }
+
+    Job* CurrentJob = m_Jobs[Top & (JOB_QUEUE_CAPACITY - 1)].load(std::memory_order_acquire);
+
+    if (!m_Top.compare_exchange_strong(
+            Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+
+    return CurrentJob;
+}
+
+JobSystem::JobSystem() : m_Running(false), m_WakeCount(0), m_NumInjectedJobs(0) {}
+
+JobSystem::~JobSystem()
+{
+    Destroy();
+}
+
+void JobSystem::Init(uint32_t NumThreads)
+{
+    DEBUG_ASSERT(!m_Running, "Job system already initialized");
+
+    if (NumThreads == 0)
+    {
+        NumThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_Queues.resize(NumThreads);
+    for (auto& Queue : m_Queues)
+    {
+        Queue = std::make_unique<JobQueue>();
+    }
+
+    m_Running = true;
+
+    // The calling thread takes index 0 and helps through Wait instead of owning a worker
+    sm_ThreadOwner = this;
+    sm_ThreadIndex = 0;
+
+    for (uint32_t ThreadIndex = 1; ThreadIndex < NumThreads; ++ThreadIndex)
+    {
+        m_Threads.emplace_back(&JobSystem::WorkerLoop, this, ThreadIndex);
+    }
+
+    DEBUG_DISPLAY("Job system threads: %u", NumThreads);
+}
+
+void JobSystem::Destroy()
+{
+    if (!m_Running)
+    {
+        return;
+    }
+
+    m_Running = false;
+    m_WakeCount.fetch_add(1, std::memory_order_release);
+    m_WakeCount.notify_all();
+
+    for (auto& Thread : m_Threads)
+    {
+        Thread.join();
+    }
+
+    m_Threads.clear();
+    m_Queues.clear();
+    m_InjectedJobs.clear();
+    m_NumInjectedJobs.store(0, std::memory_order_relaxed);
+
+    if (sm_ThreadOwner == this)
+    {
+        sm_ThreadOwner = nullptr;
+        sm_ThreadIndex = UINT32_MAX;
+    }
+}
+
+void JobSystem::Run(const JobFunction& Function, JobCounter* Counter, JobCounter* Dependency)
+{
+    Job* NewJob = new Job{Function, Counter};
+
+    if (Counter)
+    {
+        Counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (Dependency)
+    {
+        std::lock_guard<std::mutex> Lock(m_DependentsMutex);
+
+        if (!Dependency->IsDone())
+        {
+            Dependency->m_Dependents.push_back(NewJob);
+            return;
+        }
+    }
+
+    Enqueue(NewJob);
+}
+
+void JobSystem::ParallelFor(uint32_t Count, uint32_t BatchSize, const ParallelForFunction& Function,
+    JobCounter* Counter, JobCounter* Dependency)
+{
+    BatchSize = std::max(1u, BatchSize);
+
+    for (uint32_t Begin = 0; Begin < Count; Begin += BatchSize)
+    {
+        uint32_t End = std::min(Begin + BatchSize, Count);
+        Run([Function, Begin, End]() { Function(Begin, End); }, Counter, Dependency);
+    }
+}
+
+void JobSystem::Wait(JobCounter& Counter)
+{
+    // Jobs may rely on GetThreadIndex, so only threads of this system run them while waiting
+    bool Helping = GetThreadIndex() < m_Queues.size();
+    CHECK(Helping || !m_Threads.empty(), "Waiting outside the job system without any workers");
+
+    while (!Counter.IsDone())
+    {
+        if (Job* CurrentJob = Helping ? GetJob() : nullptr)
+        {
+            Execute(CurrentJob);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::WorkerLoop(uint32_t ThreadIndex)
+{
+    sm_ThreadOwner = this;
+    sm_ThreadIndex = ThreadIndex;
+    PROFILE_THREAD(Utility::Format("Worker %u", ThreadIndex));
+
+    while (m_Running.load(std::memory_order_acquire))
+    {
+        uint32_t WakeCount = m_WakeCount.load(std::memory_order_acquire);
+
+        if (Job* CurrentJob = GetJob())
+        {
+            Execute(CurrentJob);
+            continue;
+        }
+
+        // Nothing to run or steal, sleep until the next submission
+        m_WakeCount.wait(WakeCount, std::memory_order_acquire);
+    }
+}
+
+void JobSystem::Enqueue(Job* NewJob)
+{
+    uint32_t ThreadIndex = GetThreadIndex();
+
+    // Threads without a queue of their own, such as I/O callbacks, hand the job to the workers
+    if (ThreadIndex >= m_Queues.size())
+    {
+        std::lock_guard<std::mutex> Lock(m_InjectedMutex);
+        m_InjectedJobs.push_back(NewJob);
+        m_NumInjectedJobs.fetch_add(1, std::memory_order_release);
+    }
+    else if (!m_Queues[ThreadIndex]->Push(NewJob))
+    {
+        Execute(NewJob);
+        return;
+    }
+
+    m_WakeCount.fetch_add(1, std::memory_order_release);
+    m_WakeCount.notify_one();
+}
+
+Job* JobSystem::GetJob()
+{
+    uint32_t NumQueues = static_cast<uint32_t>(m_Queues.size());
+    uint32_t ThreadIndex = GetThreadIndex();
+
+    if (Job* CurrentJob = m_Queues[ThreadIndex]->Pop())
+    {
+        return CurrentJob;
+    }
+
+    if (Job* CurrentJob = TakeInjectedJob())
+    {
+        return CurrentJob;
+    }
+
+    for (uint32_t Offset = 1; Offset < NumQueues; ++Offset)
+    {
+        if (Job* CurrentJob = m_Queues[(ThreadIndex + Offset) % NumQueues]->Steal())
+        {
+            return CurrentJob;
+        }
+    }
+
+    return nullptr;
+}
+
+Job* JobSystem::TakeInjectedJob()
+{
+    // Checked without the lock first, the queue is empty unless outside threads submit
+    if (m_NumInjectedJobs.load(std::memory_order_acquire) == 0)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> Lock(m_InjectedMutex);
+
+    if (m_InjectedJobs.empty())
+    {
+        return nullptr;
+    }
+
+    Job* CurrentJob = m_InjectedJobs.front();
+    m_InjectedJobs.pop_front();
+    m_NumInjectedJobs.fetch_sub(1, std::memory_order_relaxed);
+    return CurrentJob;
+}
+
+void JobSystem::Execute(Job* CurrentJob)
+{
+    {
+        PROFILE_SCOPE("Job");
+        CurrentJob->Function();
+    }
+
+    JobCounter* Counter = CurrentJob->Counter;
+    delete CurrentJob;
+
+    if (Counter)
+    {
+        Release(Counter);
+    }
+}
+
+void JobSystem::Release(JobCounter* Counter)
+{
+    // A waiter may destroy the counter as soon as it reads zero, so reaching zero has to be the
+    // last access to it: the dependents are detached first and the count dropped under the lock
+    uint32_t Value = Counter->m_Value.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        if (Value > 1)
+        {
+            if (Counter->m_Value.compare_exchange_weak(Value, Value - 1, std::memory_order_acq_rel))
+            {
+                return;
+            }
+            continue;
+        }
+
+        std::vector<Job*> Dependents;
+        {
+            std::lock_guard<std::mutex> Lock(m_DependentsMutex);
+            Dependents.swap(Counter->m_Dependents);
+
+            if (!Counter->m_Value.compare_exchange_strong(Value, 0, std::memory_order_acq_rel))
+            {
+                Counter->m_Dependents.swap(Dependents);
+                continue;
+            }
+        }
+
+        for (Job* Dependent : Dependents)
+        {
+            Enqueue(Dependent);
+        }
+        return;
+    }
+}
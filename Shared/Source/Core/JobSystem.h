@@ -0,0 +1,86 @@
+#pragma once
+#include "pch.h"
+
+#define JOB_QUEUE_CAPACITY 4096
+
+using JobFunction = std::function<void()>;
+using ParallelForFunction = std::function<void(uint32_t Begin, uint32_t End)>;
+
+class JobCounter;
+
+struct Job
+{
+    JobFunction Function;
+    JobCounter* Counter = nullptr;
+};
+
+class JobCounter
+{
+public:
+    JobCounter() : m_Value(0) {}
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+    uint32_t GetValue() const { return m_Value.load(std::memory_order_acquire); }
+    bool IsDone() const { return GetValue() == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> m_Value;
+    std::vector<Job*> m_Dependents;
+};
+
+// Chase-Lev work-stealing deque: the owner thread pushes and pops at the bottom, any other
+// thread steals from the top
+class JobQueue
+{
+public:
+    JobQueue();
+    bool Push(Job* NewJob);
+    Job* Pop();
+    Job* Steal();
+
+private:
+    alignas(64) std::atomic<int64_t> m_Top;
+    alignas(64) std::atomic<int64_t> m_Bottom;
+    std::array<std::atomic<Job*>, JOB_QUEUE_CAPACITY> m_Jobs;
+};
+
+// Runs jobs on a pool of workers, each owning a work-stealing queue. The thread that called Init
+// takes part as thread 0 while it waits. Any other thread, including one that belongs to another
+// job system, submits to a shared injection queue that the workers drain before stealing from
+// each other, and waits without running jobs itself
+class JobSystem
+{
+public:
+    JobSystem();
+    ~JobSystem();
+    void Init(uint32_t NumThreads = 0);
+    void Destroy();
+    uint32_t GetNumThreads() const { return static_cast<uint32_t>(m_Queues.size()); }
+    uint32_t GetThreadIndex() const { return sm_ThreadOwner == this ? sm_ThreadIndex : UINT32_MAX; }
+
+    void Run(const JobFunction& Function, JobCounter* Counter = nullptr,
+        JobCounter* Dependency = nullptr);
+    void ParallelFor(uint32_t Count, uint32_t BatchSize, const ParallelForFunction& Function,
+        JobCounter* Counter, JobCounter* Dependency = nullptr);
+    void Wait(JobCounter& Counter);
+
+private:
+    void WorkerLoop(uint32_t ThreadIndex);
+    void Enqueue(Job* NewJob);
+    Job* GetJob();
+    Job* TakeInjectedJob();
+    void Execute(Job* CurrentJob);
+    void Release(JobCounter* Counter);
+
+    std::vector<std::unique_ptr<JobQueue>> m_Queues;
+    std::vector<std::thread> m_Threads;
+    std::atomic<bool> m_Running;
+    std::atomic<uint32_t> m_WakeCount;
+    std::deque<Job*> m_InjectedJobs;
+    std::atomic<uint32_t> m_NumInjectedJobs;
+    std::mutex m_InjectedMutex;
+    std::mutex m_DependentsMutex;
+    static thread_local const JobSystem* sm_ThreadOwner;
+    static thread_local uint32_t sm_ThreadIndex;
+};
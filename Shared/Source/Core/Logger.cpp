@@ -1,82 +1,369 @@
 #include "Logger.h"
 
-SeverityLevel Logger::sm_SeverityLevel = SeverityLevel::LOG;
+static std::vector<std::unique_ptr<LogSink>> CreateDefaultSinks()
+{
+    std::vector<std::unique_ptr<LogSink>> Sinks;
+    Sinks.push_back(std::make_unique<ConsoleLogSink>());
+    return Sinks;
+}
+
+std::atomic<SeverityLevel> Logger::sm_SeverityLevel = SeverityLevel::LOG;
+std::atomic<uint64_t> Logger::sm_NumDropped = 0;
+Logger::Record Logger::sm_Records[LOGGER_QUEUE_RECORDS];
+std::atomic<uint64_t> Logger::sm_EnqueuePosition = 0;
+std::atomic<uint64_t> Logger::sm_DequeuePosition = 0;
+std::atomic<uint64_t> Logger::sm_FlushedPosition = 0;
+std::atomic<uint32_t> Logger::sm_Wakeups = 0;
+std::atomic<bool> Logger::sm_WorkerWaiting = false;
+std::atomic<bool> Logger::sm_Running = false;
+std::thread Logger::sm_Thread;
+std::mutex Logger::sm_SinkMutex;
+std::vector<std::unique_ptr<LogSink>> Logger::sm_Sinks = CreateDefaultSinks();
+
+// Stops the worker when Destroy was skipped, for instance when initialization threw
+static struct LoggerShutdown
+{
+    ~LoggerShutdown() { Logger::Destroy(); }
+} Shutdown;
+
+void ConsoleLogSink::Write(const LogMessage& Message)
+{
+    const char* Color = "\033[0m";
+
+    switch (Message.Severity)
+    {
+    case SeverityLevel::INFO:
+        Color = "\033[94m";
+        break;
+    case SeverityLevel::WARNING:
+        Color = "\033[93m";
+        break;
+    case SeverityLevel::ERROR:
+        Color = "\033[91m";
+        break;
+    case SeverityLevel::FATAL:
+        Color = "\033[31m";
+        break;
+    case SeverityLevel::DISPLAY:
+        Color = "\033[92m";
+        break;
+    default:
+        break;
+    }
+
+    m_Line.assign(Color).append("[").append(Message.Label).append("] ").append(Message.Text);
+
+    if (Message.File && Message.File[0] != '\0')
+    {
+        m_Line.append("\n(").append(Message.File).append(":");
+        m_Line.append(std::to_string(Message.Line)).append(")");
+    }
+
+    m_Line.append("\033[0m\n");
+    std::cout.write(m_Line.data(), m_Line.size());
+}
+
+void ConsoleLogSink::Flush()
+{
+    std::cout.flush();
+}
+
+FileLogSink::FileLogSink(const std::filesystem::path& Path)
+    : m_File(Path, std::ios::binary | std::ios::trunc)
+{
+}
+
+void FileLogSink::Write(const LogMessage& Message)
+{
+    // UTC time of day with milliseconds
+    auto Today = Message.Time.time_since_epoch() % std::chrono::days(1);
+    auto Milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(Today).count();
+
+    char Time[32];
+    std::snprintf(Time, sizeof(Time), "%02d:%02d:%02d.%03d ",
+        static_cast<int>(Milliseconds / 3600000), static_cast<int>(Milliseconds / 60000 % 60),
+        static_cast<int>(Milliseconds / 1000 % 60), static_cast<int>(Milliseconds % 1000));
+
+    m_Line.assign(Time).append("[").append(Message.Label).append("] ").append(Message.Text);
+
+    if (Message.File && Message.File[0] != '\0')
+    {
+        m_Line.append(" (").append(Message.File).append(":");
+        m_Line.append(std::to_string(Message.Line)).append(")");
+    }
+
+    m_Line.append("\n");
+    m_File.write(m_Line.data(), m_Line.size());
+}
+
+void FileLogSink::Flush()
+{
+    m_File.flush();
+}
+
+void Logger::Init()
+{
+    static_assert(sizeof(Record) == LOGGER_RECORD_SIZE, "Unexpected log record size");
+
+    if (sm_Running.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    for (uint64_t Index = 0; Index < LOGGER_QUEUE_RECORDS; ++Index)
+    {
+        sm_Records[Index].Sequence.store(Index, std::memory_order_relaxed);
+    }
+
+    sm_EnqueuePosition.store(0, std::memory_order_relaxed);
+    sm_DequeuePosition.store(0, std::memory_order_relaxed);
+    sm_FlushedPosition.store(0, std::memory_order_relaxed);
+    sm_Running.store(true, std::memory_order_release);
+
+    sm_Thread = std::thread(&Logger::WorkerLoop);
+}
+
+void Logger::Destroy()
+{
+    if (!sm_Running.exchange(false, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    // The worker drains the queue before it returns
+    Wake();
+    sm_Thread.join();
+}
+
+void Logger::Flush()
+{
+    if (!sm_Running.load(std::memory_order_acquire) ||
+        std::this_thread::get_id() == sm_Thread.get_id())
+    {
+        std::lock_guard<std::mutex> Lock(sm_SinkMutex);
+        FlushSinks();
+        return;
+    }
+
+    uint64_t Position = sm_EnqueuePosition.load(std::memory_order_acquire);
+    Wake();
+
+    while (sm_FlushedPosition.load(std::memory_order_acquire) < Position &&
+           sm_Running.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+}
 
 void Logger::SetSeverityLevel(SeverityLevel Severity)
 {
-    sm_SeverityLevel = Severity;
+    sm_SeverityLevel.store(Severity, std::memory_order_relaxed);
 }
 
 SeverityLevel Logger::GetSeverityLevel()
 {
-    return sm_SeverityLevel;
+    return sm_SeverityLevel.load(std::memory_order_relaxed);
 }
 
-void Logger::Log(SeverityLevel Severity, const std::string& Message)
+void Logger::AddSink(std::unique_ptr<LogSink> Sink)
 {
-    Output(Severity, "LOG", Message, "", 0);
+    std::lock_guard<std::mutex> Lock(sm_SinkMutex);
+    sm_Sinks.push_back(std::move(Sink));
 }
 
-void Logger::Display(SeverityLevel Severity, const std::string& Message)
+void Logger::ClearSinks()
 {
-    Output(Severity, "DISPLAY", Message, "", 0);
+    std::lock_guard<std::mutex> Lock(sm_SinkMutex);
+    FlushSinks();
+    sm_Sinks.clear();
 }
 
-void Logger::Info(SeverityLevel Severity, const std::string& Message)
+Logger::Record* Logger::BeginRecord(SeverityLevel Severity)
 {
-    Output(Severity, "INFO", Message, "", 0);
+    if (!sm_Running.load(std::memory_order_acquire))
+    {
+        return &sm_LocalRecord;
+    }
+
+    uint64_t Position = sm_EnqueuePosition.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        Record& Target = sm_Records[Position & (LOGGER_QUEUE_RECORDS - 1)];
+        uint64_t Sequence = Target.Sequence.load(std::memory_order_acquire);
+        int64_t Difference = static_cast<int64_t>(Sequence - Position);
+
+        if (Difference == 0)
+        {
+            if (sm_EnqueuePosition.compare_exchange_weak(
+                    Position, Position + 1, std::memory_order_relaxed))
+            {
+                return &Target;
+            }
+        }
+        else if (Difference < 0)
+        {
+            // Full, the worker has not written the record from a lap ago yet
+            if (Severity < SeverityLevel::ERROR)
+            {
+                sm_NumDropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            // Once Destroy has begun nothing may drain the queue anymore, write it directly
+            if (!sm_Running.load(std::memory_order_acquire))
+            {
+                return &sm_LocalRecord;
+            }
+
+            Wake();
+            std::this_thread::yield();
+            Position = sm_EnqueuePosition.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            Position = sm_EnqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
 }
 
-void Logger::Warning(SeverityLevel Severity, const std::string& Message, const char* File, int Line)
+void Logger::EndRecord(Record* Target)
 {
-    Output(Severity, "WARNING", Message, File, Line);
+    if (Target == &sm_LocalRecord)
+    {
+        std::string Text;
+        std::lock_guard<std::mutex> Lock(sm_SinkMutex);
+        WriteMessage(*Target, Text);
+        FlushSinks();
+        return;
+    }
+
+    uint64_t Position = Target->Sequence.load(std::memory_order_relaxed);
+    Target->Sequence.store(Position + 1, std::memory_order_release);
+
+    // Pairs with the fence of the worker, either it sees the record or this sees it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sm_WorkerWaiting.load(std::memory_order_relaxed))
+    {
+        Wake();
+    }
 }
 
-void Logger::Error(SeverityLevel Severity, const std::string& Message, const char* File, int Line)
+void Logger::Wake()
 {
-    Output(Severity, "ERROR", Message, File, Line);
+    sm_Wakeups.fetch_add(1, std::memory_order_release);
+    sm_Wakeups.notify_one();
 }
 
-void Logger::Fatal(SeverityLevel Severity, const std::string& Message, const char* File, int Line)
+void Logger::WorkerLoop()
 {
-    Output(Severity, "FATAL", Message, File, Line);
-    std::abort();
+    std::string Text;
+    uint64_t NumReportedDropped = 0;
+
+    while (true)
+    {
+        uint32_t Wakeups = sm_Wakeups.load(std::memory_order_acquire);
+        bool Written = false;
+
+        {
+            std::lock_guard<std::mutex> Lock(sm_SinkMutex);
+
+            while (WriteNext(Text))
+            {
+                Written = true;
+            }
+
+            uint64_t NumDropped = sm_NumDropped.load(std::memory_order_relaxed);
+            if (NumDropped != NumReportedDropped)
+            {
+                Text = std::to_string(NumDropped - NumReportedDropped) +
+                       " log messages dropped, the queue was full";
+                LogMessage Message = {SeverityLevel::WARNING, GetLabel(SeverityLevel::WARNING),
+                    Text, nullptr, 0, std::chrono::system_clock::now()};
+
+                for (auto& Sink : sm_Sinks)
+                {
+                    Sink->Write(Message);
+                }
+
+                NumReportedDropped = NumDropped;
+                Written = true;
+            }
+
+            if (Written)
+            {
+                FlushSinks();
+                sm_FlushedPosition.store(
+                    sm_DequeuePosition.load(std::memory_order_relaxed), std::memory_order_release);
+            }
+        }
+
+        if (Written)
+        {
+            continue;
+        }
+
+        if (!sm_Running.load(std::memory_order_acquire))
+        {
+            break;
+        }
+
+        sm_WorkerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        uint64_t Position = sm_DequeuePosition.load(std::memory_order_relaxed);
+        Record& Next = sm_Records[Position & (LOGGER_QUEUE_RECORDS - 1)];
+
+        if (Next.Sequence.load(std::memory_order_relaxed) != Position + 1)
+        {
+            sm_Wakeups.wait(Wakeups, std::memory_order_acquire);
+        }
+
+        sm_WorkerWaiting.store(false, std::memory_order_relaxed);
+    }
 }
 
-void Logger::Output(SeverityLevel Severity, const std::string& Label, const std::string& Message,
-    const char* File, int Line)
+bool Logger::WriteNext(std::string& Text)
 {
-    if (Severity < sm_SeverityLevel)
-        return;
+    uint64_t Position = sm_DequeuePosition.load(std::memory_order_relaxed);
+    Record& Target = sm_Records[Position & (LOGGER_QUEUE_RECORDS - 1)];
 
-    std::cout << GetColor(Severity) << "[" << Label << "] " << Message;
+    if (Target.Sequence.load(std::memory_order_acquire) != Position + 1)
+    {
+        return false;
+    }
 
-    if (File && File[0] != '\0')
-        std::cout << "\n(" << File << ":" << Line << ")";
+    WriteMessage(Target, Text);
 
-    std::cout << "\033[0m\n";
+    // Hands the record to the producer that claims it on the next lap
+    Target.Sequence.store(Position + LOGGER_QUEUE_RECORDS, std::memory_order_release);
+    sm_DequeuePosition.store(Position + 1, std::memory_order_relaxed);
+    return true;
 }
 
-const char* Logger::GetColor(SeverityLevel Severity)
+void Logger::WriteMessage(Record& Source, std::string& Text)
 {
-    switch (Severity)
+    Source.Decode(Source.Overflow ? Source.Overflow.get() : Source.Payload, Source.Format, Text);
+    Source.Overflow.reset();
+
+    LogMessage Message = {Source.Severity, GetLabel(Source.Severity), Text, Source.File,
+        Source.Line, Source.Time};
+
+    for (auto& Sink : sm_Sinks)
     {
-    case SeverityLevel::INFO:
-        return "\033[94m";
-    case SeverityLevel::WARNING:
-        return "\033[93m";
-    case SeverityLevel::ERROR:
-        return "\033[91m";
-    case SeverityLevel::FATAL:
-        return "\033[31m";
-    case SeverityLevel::DISPLAY:
-        return "\033[92m";
-    default:
-        return "\033[0m";
+        Sink->Write(Message);
     }
 }
 
-std::string Logger::GetLabel(SeverityLevel Severity)
+void Logger::FlushSinks()
+{
+    for (auto& Sink : sm_Sinks)
+    {
+        Sink->Flush();
+    }
+}
+
+const char* Logger::GetLabel(SeverityLevel Severity)
 {
     switch (Severity)
     {
@@ -95,4 +382,4 @@ std::string Logger::GetLabel(SeverityLevel Severity)
     default:
         return "UNKNOWN";
     }
-}
\ No newline at end of file
+}
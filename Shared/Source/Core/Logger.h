@@ -1,6 +1,10 @@
 #pragma once
 #include "pch.h"
 
+// Records in the queue, a power of two, and the size of one record
+#define LOGGER_QUEUE_RECORDS 2048
+#define LOGGER_RECORD_SIZE 256
+
 enum class SeverityLevel
 {
     LOG = 0,
@@ -11,57 +15,276 @@ enum class SeverityLevel
     FATAL,
 };
 
+struct LogMessage
+{
+    SeverityLevel Severity;
+    const char* Label;
+    const std::string& Text;
+    const char* File;
+    int Line;
+    std::chrono::system_clock::time_point Time;
+};
+
+class LogSink
+{
+public:
+    virtual ~LogSink() = default;
+    virtual void Write(const LogMessage& Message) = 0;
+    virtual void Flush() {}
+};
+
+// Colored output on the standard output
+class ConsoleLogSink : public LogSink
+{
+public:
+    void Write(const LogMessage& Message) override;
+    void Flush() override;
+
+private:
+    std::string m_Line;
+};
+
+// Timestamped plain text lines
+class FileLogSink : public LogSink
+{
+public:
+    FileLogSink(const std::filesystem::path& Path);
+    bool IsOpen() const { return m_File.is_open(); }
+    void Write(const LogMessage& Message) override;
+    void Flush() override;
+
+private:
+    std::ofstream m_File;
+    std::string m_Line;
+};
+
+// Packs a printf argument into a record, strings are copied behind the packed arguments
+template <typename T>
+struct LogArgument
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Log arguments are copied into the queue");
+    using Stored = T;
+
+    static size_t GetExtraSize(T Value) { return 0; }
+    static Stored Store(T Value, uint8_t* Payload, uint8_t*& Extra) { return Value; }
+    static T Load(Stored Value, const uint8_t* Payload) { return Value; }
+};
+
+template <>
+struct LogArgument<const char*>
+{
+    using Stored = uint32_t;
+
+    static size_t GetExtraSize(const char* Value) { return Value ? std::strlen(Value) + 1 : 0; }
+
+    static Stored Store(const char* Value, uint8_t* Payload, uint8_t*& Extra)
+    {
+        if (Value == nullptr)
+        {
+            return UINT32_MAX;
+        }
+
+        size_t Size = std::strlen(Value) + 1;
+        std::memcpy(Extra, Value, Size);
+        Extra += Size;
+        return static_cast<uint32_t>(Extra - Size - Payload);
+    }
+
+    static const char* Load(Stored Offset, const uint8_t* Payload)
+    {
+        return Offset != UINT32_MAX ? reinterpret_cast<const char*>(Payload + Offset) : "(null)";
+    }
+};
+
+template <>
+struct LogArgument<char*> : LogArgument<const char*>
+{
+};
+
+// Text without a terminator, copied by size and read back terminated, pairs with "%.*s"
+template <>
+struct LogArgument<std::string_view>
+{
+    using Stored = uint32_t;
+
+    static size_t GetExtraSize(std::string_view Value) { return Value.size() + 1; }
+
+    static Stored Store(std::string_view Value, uint8_t* Payload, uint8_t*& Extra)
+    {
+        uint32_t Offset = static_cast<uint32_t>(Extra - Payload);
+
+        if (!Value.empty())
+        {
+            std::memcpy(Extra, Value.data(), Value.size());
+        }
+
+        Extra[Value.size()] = '\0';
+        Extra += Value.size() + 1;
+        return Offset;
+    }
+
+    static const char* Load(Stored Offset, const uint8_t* Payload)
+    {
+        return reinterpret_cast<const char*>(Payload + Offset);
+    }
+};
+
+using LogDecodeFunction = void (*)(const uint8_t* Payload, const char* Format, std::string& Out);
+
+// Callers check the severity, copy the format arguments into a bounded lock-free queue and return,
+// the messages are formatted and written to the sinks by a background thread. When the queue is
+// full messages below ERROR are dropped and counted, errors wait for room instead. Arguments too
+// large for a record are packed into a heap block it owns. Before Init and after Destroy messages
+// are formatted and written on the calling thread
 class Logger
 {
 public:
+    static void Init();
+    static void Destroy();
+    // Blocks until every message queued so far has been written
+    static void Flush();
+
     static void SetSeverityLevel(SeverityLevel Severity);
     static SeverityLevel GetSeverityLevel();
+    // A console sink is installed by default
+    static void AddSink(std::unique_ptr<LogSink> Sink);
+    static void ClearSinks();
+
+    static uint64_t GetNumDropped() { return sm_NumDropped.load(std::memory_order_relaxed); }
+
+    template <typename... Args>
+    static void Write(
+        SeverityLevel Severity, const char* File, int Line, const char* Format, Args... Arguments)
+    {
+        if (Severity < sm_SeverityLevel.load(std::memory_order_relaxed))
+        {
+            return;
+        }
 
-    static void Log(SeverityLevel Severity, const std::string& Message);
-    static void Display(SeverityLevel Severity, const std::string& Message);
-    static void Info(SeverityLevel Severity, const std::string& Message);
-    static void Warning(
-        SeverityLevel Severity, const std::string& Message, const char* File, int Line);
-    static void Error(
-        SeverityLevel Severity, const std::string& Message, const char* File, int Line);
-    static void Fatal(
-        SeverityLevel Severity, const std::string& Message, const char* File, int Line);
+        Record* Target = BeginRecord(Severity);
+        if (Target == nullptr)
+        {
+            return;
+        }
+
+        using Stored = std::tuple<typename LogArgument<Args>::Stored...>;
+        size_t Size = sizeof(Stored) + (LogArgument<Args>::GetExtraSize(Arguments) + ... + 0);
+
+        Target->Severity = Severity;
+        Target->File = File;
+        Target->Line = Line;
+        Target->Format = Format;
+        Target->Time = std::chrono::system_clock::now();
+
+        uint8_t* Payload = Target->Payload;
+        if (Size > sizeof(Target->Payload))
+        {
+            Target->Overflow = std::make_unique_for_overwrite<uint8_t[]>(Size);
+            Payload = Target->Overflow.get();
+        }
+
+        // Braced initialization keeps the strings in argument order
+        uint8_t* Extra = Payload + sizeof(Stored);
+        new (Payload) Stored{LogArgument<Args>::Store(Arguments, Payload, Extra)...};
+        Target->Decode = &Decode<Args...>;
+
+        EndRecord(Target);
+
+        if (Severity == SeverityLevel::FATAL)
+        {
+            Flush();
+            std::abort();
+        }
+    }
 
 private:
-    static void Output(SeverityLevel Severity, const std::string& Label, const std::string& Message,
-        const char* File, int Line);
+    struct alignas(64) Record
+    {
+        std::atomic<uint64_t> Sequence;
+        SeverityLevel Severity;
+        int Line;
+        const char* File;
+        const char* Format;
+        LogDecodeFunction Decode;
+        std::chrono::system_clock::time_point Time;
+        // Replaces the payload when the arguments do not fit, released once written
+        std::unique_ptr<uint8_t[]> Overflow;
+        alignas(8) uint8_t Payload[LOGGER_RECORD_SIZE - 56];
+    };
+
+    template <typename... Args>
+    static void Decode(const uint8_t* Payload, const char* Format, std::string& Out)
+    {
+        using Stored = std::tuple<typename LogArgument<Args>::Stored...>;
+        const Stored& Values = *reinterpret_cast<const Stored*>(Payload);
+
+        std::apply(
+            [&](const auto&... Value)
+            { FormatTo(Out, Format, LogArgument<Args>::Load(Value, Payload)...); },
+            Values);
+    }
+
+    template <typename... Args>
+    static void FormatTo(std::string& Out, const char* Format, Args... Arguments)
+    {
+        int Size = std::snprintf(nullptr, 0, Format, Arguments...);
+        Out.resize(std::max(Size, 0));
+        std::snprintf(Out.data(), Out.size() + 1, Format, Arguments...);
+    }
+
+    static Record* BeginRecord(SeverityLevel Severity);
+    static void EndRecord(Record* Target);
+    static void Wake();
+    static void WorkerLoop();
+    static bool WriteNext(std::string& Text);
+    static void WriteMessage(Record& Source, std::string& Text);
+    static void FlushSinks();
+
+    static const char* GetLabel(SeverityLevel Severity);
+
+    static std::atomic<SeverityLevel> sm_SeverityLevel;
+    static std::atomic<uint64_t> sm_NumDropped;
+
+    // Bounded multiple producer queue, a record is free for the producer that claims position P
+    // when its sequence is P and ready for the worker once the producer set it to P + 1
+    static Record sm_Records[LOGGER_QUEUE_RECORDS];
+    static std::atomic<uint64_t> sm_EnqueuePosition;
+    static std::atomic<uint64_t> sm_DequeuePosition;
+    static std::atomic<uint64_t> sm_FlushedPosition;
+    static std::atomic<uint32_t> sm_Wakeups;
+    static std::atomic<bool> sm_WorkerWaiting;
+    static std::atomic<bool> sm_Running;
+    static std::thread sm_Thread;
+    static inline thread_local Record sm_LocalRecord;
 
-    static const char* GetColor(SeverityLevel Severity);
-    static std::string GetLabel(SeverityLevel Severity);
-    static SeverityLevel sm_SeverityLevel;
+    static std::mutex sm_SinkMutex;
+    static std::vector<std::unique_ptr<LogSink>> sm_Sinks;
 };
 
 #ifdef _DEBUG
 #define DEBUG_ASSERT(Condition, ...)                      \
     if (!(bool)(Condition))                               \
     {                                                     \
+        Logger::Flush();                                  \
         Utility::Print("\033[31m[ASSERTION_ERROR] ");     \
         Utility::Printf("%s is false\n", #Condition);     \
-        Utility::Printf(##__VA_ARGS__);                   \
+        Utility::Printf(__VA_ARGS__);                     \
         Utility::Printf("\n(%s:%d)", __FILE__, __LINE__); \
         Utility::Print("\033[0m\n");                      \
         std::abort();                                     \
     }
 
-#define DEBUG_LOG(...) Logger::Log(SeverityLevel::LOG, Utility::Format(##__VA_ARGS__))
+#define DEBUG_LOG(...) Logger::Write(SeverityLevel::LOG, nullptr, 0, __VA_ARGS__)
 
-#define DEBUG_DISPLAY(...) Logger::Display(SeverityLevel::DISPLAY, Utility::Format(##__VA_ARGS__))
+#define DEBUG_DISPLAY(...) Logger::Write(SeverityLevel::DISPLAY, nullptr, 0, __VA_ARGS__)
 
-#define DEBUG_INFO(...) Logger::Info(SeverityLevel::INFO, Utility::Format(##__VA_ARGS__))
+#define DEBUG_INFO(...) Logger::Write(SeverityLevel::INFO, nullptr, 0, __VA_ARGS__)
 
-#define DEBUG_WARNING(...) \
-    Logger::Warning(SeverityLevel::WARNING, Utility::Format(##__VA_ARGS__), __FILE__, __LINE__)
+#define DEBUG_WARNING(...) Logger::Write(SeverityLevel::WARNING, __FILE__, __LINE__, __VA_ARGS__)
 
-#define DEBUG_ERROR(...) \
-    Logger::Error(SeverityLevel::ERROR, Utility::Format(##__VA_ARGS__), __FILE__, __LINE__)
+#define DEBUG_ERROR(...) Logger::Write(SeverityLevel::ERROR, __FILE__, __LINE__, __VA_ARGS__)
 
-#define DEBUG_FATAL(...) \
-    Logger::Fatal(SeverityLevel::FATAL, Utility::Format(##__VA_ARGS__), __FILE__, __LINE__)
+#define DEBUG_FATAL(...) Logger::Write(SeverityLevel::FATAL, __FILE__, __LINE__, __VA_ARGS__)
 #else
 #define DEBUG_ASSERT(Condition, ...)
 #define DEBUG_LOG(...)
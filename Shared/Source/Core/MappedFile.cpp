@@ -0,0 +1,285 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_Data(nullptr),
+      m_Size(0),
+      m_Open(false),
+      m_Mapped(false)
+#ifdef _WIN32
+      ,
+      m_FileHandle(nullptr),
+      m_MappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& Other) noexcept : MappedFile()
+{
+    *this = std::move(Other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& Other) noexcept
+{
+    if (this != &Other)
+    {
+        Close();
+        std::swap(m_Data, Other.m_Data);
+        std::swap(m_Size, Other.m_Size);
+        std::swap(m_Open, Other.m_Open);
+        std::swap(m_Mapped, Other.m_Mapped);
+        std::swap(m_Buffer, Other.m_Buffer);
+#ifdef _WIN32
+        std::swap(m_FileHandle, Other.m_FileHandle);
+        std::swap(m_MappingHandle, Other.m_MappingHandle);
+#endif
+    }
+
+    return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::filesystem::path& Path, FileAccessHint Hint)
+{
+    Close();
+
+    DWORD Flags = FILE_ATTRIBUTE_NORMAL;
+    if (Hint == FileAccessHint::SEQUENTIAL)
+    {
+        Flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    }
+    else if (Hint == FileAccessHint::RANDOM)
+    {
+        Flags |= FILE_FLAG_RANDOM_ACCESS;
+    }
+
+    HANDLE File = CreateFileW(
+        Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, Flags, nullptr);
+
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize))
+    {
+        CloseHandle(File);
+        return false;
+    }
+
+    size_t Size = static_cast<size_t>(FileSize.QuadPart);
+
+    if (Size < MAPPED_FILE_MIN_MAP_SIZE)
+    {
+        m_Buffer = std::make_unique_for_overwrite<uint8_t[]>(Size);
+
+        DWORD Read = 0;
+        bool Success = Size == 0 || (ReadFile(File, m_Buffer.get(), static_cast<DWORD>(Size),
+                                         &Read, nullptr) &&
+                                        Read == Size);
+        CloseHandle(File);
+
+        if (!Success)
+        {
+            m_Buffer.reset();
+            return false;
+        }
+
+        m_Data = m_Buffer.get();
+        m_Size = Size;
+        m_Open = true;
+        return true;
+    }
+
+    HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!Mapping)
+    {
+        CloseHandle(File);
+        return false;
+    }
+
+    void* Data = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!Data)
+    {
+        CloseHandle(Mapping);
+        CloseHandle(File);
+        return false;
+    }
+
+    m_Data = static_cast<const uint8_t*>(Data);
+    m_Size = Size;
+    m_Open = true;
+    m_Mapped = true;
+    m_FileHandle = File;
+    m_MappingHandle = Mapping;
+
+    if (Hint == FileAccessHint::WILL_NEED)
+    {
+        Prefetch(0, m_Size);
+    }
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Mapped)
+    {
+        UnmapViewOfFile(m_Data);
+        CloseHandle(m_MappingHandle);
+        CloseHandle(m_FileHandle);
+    }
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+    m_Mapped = false;
+    m_Buffer.reset();
+    m_FileHandle = nullptr;
+    m_MappingHandle = nullptr;
+}
+
+void MappedFile::Prefetch(size_t Offset, size_t Size) const
+{
+    std::span<const uint8_t> Range = GetSpan(Offset, Size);
+    if (!m_Mapped || Range.empty())
+    {
+        return;
+    }
+
+    WIN32_MEMORY_RANGE_ENTRY Entry = {const_cast<uint8_t*>(Range.data()), Range.size()};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &Entry, 0);
+}
+#else
+bool MappedFile::Open(const std::filesystem::path& Path, FileAccessHint Hint)
+{
+    Close();
+
+    int Descriptor = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (Descriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat Status;
+    if (fstat(Descriptor, &Status) != 0)
+    {
+        close(Descriptor);
+        return false;
+    }
+
+    size_t Size = static_cast<size_t>(Status.st_size);
+
+    if (Size < MAPPED_FILE_MIN_MAP_SIZE)
+    {
+        // Straight into the final buffer, without the zero fill of a vector
+        m_Buffer = std::make_unique_for_overwrite<uint8_t[]>(Size);
+
+        size_t Offset = 0;
+        while (Offset < Size)
+        {
+            ssize_t Read = read(Descriptor, m_Buffer.get() + Offset, Size - Offset);
+            if (Read < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (Read <= 0)
+            {
+                break;
+            }
+
+            Offset += static_cast<size_t>(Read);
+        }
+
+        close(Descriptor);
+
+        if (Offset != Size)
+        {
+            m_Buffer.reset();
+            return false;
+        }
+
+        m_Data = m_Buffer.get();
+        m_Size = Size;
+        m_Open = true;
+        return true;
+    }
+
+    // The mapping keeps its own reference to the file, the descriptor is not needed afterwards
+    void* Data = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, Descriptor, 0);
+    close(Descriptor);
+
+    if (Data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // Only a hint, a failure changes nothing about the mapping
+    if (Hint == FileAccessHint::SEQUENTIAL)
+    {
+        madvise(Data, Size, MADV_SEQUENTIAL);
+    }
+    else if (Hint == FileAccessHint::RANDOM)
+    {
+        madvise(Data, Size, MADV_RANDOM);
+    }
+    else if (Hint == FileAccessHint::WILL_NEED)
+    {
+        madvise(Data, Size, MADV_WILLNEED);
+    }
+
+    m_Data = static_cast<const uint8_t*>(Data);
+    m_Size = Size;
+    m_Open = true;
+    m_Mapped = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Mapped)
+    {
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+    }
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+    m_Mapped = false;
+    m_Buffer.reset();
+}
+
+void MappedFile::Prefetch(size_t Offset, size_t Size) const
+{
+    std::span<const uint8_t> Range = GetSpan(Offset, Size);
+    if (!m_Mapped || Range.empty())
+    {
+        return;
+    }
+
+    // madvise wants a page aligned start
+    uintptr_t PageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t Begin = reinterpret_cast<uintptr_t>(Range.data()) & ~(PageSize - 1);
+    uintptr_t End = reinterpret_cast<uintptr_t>(Range.data()) + Range.size();
+
+    madvise(reinterpret_cast<void*>(Begin), End - Begin, MADV_WILLNEED);
+}
+#endif
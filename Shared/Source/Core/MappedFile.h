@@ -0,0 +1,62 @@
+#pragma once
+#include "pch.h"
+
+// Smaller files are read into memory, mapping them costs more than copying them
+#define MAPPED_FILE_MIN_MAP_SIZE (64 * 1024)
+
+enum class FileAccessHint
+{
+    NORMAL = 0,
+    // Read once from front to back, read ahead aggressively
+    SEQUENTIAL,
+    // Scattered reads, read ahead only wastes memory
+    RANDOM,
+    // Start reading the whole file right away
+    WILL_NEED,
+};
+
+// Read-only view of a whole file. Large files are mapped so that loading them costs page faults
+// instead of copies, small ones are read into an owned buffer with a single copy. The view goes
+// away with the object, spans into it must not outlive it
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& Other) noexcept;
+    MappedFile& operator=(MappedFile&& Other) noexcept;
+
+    bool Open(const std::filesystem::path& Path, FileAccessHint Hint = FileAccessHint::NORMAL);
+    void Close();
+    // Asks the system to read a range of a mapped file that is about to be used
+    void Prefetch(size_t Offset, size_t Size) const;
+
+    bool IsOpen() const { return m_Open; }
+    bool IsMapped() const { return m_Mapped; }
+    const uint8_t* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+    std::span<const uint8_t> GetSpan() const { return {m_Data, m_Size}; }
+    // Empty when the range does not fit in the file
+    std::span<const uint8_t> GetSpan(size_t Offset, size_t Size) const
+    {
+        return Offset <= m_Size && Size <= m_Size - Offset ? GetSpan().subspan(Offset, Size)
+                                                           : std::span<const uint8_t>();
+    }
+    std::string_view GetText() const
+    {
+        return {reinterpret_cast<const char*>(m_Data), m_Size};
+    }
+
+private:
+    const uint8_t* m_Data;
+    size_t m_Size;
+    bool m_Open;
+    bool m_Mapped;
+    std::unique_ptr<uint8_t[]> m_Buffer;
+#ifdef _WIN32
+    void* m_FileHandle;
+    void* m_MappingHandle;
+#endif
+};
@@ -0,0 +1,79 @@
+#include "MeshFile.h"
+
+MeshFile::MeshFile() : m_Header(nullptr) {}
+
+bool MeshFile::Open(const std::filesystem::path& Path)
+{
+    Close();
+
+    // Everything is uploaded right after opening, so the whole file is read ahead
+    if (!m_File.Open(Path, FileAccessHint::WILL_NEED))
+    {
+        DEBUG_WARNING("Failed to open mesh %s", Path.string().c_str());
+        return false;
+    }
+
+    const MeshFileHeader* Header = reinterpret_cast<const MeshFileHeader*>(m_File.GetData());
+
+    if (m_File.GetSize() < sizeof(MeshFileHeader) || Header->Magic != MESH_FILE_MAGIC ||
+        Header->Version != MESH_FILE_VERSION)
+    {
+        DEBUG_WARNING("Discarding mesh %s: unknown format or version", Path.string().c_str());
+        Close();
+        return false;
+    }
+
+    bool Quantized = (Header->Flags & MESH_FLAG_QUANTIZED) != 0;
+    size_t VertexStride = Quantized ? sizeof(MeshQuantizedVertex) : sizeof(MeshVertex);
+    size_t IndexSize = (Header->Flags & MESH_FLAG_32BIT_INDICES) ? 4 : 2;
+
+    auto Submeshes = m_File.GetSpan(
+        Header->SubmeshOffset, static_cast<size_t>(Header->NumSubmeshes) * sizeof(MeshSubmesh));
+    m_VertexData = m_File.GetSpan(
+        Header->VertexOffset, static_cast<size_t>(Header->NumVertices) * VertexStride);
+    m_IndexData =
+        m_File.GetSpan(Header->IndexOffset, static_cast<size_t>(Header->NumIndices) * IndexSize);
+
+    // Empty spans at this point mean a section lies outside of the file
+    bool Valid = Header->VertexStride == VertexStride &&
+                 Submeshes.size() == Header->NumSubmeshes * sizeof(MeshSubmesh) &&
+                 m_VertexData.size() == Header->NumVertices * VertexStride &&
+                 m_IndexData.size() == Header->NumIndices * IndexSize &&
+                 Header->SubmeshOffset % MESH_FILE_ALIGNMENT == 0 &&
+                 Header->VertexOffset % MESH_FILE_ALIGNMENT == 0 &&
+                 Header->IndexOffset % MESH_FILE_ALIGNMENT == 0;
+
+    if (Valid)
+    {
+        m_Submeshes = {reinterpret_cast<const MeshSubmesh*>(Submeshes.data()),
+            Header->NumSubmeshes};
+
+        // Draws must stay inside the buffers, nothing else about the data is checked
+        for (const MeshSubmesh& Submesh : m_Submeshes)
+        {
+            Valid = Valid && Submesh.FirstIndex <= Header->NumIndices &&
+                    Submesh.NumIndices <= Header->NumIndices - Submesh.FirstIndex &&
+                    Submesh.FirstVertex <= Header->NumVertices &&
+                    Submesh.NumVertices <= Header->NumVertices - Submesh.FirstVertex;
+        }
+    }
+
+    if (!Valid)
+    {
+        DEBUG_WARNING("Discarding mesh %s: sections out of bounds", Path.string().c_str());
+        Close();
+        return false;
+    }
+
+    m_Header = Header;
+    return true;
+}
+
+void MeshFile::Close()
+{
+    m_File.Close();
+    m_Header = nullptr;
+    m_Submeshes = {};
+    m_VertexData = {};
+    m_IndexData = {};
+}
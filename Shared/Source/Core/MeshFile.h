@@ -0,0 +1,102 @@
+#pragma once
+#include "MappedFile.h"
+#include "pch.h"
+
+#define MESH_FILE_MAGIC 0x4853454d  // "MESH"
+#define MESH_FILE_VERSION 1
+// Sections start at multiples of this, so the mapped data can be copied to the GPU as it is
+#define MESH_FILE_ALIGNMENT 16
+
+// Positions are 16 bit unorm within the mesh bounds, normals and tangents are 10-10-10-2 snorm
+// and texture coordinates are half floats. Otherwise every attribute is a 32 bit float
+#define MESH_FLAG_QUANTIZED (1u << 0)
+#define MESH_FLAG_32BIT_INDICES (1u << 1)
+
+struct MeshBounds
+{
+    float Min[3];
+    float Max[3];
+    float Center[3];
+    float Radius;
+};
+
+// Interleaved vertex without quantization, VK_FORMAT_R32G32B32_SFLOAT positions and normals,
+// R32G32B32A32 tangents with the bitangent sign in w, R32G32 texture coordinates
+struct MeshVertex
+{
+    float Position[3];
+    float Normal[3];
+    float Tangent[4];
+    float TexCoord[2];
+};
+
+// Quantized vertex, R16G16B16A16_UNORM positions to scale by the mesh bounds,
+// A2B10G10R10_SNORM_PACK32 normals and tangents with the bitangent sign in the two bit field,
+// R16G16_SFLOAT texture coordinates
+struct MeshQuantizedVertex
+{
+    uint16_t Position[4];
+    uint32_t Normal;
+    uint32_t Tangent;
+    uint16_t TexCoord[2];
+};
+
+// One draw, indices are relative to the first vertex of the submesh
+struct MeshSubmesh
+{
+    uint32_t FirstIndex;
+    uint32_t NumIndices;
+    uint32_t FirstVertex;
+    uint32_t NumVertices;
+    uint32_t MaterialIndex;
+    uint32_t Reserved[3];
+    MeshBounds Bounds;
+};
+
+struct MeshFileHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t Flags;
+    uint32_t VertexStride;
+    uint32_t NumVertices;
+    uint32_t NumIndices;
+    uint32_t NumSubmeshes;
+    uint32_t Reserved;
+    MeshBounds Bounds;
+    // Byte offsets from the start of the file
+    uint64_t SubmeshOffset;
+    uint64_t VertexOffset;
+    uint64_t IndexOffset;
+};
+
+// Cooked mesh read in place from a mapping. Opening only checks that the header and the section
+// table fit in the file, the sections are then handed to the upload as they are
+class MeshFile
+{
+public:
+    MeshFile();
+    bool Open(const std::filesystem::path& Path);
+    void Close();
+
+    bool IsOpen() const { return m_Header != nullptr; }
+    const MeshFileHeader& GetHeader() const { return *m_Header; }
+    const MeshBounds& GetBounds() const { return m_Header->Bounds; }
+    bool IsQuantized() const { return (m_Header->Flags & MESH_FLAG_QUANTIZED) != 0; }
+    VkIndexType GetIndexType() const
+    {
+        return (m_Header->Flags & MESH_FLAG_32BIT_INDICES) ? VK_INDEX_TYPE_UINT32
+                                                           : VK_INDEX_TYPE_UINT16;
+    }
+
+    std::span<const MeshSubmesh> GetSubmeshes() const { return m_Submeshes; }
+    std::span<const uint8_t> GetVertexData() const { return m_VertexData; }
+    std::span<const uint8_t> GetIndexData() const { return m_IndexData; }
+
+private:
+    MappedFile m_File;
+    const MeshFileHeader* m_Header;
+    std::span<const MeshSubmesh> m_Submeshes;
+    std::span<const uint8_t> m_VertexData;
+    std::span<const uint8_t> m_IndexData;
+};
@@ -0,0 +1,119 @@
+#include "Profiler.h"
+
+std::mutex Profiler::sm_Mutex;
+std::vector<std::unique_ptr<ProfileThreadBuffer>> Profiler::sm_ThreadBuffers;
+uint64_t Profiler::sm_BaseTimestamp = 0;
+std::chrono::steady_clock::time_point Profiler::sm_BaseTime;
+
+static std::string EscapeJson(const std::string& Text)
+{
+    std::string Escaped;
+    Escaped.reserve(Text.size());
+
+    for (char Character : Text)
+    {
+        if (Character == '"' || Character == '\\')
+        {
+            Escaped += '\\';
+        }
+
+        Escaped += Character;
+    }
+
+    return Escaped;
+}
+
+void Profiler::Init()
+{
+    std::lock_guard<std::mutex> Lock(sm_Mutex);
+
+    sm_BaseTimestamp = GetTimestamp();
+    sm_BaseTime = std::chrono::steady_clock::now();
+}
+
+void Profiler::SetThreadName(const std::string& Name)
+{
+    ProfileThreadBuffer* Buffer = sm_ThreadBuffer ? sm_ThreadBuffer : RegisterThread();
+
+    std::lock_guard<std::mutex> Lock(sm_Mutex);
+    Buffer->Name = Name;
+}
+
+bool Profiler::WriteChromeTrace(const std::filesystem::path& Path)
+{
+    std::lock_guard<std::mutex> Lock(sm_Mutex);
+
+    std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+    if (!File)
+    {
+        DEBUG_WARNING("Failed to write profile capture to %s", Path.string().c_str());
+        return false;
+    }
+
+    // Timestamps are converted to microseconds against the time elapsed since Init
+    double TicksPerMicrosecond = GetTicksPerMicrosecond();
+    uint64_t NumEvents = 0;
+    uint64_t NumDropped = 0;
+
+    File << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    File << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"args\":{\"name\":\"Application\"}}";
+
+    for (auto& Buffer : sm_ThreadBuffers)
+    {
+        File << Utility::Format(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                                "\"args\":{\"name\":\"%s\"}}",
+            Buffer->ThreadIndex, EscapeJson(Buffer->Name).c_str());
+
+        uint64_t Head = Buffer->Head.load(std::memory_order_acquire);
+        uint64_t Count = std::min<uint64_t>(Head, PROFILER_EVENTS_PER_THREAD);
+
+        for (uint64_t Index = Head - Count; Index < Head; ++Index)
+        {
+            const ProfileEvent& Event = Buffer->Events[Index & (PROFILER_EVENTS_PER_THREAD - 1)];
+
+            double Begin =
+                static_cast<int64_t>(Event.Begin - sm_BaseTimestamp) / TicksPerMicrosecond;
+            double Duration = (Event.End - Event.Begin) / TicksPerMicrosecond;
+
+            File << Utility::Format(",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                                    "\"ts\":%.3f,\"dur\":%.3f}",
+                EscapeJson(Event.Name).c_str(), Buffer->ThreadIndex, Begin, Duration);
+        }
+
+        NumEvents += Count;
+        NumDropped += Head - Count;
+    }
+
+    File << "\n]}\n";
+
+    DEBUG_DISPLAY("Profile capture: %llu zones on %u threads written to %s (%llu overwritten)",
+        NumEvents, static_cast<uint32_t>(sm_ThreadBuffers.size()), Path.string().c_str(),
+        NumDropped);
+
+    return true;
+}
+
+ProfileThreadBuffer* Profiler::RegisterThread()
+{
+    // Buffers outlive their threads so that short lived threads still show up in the capture
+    auto Buffer = std::make_unique<ProfileThreadBuffer>();
+
+    std::lock_guard<std::mutex> Lock(sm_Mutex);
+
+    Buffer->ThreadIndex = static_cast<uint32_t>(sm_ThreadBuffers.size());
+    Buffer->Name = Utility::Format("Thread %u", Buffer->ThreadIndex);
+    sm_ThreadBuffer = Buffer.get();
+    sm_ThreadBuffers.push_back(std::move(Buffer));
+
+    return sm_ThreadBuffer;
+}
+
+double Profiler::GetTicksPerMicrosecond()
+{
+    std::chrono::duration<double, std::micro> Elapsed =
+        std::chrono::steady_clock::now() - sm_BaseTime;
+    uint64_t Ticks = GetTimestamp() - sm_BaseTimestamp;
+
+    return Elapsed.count() > 0.0 && Ticks > 0 ? Ticks / Elapsed.count() : 1.0;
+}
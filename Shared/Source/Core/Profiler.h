@@ -0,0 +1,99 @@
+#pragma once
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "pch.h"
+
+// Zones are compiled in with debug builds, define PROFILING_ENABLED to 1 to capture release builds
+#ifndef PROFILING_ENABLED
+#ifdef _DEBUG
+#define PROFILING_ENABLED 1
+#else
+#define PROFILING_ENABLED 0
+#endif
+#endif
+
+// Power of two, the oldest events of a thread are overwritten once its ring is full
+#define PROFILER_EVENTS_PER_THREAD (1u << 15)
+
+struct ProfileEvent
+{
+    const char* Name;
+    uint64_t Begin;
+    uint64_t End;
+};
+
+// Written by its thread only, read when the capture is exported
+struct ProfileThreadBuffer
+{
+    std::array<ProfileEvent, PROFILER_EVENTS_PER_THREAD> Events;
+    std::atomic<uint64_t> Head = 0;
+    uint32_t ThreadIndex = 0;
+    std::string Name;
+};
+
+// Records CPU zones into one ring per thread without locks, a zone costs two timestamp reads and
+// a store into the ring of the calling thread. Names must outlive the capture, string literals
+// and __func__ are meant. WriteChromeTrace produces a JSON file for chrome://tracing or Perfetto,
+// it should be called once the profiled threads are idle
+class Profiler
+{
+public:
+    static void Init();
+    static void SetThreadName(const std::string& Name);
+    static bool WriteChromeTrace(const std::filesystem::path& Path);
+
+    static uint64_t GetTimestamp()
+    {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    static void Record(const char* Name, uint64_t Begin, uint64_t End)
+    {
+        ProfileThreadBuffer* Buffer = sm_ThreadBuffer ? sm_ThreadBuffer : RegisterThread();
+
+        uint64_t Head = Buffer->Head.load(std::memory_order_relaxed);
+        Buffer->Events[Head & (PROFILER_EVENTS_PER_THREAD - 1)] = {Name, Begin, End};
+        Buffer->Head.store(Head + 1, std::memory_order_release);
+    }
+
+private:
+    static ProfileThreadBuffer* RegisterThread();
+    static double GetTicksPerMicrosecond();
+
+    static inline thread_local ProfileThreadBuffer* sm_ThreadBuffer = nullptr;
+    static std::mutex sm_Mutex;
+    static std::vector<std::unique_ptr<ProfileThreadBuffer>> sm_ThreadBuffers;
+    static uint64_t sm_BaseTimestamp;
+    static std::chrono::steady_clock::time_point sm_BaseTime;
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* Name) : m_Name(Name), m_Begin(Profiler::GetTimestamp()) {}
+    ~ProfileScope() { Profiler::Record(m_Name, m_Begin, Profiler::GetTimestamp()); }
+
+private:
+    const char* m_Name;
+    uint64_t m_Begin;
+};
+
+#define PROFILE_CONCAT_INNER(A, B) A##B
+#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INNER(A, B)
+
+#if PROFILING_ENABLED
+#define PROFILE_SCOPE(Name) ProfileScope PROFILE_CONCAT(ProfileScope, __LINE__)(Name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD(Name) Profiler::SetThreadName(Name)
+#else
+#define PROFILE_SCOPE(Name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD(Name)
+#endif
@@ -0,0 +1,993 @@
+#include "RenderGraph.h"
+#include "VulkanUtility.h"
+
+#define WRITE_ACCESS_MASK                                                                       \
+    (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |                        \
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |           \
+        VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT)
+
+struct RenderGraphAccessInfo
+{
+    // Zero for shader accesses, the stage comes from the pass
+    VkPipelineStageFlags Stages;
+    VkAccessFlags Access;
+    VkImageLayout Layout;
+    VkImageUsageFlags ImageUsage;
+    VkBufferUsageFlags BufferUsage;
+};
+
+// Indexed by RenderGraphAccess
+static const RenderGraphAccessInfo AccessInfos[] = {
+    {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, 0},
+    {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 0},
+    {0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_IMAGE_USAGE_SAMPLED_BIT, VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT},
+    {0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT},
+    {0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL,
+        VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT},
+    {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT},
+    {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT},
+    {0, VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT},
+    {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT},
+    {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT},
+    {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT},
+};
+
+static bool IsAttachment(RenderGraphAccess Access)
+{
+    return Access == RenderGraphAccess::COLOR_ATTACHMENT ||
+           Access == RenderGraphAccess::DEPTH_ATTACHMENT;
+}
+
+static VkImageAspectFlags GetAspectMask(VkFormat Format)
+{
+    switch (Format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_S8_UINT:
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::WriteColor(
+    RenderGraphResource Image, VkAttachmentLoadOp LoadOp, VkClearColorValue Clear)
+{
+    VkClearValue ClearValue = {};
+    ClearValue.color = Clear;
+    m_Graph.AddAccess(
+        m_Pass, Image, RenderGraphAccess::COLOR_ATTACHMENT, 0, true, LoadOp, ClearValue);
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::WriteDepth(
+    RenderGraphResource Image, VkAttachmentLoadOp LoadOp, float ClearDepth)
+{
+    VkClearValue ClearValue = {};
+    ClearValue.depthStencil = {ClearDepth, 0};
+    m_Graph.AddAccess(
+        m_Pass, Image, RenderGraphAccess::DEPTH_ATTACHMENT, 0, true, LoadOp, ClearValue);
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::Read(
+    RenderGraphResource Resource, RenderGraphAccess Access, VkPipelineStageFlags Stages)
+{
+    DEBUG_ASSERT(!IsAttachment(Access), "Attachments are declared with WriteColor/WriteDepth");
+    DEBUG_ASSERT(Access != RenderGraphAccess::STORAGE_WRITE &&
+                     Access != RenderGraphAccess::TRANSFER_DST,
+        "Write access declared as a read");
+
+    m_Graph.AddAccess(m_Pass, Resource, Access, Stages, false, VK_ATTACHMENT_LOAD_OP_LOAD, {});
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::Write(
+    RenderGraphResource Resource, RenderGraphAccess Access, VkPipelineStageFlags Stages)
+{
+    DEBUG_ASSERT(Access == RenderGraphAccess::STORAGE_WRITE ||
+                     Access == RenderGraphAccess::TRANSFER_DST,
+        "Only storage and transfer writes are declared with Write");
+
+    m_Graph.AddAccess(
+        m_Pass, Resource, Access, Stages, true, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {});
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::SetSideEffects()
+{
+    m_Graph.m_Passes[m_Pass].SideEffects = true;
+    return *this;
+}
+
+RenderGraph::RenderGraph() : m_Device(VK_NULL_HANDLE), m_Allocator(nullptr), m_Compiled(false) {}
+
+void RenderGraph::Init(VkDevice Device, VulkanMemoryAllocator& Allocator)
+{
+    m_Device = Device;
+    m_Allocator = &Allocator;
+}
+
+void RenderGraph::Destroy()
+{
+    Reset();
+
+    m_Allocator = nullptr;
+    m_Device = VK_NULL_HANDLE;
+}
+
+void RenderGraph::Reset()
+{
+    DestroyCompiled();
+
+    m_Passes.clear();
+    m_Resources.clear();
+}
+
+RenderGraphResource RenderGraph::CreateImage(
+    const std::string& Name, const RenderGraphImageDesc& Desc)
+{
+    Resource NewResource;
+    NewResource.Name = Name;
+    NewResource.IsImage = true;
+    NewResource.ImageDesc = Desc;
+    return AddResource(std::move(NewResource));
+}
+
+RenderGraphResource RenderGraph::CreateBuffer(const std::string& Name, VkDeviceSize Size)
+{
+    Resource NewResource;
+    NewResource.Name = Name;
+    NewResource.BufferSize = Size;
+    return AddResource(std::move(NewResource));
+}
+
+RenderGraphResource RenderGraph::ImportImage(const std::string& Name,
+    const RenderGraphImageDesc& Desc, VkImageLayout InitialLayout, VkImageLayout FinalLayout,
+    VkPipelineStageFlags InitialStages, VkAccessFlags InitialAccess)
+{
+    Resource NewResource;
+    NewResource.Name = Name;
+    NewResource.IsImage = true;
+    NewResource.Imported = true;
+    NewResource.ImageDesc = Desc;
+    NewResource.InitialLayout = InitialLayout;
+    NewResource.FinalLayout = FinalLayout;
+    NewResource.InitialStages = InitialStages;
+    NewResource.InitialAccess = InitialAccess;
+    return AddResource(std::move(NewResource));
+}
+
+RenderGraphResource RenderGraph::ImportBuffer(const std::string& Name, VkDeviceSize Size,
+    VkPipelineStageFlags InitialStages, VkAccessFlags InitialAccess)
+{
+    Resource NewResource;
+    NewResource.Name = Name;
+    NewResource.Imported = true;
+    NewResource.BufferSize = Size;
+    NewResource.InitialStages = InitialStages;
+    NewResource.InitialAccess = InitialAccess;
+    return AddResource(std::move(NewResource));
+}
+
+void RenderGraph::SetImportedImage(RenderGraphResource Resource, VkImage Image, VkImageView View)
+{
+    DEBUG_ASSERT(m_Resources[Resource].Imported && m_Resources[Resource].IsImage);
+
+    m_Resources[Resource].Image = Image;
+    m_Resources[Resource].View = View;
+}
+
+void RenderGraph::SetImportedBuffer(RenderGraphResource Resource, VkBuffer Buffer)
+{
+    DEBUG_ASSERT(m_Resources[Resource].Imported && !m_Resources[Resource].IsImage);
+
+    m_Resources[Resource].Buffer = Buffer;
+}
+
+RenderGraphPassBuilder RenderGraph::AddPass(
+    const std::string& Name, const RenderGraphExecuteFunction& Execute)
+{
+    DEBUG_ASSERT(!m_Compiled, "Passes must be added before the graph is compiled");
+
+    Pass NewPass;
+    NewPass.Name = Name;
+    NewPass.Execute = Execute;
+    m_Passes.push_back(std::move(NewPass));
+
+    return RenderGraphPassBuilder(*this, static_cast<uint32_t>(m_Passes.size() - 1));
+}
+
+void RenderGraph::Compile()
+{
+    DEBUG_ASSERT(m_Device);
+    DEBUG_ASSERT(!m_Compiled, "Render graph already compiled");
+
+    for (auto& Target : m_Passes)
+    {
+        for (auto& PassAccess : Target.Accesses)
+        {
+            if (PassAccess.Stages == 0)
+            {
+                PassAccess.Stages = Target.Attachments.empty()
+                                        ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                                        : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            }
+        }
+    }
+
+    CullPasses();
+    ComputeLifetimes();
+    CreateResources();
+    AliasMemory();
+    CreateViews();
+    ComputeBarriers();
+    CreateRenderPasses();
+
+    m_Compiled = true;
+}
+
+void RenderGraph::Execute(VkCommandBuffer CommandBuffer, VulkanGpuProfiler* Profiler)
+{
+    DEBUG_ASSERT(m_Compiled, "Render graph must be compiled before it is executed");
+
+    for (auto& Target : m_Passes)
+    {
+        if (!Target.Live)
+        {
+            continue;
+        }
+
+        uint32_t Scope = Profiler ? Profiler->BeginScope(CommandBuffer, Target.Name)
+                                  : GPU_PROFILER_INVALID_SCOPE;
+
+        RecordBarriers(CommandBuffer, Target.Barriers);
+
+        RenderGraphContext Context = {CommandBuffer, this, Target.RenderPass, Target.Extent};
+
+        if (Target.RenderPass)
+        {
+            VkRenderPassBeginInfo BeginInfo = {};
+            BeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            BeginInfo.renderPass = Target.RenderPass;
+            BeginInfo.framebuffer = GetFrameBuffer(Target);
+            BeginInfo.renderArea.extent = Target.Extent;
+            BeginInfo.clearValueCount = static_cast<uint32_t>(Target.ClearValues.size());
+            BeginInfo.pClearValues = Target.ClearValues.data();
+            vkCmdBeginRenderPass(CommandBuffer, &BeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        }
+
+        if (Target.Execute)
+        {
+            Target.Execute(Context);
+        }
+
+        if (Target.RenderPass)
+        {
+            vkCmdEndRenderPass(CommandBuffer);
+        }
+
+        if (Profiler)
+        {
+            Profiler->EndScope(CommandBuffer, Scope);
+        }
+    }
+
+    RecordBarriers(CommandBuffer, m_FinalBarriers);
+}
+
+void RenderGraph::LogStatistics() const
+{
+    uint32_t NumLive = 0;
+    uint32_t NumBarriers = static_cast<uint32_t>(m_FinalBarriers.Barriers.size());
+    uint32_t NumBatches = m_FinalBarriers.Barriers.empty() ? 0 : 1;
+
+    for (auto& Target : m_Passes)
+    {
+        NumLive += Target.Live ? 1 : 0;
+        NumBarriers += static_cast<uint32_t>(Target.Barriers.Barriers.size());
+        NumBatches += Target.Barriers.Barriers.empty() ? 0 : 1;
+    }
+
+    uint32_t NumTransient = 0;
+    VkDeviceSize TransientSize = 0;
+    VkDeviceSize AliasedSize = 0;
+
+    for (auto& Target : m_Resources)
+    {
+        if (Target.MemoryBlock != UINT32_MAX)
+        {
+            NumTransient++;
+            TransientSize += Target.Requirements.size;
+        }
+    }
+
+    for (auto& Block : m_MemoryBlocks)
+    {
+        AliasedSize += Block.Requirements.size;
+    }
+
+    DEBUG_DISPLAY("Render graph: %u passes (%u culled), %u barriers in %u batches",
+        static_cast<uint32_t>(m_Passes.size()), static_cast<uint32_t>(m_Passes.size()) - NumLive,
+        NumBarriers, NumBatches);
+    DEBUG_DISPLAY("Render graph memory: %llu KB in %u blocks for %u transient resources (%llu KB "
+                  "without aliasing)",
+        AliasedSize / 1024, static_cast<uint32_t>(m_MemoryBlocks.size()), NumTransient,
+        TransientSize / 1024);
+}
+
+RenderGraphResource RenderGraph::AddResource(Resource&& NewResource)
+{
+    DEBUG_ASSERT(!m_Compiled, "Resources must be added before the graph is compiled");
+
+    m_Resources.push_back(std::move(NewResource));
+    return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+}
+
+void RenderGraph::AddAccess(uint32_t PassIndex, RenderGraphResource Resource,
+    RenderGraphAccess Type, VkPipelineStageFlags Stages, bool Writes, VkAttachmentLoadOp LoadOp,
+    VkClearValue Clear)
+{
+    DEBUG_ASSERT(!m_Compiled, "Passes must be declared before the graph is compiled");
+    DEBUG_ASSERT(Resource < m_Resources.size(), "Invalid render graph resource");
+
+    Pass& Target = m_Passes[PassIndex];
+    const RenderGraphAccessInfo& Info = AccessInfos[static_cast<uint32_t>(Type)];
+
+    // One access per resource and pass keeps every barrier in a batch independent
+    DEBUG_ASSERT(std::none_of(Target.Accesses.begin(), Target.Accesses.end(),
+                     [Resource](const Access& Other) { return Other.Resource == Resource; }),
+        "%s is used twice by pass %s", m_Resources[Resource].Name.c_str(), Target.Name.c_str());
+    DEBUG_ASSERT(m_Resources[Resource].IsImage ? Info.ImageUsage != 0 : Info.BufferUsage != 0,
+        "Invalid access to %s in pass %s", m_Resources[Resource].Name.c_str(),
+        Target.Name.c_str());
+
+    Access NewAccess = {};
+    NewAccess.Resource = Resource;
+    NewAccess.Type = Type;
+    NewAccess.Stages = Info.Stages ? Info.Stages : Stages;
+    NewAccess.AccessMask = Info.Access;
+    NewAccess.Layout = m_Resources[Resource].IsImage ? Info.Layout : VK_IMAGE_LAYOUT_UNDEFINED;
+    NewAccess.Writes = Writes;
+    NewAccess.ReadsPrevious =
+        !Writes || LoadOp == VK_ATTACHMENT_LOAD_OP_LOAD || Type == RenderGraphAccess::STORAGE_WRITE;
+    NewAccess.LoadOp = LoadOp;
+    NewAccess.Clear = Clear;
+    Target.Accesses.push_back(NewAccess);
+
+    if (IsAttachment(Type))
+    {
+        Target.Attachments.push_back(Resource);
+        Target.ClearValues.push_back(Clear);
+    }
+}
+
+void RenderGraph::CullPasses()
+{
+    // Walking backwards, a pass survives when it writes something a surviving later pass reads,
+    // or an imported resource. Overwriting without reading ends the need for earlier contents
+    std::vector<bool> Needed(m_Resources.size());
+    for (size_t Index = 0; Index < m_Resources.size(); ++Index)
+    {
+        Needed[Index] = m_Resources[Index].Imported;
+    }
+
+    for (size_t PassIndex = m_Passes.size(); PassIndex-- > 0;)
+    {
+        Pass& Target = m_Passes[PassIndex];
+
+        Target.Live = Target.SideEffects ||
+                      std::any_of(Target.Accesses.begin(), Target.Accesses.end(),
+                          [&Needed](const Access& PassAccess)
+                          { return PassAccess.Writes && Needed[PassAccess.Resource]; });
+
+        if (!Target.Live)
+        {
+            DEBUG_INFO("Render graph: culled pass %s", Target.Name.c_str());
+            continue;
+        }
+
+        for (auto& PassAccess : Target.Accesses)
+        {
+            if (PassAccess.Writes && !PassAccess.ReadsPrevious)
+            {
+                Needed[PassAccess.Resource] = false;
+            }
+        }
+
+        for (auto& PassAccess : Target.Accesses)
+        {
+            if (PassAccess.ReadsPrevious)
+            {
+                Needed[PassAccess.Resource] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::ComputeLifetimes()
+{
+    for (uint32_t PassIndex = 0; PassIndex < m_Passes.size(); ++PassIndex)
+    {
+        if (!m_Passes[PassIndex].Live)
+        {
+            continue;
+        }
+
+        for (auto& PassAccess : m_Passes[PassIndex].Accesses)
+        {
+            Resource& Target = m_Resources[PassAccess.Resource];
+            const RenderGraphAccessInfo& Info = AccessInfos[static_cast<uint32_t>(PassAccess.Type)];
+
+            Target.FirstPass = std::min(Target.FirstPass, PassIndex);
+            Target.LastPass = PassIndex;
+            Target.LastStages = PassAccess.Stages;
+            Target.LastWriteAccess =
+                PassAccess.Writes ? PassAccess.AccessMask & WRITE_ACCESS_MASK : 0;
+            Target.ImageUsage |= Info.ImageUsage;
+            Target.BufferUsage |= Info.BufferUsage;
+        }
+    }
+}
+
+void RenderGraph::CreateResources()
+{
+    for (auto& Target : m_Resources)
+    {
+        if (Target.Imported || Target.FirstPass == UINT32_MAX)
+        {
+            continue;
+        }
+
+        if (Target.IsImage)
+        {
+            VkImageCreateInfo ImageInfo = {};
+            ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            ImageInfo.imageType = VK_IMAGE_TYPE_2D;
+            ImageInfo.format = Target.ImageDesc.Format;
+            ImageInfo.extent = {Target.ImageDesc.Width, Target.ImageDesc.Height, 1};
+            ImageInfo.mipLevels = 1;
+            ImageInfo.arrayLayers = 1;
+            ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            ImageInfo.usage = Target.ImageUsage;
+            ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            VULKAN_RESULT(vkCreateImage(m_Device, &ImageInfo, nullptr, &Target.Image));
+            vkGetImageMemoryRequirements(m_Device, Target.Image, &Target.Requirements);
+        }
+        else
+        {
+            VkBufferCreateInfo BufferInfo = {};
+            BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            BufferInfo.size = Target.BufferSize;
+            BufferInfo.usage = Target.BufferUsage;
+            BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            VULKAN_RESULT(vkCreateBuffer(m_Device, &BufferInfo, nullptr, &Target.Buffer));
+            vkGetBufferMemoryRequirements(m_Device, Target.Buffer, &Target.Requirements);
+        }
+    }
+}
+
+void RenderGraph::AliasMemory()
+{
+    std::vector<RenderGraphResource> Order;
+    for (RenderGraphResource Index = 0; Index < m_Resources.size(); ++Index)
+    {
+        if (!m_Resources[Index].Imported && m_Resources[Index].FirstPass != UINT32_MAX)
+        {
+            Order.push_back(Index);
+        }
+    }
+
+    // Largest first, smaller resources then fill the gaps left between them
+    std::stable_sort(Order.begin(), Order.end(),
+        [this](RenderGraphResource A, RenderGraphResource B)
+        { return m_Resources[A].Requirements.size > m_Resources[B].Requirements.size; });
+
+    for (RenderGraphResource Index : Order)
+    {
+        Resource& Target = m_Resources[Index];
+        const VkMemoryRequirements& Requirements = Target.Requirements;
+
+        for (uint32_t BlockIndex = 0; BlockIndex < m_MemoryBlocks.size(); ++BlockIndex)
+        {
+            MemoryBlock& Block = m_MemoryBlocks[BlockIndex];
+
+            // Buffers and optimal images are kept apart to stay clear of bufferImageGranularity
+            if (Block.Images != Target.IsImage ||
+                (Block.Requirements.memoryTypeBits & Requirements.memoryTypeBits) == 0)
+            {
+                continue;
+            }
+
+            // First fit between the ranges of resources alive at the same time
+            std::vector<std::pair<VkDeviceSize, VkDeviceSize>> Occupied;
+            for (RenderGraphResource OtherIndex : Block.Resources)
+            {
+                const Resource& Other = m_Resources[OtherIndex];
+                if (Other.FirstPass <= Target.LastPass && Target.FirstPass <= Other.LastPass)
+                {
+                    Occupied.push_back(
+                        {Other.MemoryOffset, Other.MemoryOffset + Other.Requirements.size});
+                }
+            }
+            std::sort(Occupied.begin(), Occupied.end());
+
+            VkDeviceSize Offset = 0;
+            for (auto& [Begin, End] : Occupied)
+            {
+                if (VulkanUtility::AlignUp(Offset, Requirements.alignment) + Requirements.size <=
+                    Begin)
+                {
+                    break;
+                }
+                Offset = std::max(Offset, End);
+            }
+            Offset = VulkanUtility::AlignUp(Offset, Requirements.alignment);
+
+            if (Offset + Requirements.size <= Block.Requirements.size)
+            {
+                Target.MemoryBlock = BlockIndex;
+                Target.MemoryOffset = Offset;
+                break;
+            }
+        }
+
+        if (Target.MemoryBlock == UINT32_MAX)
+        {
+            MemoryBlock Block = {};
+            Block.Images = Target.IsImage;
+            Block.Requirements = Requirements;
+            m_MemoryBlocks.push_back(std::move(Block));
+
+            Target.MemoryBlock = static_cast<uint32_t>(m_MemoryBlocks.size() - 1);
+            Target.MemoryOffset = 0;
+        }
+
+        MemoryBlock& Block = m_MemoryBlocks[Target.MemoryBlock];
+        Block.Requirements.memoryTypeBits &= Requirements.memoryTypeBits;
+        Block.Requirements.alignment =
+            std::max(Block.Requirements.alignment, Requirements.alignment);
+        Block.Resources.push_back(Index);
+    }
+
+    for (auto& Block : m_MemoryBlocks)
+    {
+        Block.Allocation = m_Allocator->Allocate(
+            Block.Requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, Block.Images);
+        CHECK(Block.Allocation.IsValid(), "Failed to allocate render graph memory");
+
+        for (RenderGraphResource Index : Block.Resources)
+        {
+            Resource& Target = m_Resources[Index];
+            VkDeviceSize Offset = Block.Allocation.Offset + Target.MemoryOffset;
+
+            if (Target.IsImage)
+            {
+                VULKAN_RESULT(
+                    vkBindImageMemory(m_Device, Target.Image, Block.Allocation.Memory, Offset));
+            }
+            else
+            {
+                VULKAN_RESULT(
+                    vkBindBufferMemory(m_Device, Target.Buffer, Block.Allocation.Memory, Offset));
+            }
+        }
+    }
+}
+
+void RenderGraph::CreateViews()
+{
+    for (auto& Target : m_Resources)
+    {
+        if (!Target.IsImage || Target.Imported || !Target.Image)
+        {
+            continue;
+        }
+
+        VkImageViewCreateInfo ViewInfo = {};
+        ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        ViewInfo.format = Target.ImageDesc.Format;
+        ViewInfo.image = Target.Image;
+        ViewInfo.subresourceRange = {GetAspectMask(Target.ImageDesc.Format), 0, 1, 0, 1};
+
+        VULKAN_RESULT(vkCreateImageView(m_Device, &ViewInfo, nullptr, &Target.View));
+    }
+}
+
+void RenderGraph::ComputeBarriers()
+{
+    struct ResourceState
+    {
+        VkImageLayout Layout;
+        VkPipelineStageFlags WriteStages;
+        VkAccessFlags WriteAccess;
+        VkPipelineStageFlags ReadStages;
+        // Stages and accesses the last write has already been made visible to
+        VkPipelineStageFlags VisibleStages;
+        VkAccessFlags VisibleAccess;
+    };
+
+    std::vector<ResourceState> States(m_Resources.size());
+
+    for (RenderGraphResource Index = 0; Index < m_Resources.size(); ++Index)
+    {
+        const Resource& Target = m_Resources[Index];
+        ResourceState& State = States[Index];
+        State = {};
+
+        if (Target.Imported)
+        {
+            State.Layout = Target.IsImage ? Target.InitialLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+            State.WriteStages = Target.InitialStages;
+            State.WriteAccess = Target.InitialAccess;
+            continue;
+        }
+
+        if (Target.MemoryBlock == UINT32_MAX)
+        {
+            continue;
+        }
+
+        // Contents are discarded on first use, but the memory may still be in use by whichever
+        // resource last touched the same range, earlier in this frame or in the previous one
+        for (RenderGraphResource OtherIndex : m_MemoryBlocks[Target.MemoryBlock].Resources)
+        {
+            const Resource& Other = m_Resources[OtherIndex];
+            if (Other.MemoryOffset < Target.MemoryOffset + Target.Requirements.size &&
+                Target.MemoryOffset < Other.MemoryOffset + Other.Requirements.size)
+            {
+                State.WriteStages |= Other.LastStages;
+                State.WriteAccess |= Other.LastWriteAccess;
+            }
+        }
+    }
+
+    for (auto& Target : m_Passes)
+    {
+        if (!Target.Live)
+        {
+            continue;
+        }
+
+        BarrierBatch& Batch = Target.Barriers;
+
+        for (auto& PassAccess : Target.Accesses)
+        {
+            ResourceState& State = States[PassAccess.Resource];
+            bool Transition =
+                m_Resources[PassAccess.Resource].IsImage && State.Layout != PassAccess.Layout;
+
+            if (PassAccess.Writes || Transition)
+            {
+                // Writes and layout transitions wait for every earlier read and write
+                VkPipelineStageFlags SourceStages = State.WriteStages | State.ReadStages;
+
+                if (SourceStages || Transition)
+                {
+                    Batch.Barriers.push_back({PassAccess.Resource, State.WriteAccess,
+                        PassAccess.AccessMask, State.Layout, PassAccess.Layout});
+                    Batch.SourceStages |= SourceStages;
+                    Batch.DestinationStages |= PassAccess.Stages;
+                }
+
+                State.Layout = PassAccess.Layout;
+                State.WriteStages = PassAccess.Stages;
+                State.ReadStages = 0;
+
+                if (PassAccess.Writes)
+                {
+                    State.WriteAccess = PassAccess.AccessMask & WRITE_ACCESS_MASK;
+                    State.VisibleStages = 0;
+                    State.VisibleAccess = 0;
+                }
+                else
+                {
+                    State.WriteAccess = 0;
+                    State.VisibleStages = PassAccess.Stages;
+                    State.VisibleAccess = PassAccess.AccessMask;
+                }
+            }
+            else
+            {
+                // Reads only wait when the last write is not yet visible to this stage
+                bool Visible = (PassAccess.Stages & ~State.VisibleStages) == 0 &&
+                               (PassAccess.AccessMask & ~State.VisibleAccess) == 0;
+
+                if (State.WriteStages && !Visible)
+                {
+                    Batch.Barriers.push_back({PassAccess.Resource, State.WriteAccess,
+                        PassAccess.AccessMask, State.Layout, State.Layout});
+                    Batch.SourceStages |= State.WriteStages;
+                    Batch.DestinationStages |= PassAccess.Stages;
+                    State.VisibleStages |= PassAccess.Stages;
+                    State.VisibleAccess |= PassAccess.AccessMask;
+                }
+
+                State.ReadStages |= PassAccess.Stages;
+            }
+        }
+    }
+
+    for (RenderGraphResource Index = 0; Index < m_Resources.size(); ++Index)
+    {
+        const Resource& Target = m_Resources[Index];
+        const ResourceState& State = States[Index];
+
+        if (Target.Imported && Target.IsImage && Target.FinalLayout != VK_IMAGE_LAYOUT_UNDEFINED &&
+            State.Layout != Target.FinalLayout)
+        {
+            m_FinalBarriers.Barriers.push_back(
+                {Index, State.WriteAccess, 0, State.Layout, Target.FinalLayout});
+            m_FinalBarriers.SourceStages |= State.WriteStages | State.ReadStages;
+            m_FinalBarriers.DestinationStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        }
+    }
+}
+
+void RenderGraph::CreateRenderPasses()
+{
+    for (uint32_t PassIndex = 0; PassIndex < m_Passes.size(); ++PassIndex)
+    {
+        Pass& Target = m_Passes[PassIndex];
+
+        if (!Target.Live || Target.Attachments.empty())
+        {
+            continue;
+        }
+
+        std::vector<VkAttachmentDescription> Attachments;
+        std::vector<VkAttachmentReference> ColorReferences;
+        VkAttachmentReference DepthReference = {};
+        bool HasDepth = false;
+
+        const RenderGraphImageDesc& FirstDesc = m_Resources[Target.Attachments[0]].ImageDesc;
+        Target.Extent = {FirstDesc.Width, FirstDesc.Height};
+
+        for (auto& PassAccess : Target.Accesses)
+        {
+            if (!IsAttachment(PassAccess.Type))
+            {
+                continue;
+            }
+
+            const Resource& Attachment = m_Resources[PassAccess.Resource];
+            DEBUG_ASSERT(Attachment.ImageDesc.Width == Target.Extent.width &&
+                             Attachment.ImageDesc.Height == Target.Extent.height,
+                "Attachment %s does not match the extent of pass %s", Attachment.Name.c_str(),
+                Target.Name.c_str());
+
+            // Nothing reads a transient attachment after its last pass, tilers can skip the store
+            bool Store = Attachment.Imported || Attachment.LastPass > PassIndex;
+
+            // The graph transitions attachments outside of the render pass
+            VkAttachmentDescription Description = {};
+            Description.format = Attachment.ImageDesc.Format;
+            Description.samples = VK_SAMPLE_COUNT_1_BIT;
+            Description.loadOp = PassAccess.LoadOp;
+            Description.storeOp = Store ? VK_ATTACHMENT_STORE_OP_STORE
+                                        : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            Description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            Description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            Description.initialLayout = PassAccess.Layout;
+            Description.finalLayout = PassAccess.Layout;
+
+            if (GetAspectMask(Attachment.ImageDesc.Format) & VK_IMAGE_ASPECT_STENCIL_BIT)
+            {
+                Description.stencilLoadOp = Description.loadOp;
+                Description.stencilStoreOp = Description.storeOp;
+            }
+
+            VkAttachmentReference Reference = {
+                static_cast<uint32_t>(Attachments.size()), PassAccess.Layout};
+            Attachments.push_back(Description);
+
+            if (PassAccess.Type == RenderGraphAccess::DEPTH_ATTACHMENT)
+            {
+                DEBUG_ASSERT(!HasDepth, "Pass %s has more than one depth attachment",
+                    Target.Name.c_str());
+                DepthReference = Reference;
+                HasDepth = true;
+            }
+            else
+            {
+                ColorReferences.push_back(Reference);
+            }
+        }
+
+        VkSubpassDescription Subpass = {};
+        Subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        Subpass.colorAttachmentCount = static_cast<uint32_t>(ColorReferences.size());
+        Subpass.pColorAttachments = ColorReferences.data();
+        Subpass.pDepthStencilAttachment = HasDepth ? &DepthReference : nullptr;
+
+        VkRenderPassCreateInfo RenderPassInfo = {};
+        RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        RenderPassInfo.attachmentCount = static_cast<uint32_t>(Attachments.size());
+        RenderPassInfo.pAttachments = Attachments.data();
+        RenderPassInfo.subpassCount = 1;
+        RenderPassInfo.pSubpasses = &Subpass;
+
+        VULKAN_RESULT(vkCreateRenderPass(m_Device, &RenderPassInfo, nullptr, &Target.RenderPass));
+    }
+}
+
+void RenderGraph::DestroyCompiled()
+{
+    for (auto& Target : m_Passes)
+    {
+        for (auto& [Key, FrameBuffer] : Target.FrameBuffers)
+        {
+            vkDestroyFramebuffer(m_Device, FrameBuffer, nullptr);
+        }
+
+        if (Target.RenderPass)
+        {
+            vkDestroyRenderPass(m_Device, Target.RenderPass, nullptr);
+        }
+
+        Target.FrameBuffers.clear();
+        Target.RenderPass = VK_NULL_HANDLE;
+        Target.Barriers = {};
+        Target.Live = false;
+    }
+
+    for (auto& Target : m_Resources)
+    {
+        if (!Target.Imported)
+        {
+            if (Target.View)
+            {
+                vkDestroyImageView(m_Device, Target.View, nullptr);
+            }
+
+            if (Target.Image)
+            {
+                vkDestroyImage(m_Device, Target.Image, nullptr);
+            }
+
+            if (Target.Buffer)
+            {
+                vkDestroyBuffer(m_Device, Target.Buffer, nullptr);
+            }
+
+            Target.View = VK_NULL_HANDLE;
+            Target.Image = VK_NULL_HANDLE;
+            Target.Buffer = VK_NULL_HANDLE;
+        }
+
+        Target.ImageUsage = 0;
+        Target.BufferUsage = 0;
+        Target.FirstPass = UINT32_MAX;
+        Target.LastPass = 0;
+        Target.LastStages = 0;
+        Target.LastWriteAccess = 0;
+        Target.MemoryBlock = UINT32_MAX;
+        Target.MemoryOffset = 0;
+    }
+
+    for (auto& Block : m_MemoryBlocks)
+    {
+        m_Allocator->Free(Block.Allocation);
+    }
+
+    m_MemoryBlocks.clear();
+    m_FinalBarriers = {};
+    m_Compiled = false;
+}
+
+VkFramebuffer RenderGraph::GetFrameBuffer(Pass& Target)
+{
+    // Imported attachments change from frame to frame, one frame buffer per combination of views
+    std::vector<VkImageView> Views;
+    for (RenderGraphResource Attachment : Target.Attachments)
+    {
+        DEBUG_ASSERT(m_Resources[Attachment].View, "No image bound to %s",
+            m_Resources[Attachment].Name.c_str());
+        Views.push_back(m_Resources[Attachment].View);
+    }
+
+    uint64_t Key = Utility::Hash(Views.data(), Views.size() * sizeof(VkImageView));
+
+    auto Found = Target.FrameBuffers.find(Key);
+    if (Found != Target.FrameBuffers.end())
+    {
+        return Found->second;
+    }
+
+    VkFramebufferCreateInfo FrameBufferInfo = {};
+    FrameBufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    FrameBufferInfo.renderPass = Target.RenderPass;
+    FrameBufferInfo.attachmentCount = static_cast<uint32_t>(Views.size());
+    FrameBufferInfo.pAttachments = Views.data();
+    FrameBufferInfo.width = Target.Extent.width;
+    FrameBufferInfo.height = Target.Extent.height;
+    FrameBufferInfo.layers = 1;
+
+    VkFramebuffer FrameBuffer = VK_NULL_HANDLE;
+    VULKAN_RESULT(vkCreateFramebuffer(m_Device, &FrameBufferInfo, nullptr, &FrameBuffer));
+
+    Target.FrameBuffers[Key] = FrameBuffer;
+    return FrameBuffer;
+}
+
+void RenderGraph::RecordBarriers(VkCommandBuffer CommandBuffer, const BarrierBatch& Batch) const
+{
+    if (Batch.Barriers.empty())
+    {
+        return;
+    }
+
+    std::vector<VkImageMemoryBarrier> ImageBarriers;
+    std::vector<VkBufferMemoryBarrier> BufferBarriers;
+
+    for (auto& PassBarrier : Batch.Barriers)
+    {
+        const Resource& Target = m_Resources[PassBarrier.Resource];
+
+        if (Target.IsImage)
+        {
+            DEBUG_ASSERT(Target.Image, "No image bound to %s", Target.Name.c_str());
+
+            VkImageMemoryBarrier ImageBarrier = {};
+            ImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            ImageBarrier.srcAccessMask = PassBarrier.SourceAccess;
+            ImageBarrier.dstAccessMask = PassBarrier.DestinationAccess;
+            ImageBarrier.oldLayout = PassBarrier.OldLayout;
+            ImageBarrier.newLayout = PassBarrier.NewLayout;
+            ImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            ImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            ImageBarrier.image = Target.Image;
+            ImageBarrier.subresourceRange = {GetAspectMask(Target.ImageDesc.Format), 0,
+                VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+            ImageBarriers.push_back(ImageBarrier);
+        }
+        else
+        {
+            DEBUG_ASSERT(Target.Buffer, "No buffer bound to %s", Target.Name.c_str());
+
+            VkBufferMemoryBarrier BufferBarrier = {};
+            BufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            BufferBarrier.srcAccessMask = PassBarrier.SourceAccess;
+            BufferBarrier.dstAccessMask = PassBarrier.DestinationAccess;
+            BufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            BufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            BufferBarrier.buffer = Target.Buffer;
+            BufferBarrier.size = VK_WHOLE_SIZE;
+            BufferBarriers.push_back(BufferBarrier);
+        }
+    }
+
+    VkPipelineStageFlags SourceStages =
+        Batch.SourceStages ? Batch.SourceStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+    vkCmdPipelineBarrier(CommandBuffer, SourceStages, Batch.DestinationStages, 0, 0, nullptr,
+        static_cast<uint32_t>(BufferBarriers.size()), BufferBarriers.data(),
+        static_cast<uint32_t>(ImageBarriers.size()), ImageBarriers.data());
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include "VulkanGpuProfiler.h"
+#include "VulkanMemoryAllocator.h"
+#include "pch.h"
+
+#define RENDER_GRAPH_INVALID_RESOURCE UINT32_MAX
+
+using RenderGraphResource = uint32_t;
+
+enum class RenderGraphAccess
+{
+    COLOR_ATTACHMENT = 0,
+    DEPTH_ATTACHMENT,
+    SAMPLED,
+    STORAGE_READ,
+    STORAGE_WRITE,
+    TRANSFER_SRC,
+    TRANSFER_DST,
+    UNIFORM,
+    VERTEX,
+    INDEX,
+    INDIRECT,
+};
+
+struct RenderGraphImageDesc
+{
+    uint32_t Width;
+    uint32_t Height;
+    VkFormat Format;
+};
+
+class RenderGraph;
+
+struct RenderGraphContext
+{
+    VkCommandBuffer CommandBuffer;
+    const RenderGraph* Graph;
+    // Only set for passes with attachments, the render pass is already begun
+    VkRenderPass RenderPass;
+    VkExtent2D Extent;
+};
+
+using RenderGraphExecuteFunction = std::function<void(const RenderGraphContext& Context)>;
+
+class RenderGraphPassBuilder
+{
+public:
+    RenderGraphPassBuilder(RenderGraph& Graph, uint32_t Pass) : m_Graph(Graph), m_Pass(Pass) {}
+
+    RenderGraphPassBuilder& WriteColor(RenderGraphResource Image,
+        VkAttachmentLoadOp LoadOp = VK_ATTACHMENT_LOAD_OP_LOAD, VkClearColorValue Clear = {});
+    RenderGraphPassBuilder& WriteDepth(RenderGraphResource Image,
+        VkAttachmentLoadOp LoadOp = VK_ATTACHMENT_LOAD_OP_LOAD, float ClearDepth = 1.0f);
+    // Shader accesses default to the fragment stage in passes with attachments, compute otherwise
+    RenderGraphPassBuilder& Read(
+        RenderGraphResource Resource, RenderGraphAccess Access, VkPipelineStageFlags Stages = 0);
+    RenderGraphPassBuilder& Write(
+        RenderGraphResource Resource, RenderGraphAccess Access, VkPipelineStageFlags Stages = 0);
+    // Keeps the pass even when nothing reads what it writes
+    RenderGraphPassBuilder& SetSideEffects();
+
+    uint32_t GetPass() const { return m_Pass; }
+
+private:
+    RenderGraph& m_Graph;
+    uint32_t m_Pass;
+};
+
+// Passes are declared with the resources they read and write, in submission order. Compile culls
+// the passes whose results are never used, derives the barriers and layout transitions between
+// the remaining ones from the declared accesses, and places transient resources whose lifetimes do
+// not overlap in the same memory. Imported resources such as the back buffer are never culled and
+// may be rebound before every Execute. A transfer write is assumed to overwrite the whole resource
+class RenderGraph
+{
+public:
+    RenderGraph();
+    ~RenderGraph() = default;
+    void Init(VkDevice Device, VulkanMemoryAllocator& Allocator);
+    void Destroy();
+    // Drops every pass and resource so that the graph can be declared again
+    void Reset();
+
+    RenderGraphResource CreateImage(const std::string& Name, const RenderGraphImageDesc& Desc);
+    RenderGraphResource CreateBuffer(const std::string& Name, VkDeviceSize Size);
+    RenderGraphResource ImportImage(const std::string& Name, const RenderGraphImageDesc& Desc,
+        VkImageLayout InitialLayout, VkImageLayout FinalLayout,
+        VkPipelineStageFlags InitialStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VkAccessFlags InitialAccess = 0);
+    RenderGraphResource ImportBuffer(const std::string& Name, VkDeviceSize Size,
+        VkPipelineStageFlags InitialStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VkAccessFlags InitialAccess = 0);
+    void SetImportedImage(RenderGraphResource Resource, VkImage Image, VkImageView View);
+    void SetImportedBuffer(RenderGraphResource Resource, VkBuffer Buffer);
+
+    RenderGraphPassBuilder AddPass(
+        const std::string& Name, const RenderGraphExecuteFunction& Execute);
+
+    void Compile();
+    // Every live pass is timed as a GPU scope named after it when a profiler is given
+    void Execute(VkCommandBuffer CommandBuffer, VulkanGpuProfiler* Profiler = nullptr);
+
+    VkImage GetImage(RenderGraphResource Resource) const { return m_Resources[Resource].Image; }
+    VkImageView GetImageView(RenderGraphResource Resource) const
+    {
+        return m_Resources[Resource].View;
+    }
+    VkBuffer GetBuffer(RenderGraphResource Resource) const { return m_Resources[Resource].Buffer; }
+    VkRenderPass GetRenderPass(uint32_t Pass) const { return m_Passes[Pass].RenderPass; }
+    bool IsPassCulled(uint32_t Pass) const { return !m_Passes[Pass].Live; }
+    void LogStatistics() const;
+
+private:
+    friend class RenderGraphPassBuilder;
+
+    struct Access
+    {
+        RenderGraphResource Resource;
+        RenderGraphAccess Type;
+        VkPipelineStageFlags Stages;
+        VkAccessFlags AccessMask;
+        VkImageLayout Layout;
+        bool Writes;
+        // Whether the previous contents are used, a cleared attachment does not need its producer
+        bool ReadsPrevious;
+        VkAttachmentLoadOp LoadOp;
+        VkClearValue Clear;
+    };
+
+    struct Barrier
+    {
+        RenderGraphResource Resource;
+        VkAccessFlags SourceAccess;
+        VkAccessFlags DestinationAccess;
+        VkImageLayout OldLayout;
+        VkImageLayout NewLayout;
+    };
+
+    struct BarrierBatch
+    {
+        VkPipelineStageFlags SourceStages = 0;
+        VkPipelineStageFlags DestinationStages = 0;
+        std::vector<Barrier> Barriers;
+    };
+
+    struct Pass
+    {
+        std::string Name;
+        RenderGraphExecuteFunction Execute;
+        std::vector<Access> Accesses;
+        bool SideEffects = false;
+        bool Live = false;
+        BarrierBatch Barriers;
+        std::vector<RenderGraphResource> Attachments;
+        std::vector<VkClearValue> ClearValues;
+        VkExtent2D Extent = {};
+        VkRenderPass RenderPass = VK_NULL_HANDLE;
+        std::unordered_map<uint64_t, VkFramebuffer> FrameBuffers;
+    };
+
+    struct Resource
+    {
+        std::string Name;
+        bool IsImage = false;
+        bool Imported = false;
+        RenderGraphImageDesc ImageDesc = {};
+        VkDeviceSize BufferSize = 0;
+        VkImageLayout InitialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout FinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags InitialStages = 0;
+        VkAccessFlags InitialAccess = 0;
+
+        VkImage Image = VK_NULL_HANDLE;
+        VkImageView View = VK_NULL_HANDLE;
+        VkBuffer Buffer = VK_NULL_HANDLE;
+        VkImageUsageFlags ImageUsage = 0;
+        VkBufferUsageFlags BufferUsage = 0;
+        uint32_t FirstPass = UINT32_MAX;
+        uint32_t LastPass = 0;
+        VkPipelineStageFlags LastStages = 0;
+        VkAccessFlags LastWriteAccess = 0;
+        VkMemoryRequirements Requirements = {};
+        uint32_t MemoryBlock = UINT32_MAX;
+        VkDeviceSize MemoryOffset = 0;
+    };
+
+    struct MemoryBlock
+    {
+        bool Images;
+        VkMemoryRequirements Requirements;
+        std::vector<RenderGraphResource> Resources;
+        VulkanAllocation Allocation;
+    };
+
+    RenderGraphResource AddResource(Resource&& NewResource);
+    void AddAccess(uint32_t PassIndex, RenderGraphResource Resource, RenderGraphAccess Type,
+        VkPipelineStageFlags Stages, bool Writes, VkAttachmentLoadOp LoadOp, VkClearValue Clear);
+    void CullPasses();
+    void ComputeLifetimes();
+    void CreateResources();
+    void AliasMemory();
+    void CreateViews();
+    void ComputeBarriers();
+    void CreateRenderPasses();
+    void DestroyCompiled();
+    VkFramebuffer GetFrameBuffer(Pass& Target);
+    void RecordBarriers(VkCommandBuffer CommandBuffer, const BarrierBatch& Batch) const;
+
+    VkDevice m_Device;
+    VulkanMemoryAllocator* m_Allocator;
+    std::vector<Pass> m_Passes;
+    std::vector<Resource> m_Resources;
+    std::vector<MemoryBlock> m_MemoryBlocks;
+    BarrierBatch m_FinalBarriers;
+    bool m_Compiled;
+};
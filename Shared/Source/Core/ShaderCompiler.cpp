@@ -0,0 +1,506 @@
+#include "ShaderCompiler.h"
+
+#include <SPIRV/GlslangToSpv.h>
+#include <glslang/Public/ResourceLimits.h>
+#include <glslang/Public/ShaderLang.h>
+
+struct ShaderCacheHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t RequestKey;
+    uint64_t CompilerHash;
+    uint32_t NumDependencies;
+    uint32_t CodeSize;
+};
+
+inline EShLanguage GetLanguage(ShaderStage Stage)
+{
+    switch (Stage)
+    {
+    case ShaderStage::VERTEX:
+        return EShLangVertex;
+    case ShaderStage::TESSELLATION_CONTROL:
+        return EShLangTessControl;
+    case ShaderStage::TESSELLATION_EVALUATION:
+        return EShLangTessEvaluation;
+    case ShaderStage::GEOMETRY:
+        return EShLangGeometry;
+    case ShaderStage::FRAGMENT:
+        return EShLangFragment;
+    case ShaderStage::COMPUTE:
+        return EShLangCompute;
+    }
+
+    return EShLangVertex;
+}
+
+inline void GetTargetVersions(uint32_t ApiVersion, glslang::EShTargetClientVersion* OutClient,
+    glslang::EShTargetLanguageVersion* OutLanguage)
+{
+    if (ApiVersion >= VK_API_VERSION_1_3)
+    {
+        *OutClient = glslang::EShTargetVulkan_1_3;
+        *OutLanguage = glslang::EShTargetSpv_1_6;
+    }
+    else if (ApiVersion >= VK_API_VERSION_1_2)
+    {
+        *OutClient = glslang::EShTargetVulkan_1_2;
+        *OutLanguage = glslang::EShTargetSpv_1_5;
+    }
+    else if (ApiVersion >= VK_API_VERSION_1_1)
+    {
+        *OutClient = glslang::EShTargetVulkan_1_1;
+        *OutLanguage = glslang::EShTargetSpv_1_3;
+    }
+    else
+    {
+        *OutClient = glslang::EShTargetVulkan_1_0;
+        *OutLanguage = glslang::EShTargetSpv_1_0;
+    }
+}
+
+inline std::string GetPreamble(const std::vector<std::string>& Defines)
+{
+    std::string Preamble = "#extension GL_GOOGLE_include_directive : require\n";
+
+    for (auto& Define : Defines)
+    {
+        size_t Separator = Define.find('=');
+
+        if (Separator == std::string::npos)
+        {
+            Preamble += "#define " + Define + "\n";
+        }
+        else
+        {
+            Preamble += "#define " + Define.substr(0, Separator) + " " +
+                        Define.substr(Separator + 1) + "\n";
+        }
+    }
+
+    return Preamble;
+}
+
+// Resolves includes relative to the including file first, then through the include directories,
+// and records every file it opened so that the cache can tell when one of them changes
+class ShaderIncluder : public glslang::TShader::Includer
+{
+public:
+    ShaderIncluder(const std::vector<std::filesystem::path>& IncludeDirectories,
+        std::vector<ShaderDependency>& Dependencies)
+        : m_IncludeDirectories(IncludeDirectories), m_Dependencies(Dependencies)
+    {
+    }
+
+    IncludeResult* includeLocal(
+        const char* HeaderName, const char* IncluderName, size_t InclusionDepth) override
+    {
+        std::filesystem::path Directory = std::filesystem::path(IncluderName).parent_path();
+
+        if (IncludeResult* Result = TryInclude(Directory / HeaderName))
+        {
+            return Result;
+        }
+
+        return includeSystem(HeaderName, IncluderName, InclusionDepth);
+    }
+
+    IncludeResult* includeSystem(const char* HeaderName, const char*, size_t) override
+    {
+        for (auto& Directory : m_IncludeDirectories)
+        {
+            if (IncludeResult* Result = TryInclude(Directory / HeaderName))
+            {
+                return Result;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void releaseInclude(IncludeResult* Result) override
+    {
+        if (Result)
+        {
+            delete static_cast<MappedFile*>(Result->userData);
+            delete Result;
+        }
+    }
+
+private:
+    IncludeResult* TryInclude(const std::filesystem::path& Path)
+    {
+        // glslang reads the include in place until it releases the result
+        auto Content = std::make_unique<MappedFile>();
+
+        if (!Content->Open(Path, FileAccessHint::SEQUENTIAL))
+        {
+            return nullptr;
+        }
+
+        std::filesystem::path NormalPath = Path.lexically_normal();
+        m_Dependencies.push_back(
+            {NormalPath, Utility::Hash(Content->GetData(), Content->GetSize())});
+
+        std::string_view Text = Content->GetText();
+        return new IncludeResult(NormalPath.string(), Text.data(), Text.size(), Content.release());
+    }
+
+    const std::vector<std::filesystem::path>& m_IncludeDirectories;
+    std::vector<ShaderDependency>& m_Dependencies;
+};
+
+ShaderCompiler::ShaderCompiler()
+    : m_ApiVersion(0),
+      m_CompilerHash(0),
+      m_Initialized(false),
+      m_NumCompiled(0),
+      m_NumCacheHits(0),
+      m_NumFailed(0)
+{
+}
+
+void ShaderCompiler::Init(const std::filesystem::path& CacheDirectory,
+    const std::vector<std::filesystem::path>& IncludeDirectories, uint32_t ApiVersion)
+{
+    CHECK(glslang::InitializeProcess(), "Failed to initialize glslang");
+
+    m_CacheDirectory = CacheDirectory;
+    m_ApiVersion = ApiVersion;
+    m_Initialized = true;
+
+    // Dependencies are recorded with absolute paths so that file change events can be matched
+    m_IncludeDirectories.clear();
+    for (auto& Directory : IncludeDirectories)
+    {
+        m_IncludeDirectories.push_back(std::filesystem::absolute(Directory).lexically_normal());
+    }
+
+    std::error_code Error;
+    std::filesystem::create_directories(m_CacheDirectory, Error);
+
+    // A compiler update can change the output for identical inputs
+    glslang::Version Version = glslang::GetVersion();
+    std::string CompilerId = Utility::Format("glslang %d.%d.%d%s cache %d api %u", Version.major,
+        Version.minor, Version.patch, Version.flavor, SHADER_CACHE_VERSION, m_ApiVersion);
+    m_CompilerHash = Utility::Hash(CompilerId);
+
+    DEBUG_DISPLAY("Shader compiler: %s", CompilerId.c_str());
+    DEBUG_DISPLAY("Shader cache: %s", m_CacheDirectory.string().c_str());
+}
+
+void ShaderCompiler::Destroy()
+{
+    if (!m_Initialized)
+    {
+        return;
+    }
+
+    LogStatistics();
+
+    glslang::FinalizeProcess();
+    m_Initialized = false;
+}
+
+std::unique_ptr<ShaderBinary> ShaderCompiler::Compile(const ShaderDesc& Desc)
+{
+    PROFILE_FUNCTION();
+
+    DEBUG_ASSERT(m_Initialized);
+
+    uint64_t RequestKey = GetRequestKey(Desc);
+
+    auto Binary = std::make_unique<ShaderBinary>();
+    if (LoadCached(RequestKey, *Binary))
+    {
+        m_NumCacheHits++;
+        return Binary;
+    }
+
+    Binary = std::make_unique<ShaderBinary>();
+    if (!CompileSource(Desc, *Binary))
+    {
+        m_NumFailed++;
+        DEBUG_ERROR("Failed to compile %s\n%s", Desc.Path.string().c_str(), Binary->Log.c_str());
+        return Binary;
+    }
+
+    m_NumCompiled++;
+    StoreCached(RequestKey, *Binary);
+    return Binary;
+}
+
+std::vector<std::unique_ptr<ShaderBinary>> ShaderCompiler::CompileAll(
+    JobSystem& Jobs, const std::vector<ShaderDesc>& Descs)
+{
+    std::vector<std::unique_ptr<ShaderBinary>> Binaries(Descs.size());
+
+    JobCounter Counter;
+    Jobs.ParallelFor(
+        static_cast<uint32_t>(Descs.size()), 1,
+        [this, &Descs, &Binaries](uint32_t Begin, uint32_t End)
+        {
+            for (uint32_t Index = Begin; Index < End; ++Index)
+            {
+                Binaries[Index] = Compile(Descs[Index]);
+            }
+        },
+        &Counter);
+    Jobs.Wait(Counter);
+
+    return Binaries;
+}
+
+ShaderStage ShaderCompiler::GetStageFromExtension(const std::filesystem::path& Path)
+{
+    std::string Extension = Path.extension().string();
+
+    if (Extension == ".vert")
+    {
+        return ShaderStage::VERTEX;
+    }
+    if (Extension == ".tesc")
+    {
+        return ShaderStage::TESSELLATION_CONTROL;
+    }
+    if (Extension == ".tese")
+    {
+        return ShaderStage::TESSELLATION_EVALUATION;
+    }
+    if (Extension == ".geom")
+    {
+        return ShaderStage::GEOMETRY;
+    }
+    if (Extension == ".frag")
+    {
+        return ShaderStage::FRAGMENT;
+    }
+    if (Extension == ".comp")
+    {
+        return ShaderStage::COMPUTE;
+    }
+
+    CHECK(false, "Unknown shader extension: %s", Path.string().c_str());
+    return ShaderStage::VERTEX;
+}
+
+void ShaderCompiler::LogStatistics() const
+{
+    DEBUG_DISPLAY("Shaders: %u compiled, %u from cache, %u failed", m_NumCompiled.load(),
+        m_NumCacheHits.load(), m_NumFailed.load());
+}
+
+uint64_t ShaderCompiler::GetRequestKey(const ShaderDesc& Desc) const
+{
+    uint64_t Key = m_CompilerHash;
+    Key = Utility::Hash(std::filesystem::absolute(Desc.Path).lexically_normal().string(), Key);
+    Key = Utility::Hash(&Desc.Stage, sizeof(Desc.Stage), Key);
+    Key = Utility::Hash(Desc.EntryPoint, Key);
+
+    for (auto& Define : Desc.Defines)
+    {
+        Key = Utility::Hash(Define + "\n", Key);
+    }
+
+    return Key;
+}
+
+std::filesystem::path ShaderCompiler::GetCachePath(uint64_t RequestKey) const
+{
+    return m_CacheDirectory / Utility::Format("%016llx.spv", RequestKey);
+}
+
+bool ShaderCompiler::LoadCached(uint64_t RequestKey, ShaderBinary& Binary) const
+{
+    MappedFile File;
+    if (!File.Open(GetCachePath(RequestKey)))
+    {
+        return false;
+    }
+
+    const uint8_t* Data = File.GetData();
+    size_t Size = File.GetSize();
+
+    ShaderCacheHeader Header;
+    if (Size < sizeof(Header))
+    {
+        return false;
+    }
+
+    memcpy(&Header, Data, sizeof(Header));
+
+    if (Header.Magic != SHADER_CACHE_MAGIC || Header.Version != SHADER_CACHE_VERSION ||
+        Header.RequestKey != RequestKey || Header.CompilerHash != m_CompilerHash)
+    {
+        return false;
+    }
+
+    // Only the inputs are read back, anything that changed since the entry was written is a miss
+    size_t Offset = sizeof(Header);
+    for (uint32_t Index = 0; Index < Header.NumDependencies; ++Index)
+    {
+        uint64_t ContentHash;
+        uint32_t PathLength;
+
+        if (Offset + sizeof(ContentHash) + sizeof(PathLength) > Size)
+        {
+            return false;
+        }
+
+        memcpy(&ContentHash, Data + Offset, sizeof(ContentHash));
+        memcpy(&PathLength, Data + Offset + sizeof(ContentHash), sizeof(PathLength));
+        Offset += sizeof(ContentHash) + sizeof(PathLength);
+
+        if (Offset + PathLength > Size)
+        {
+            return false;
+        }
+
+        std::filesystem::path Path(
+            std::string(reinterpret_cast<const char*>(Data + Offset), PathLength));
+        Offset += PathLength;
+
+        MappedFile Content;
+        if (!Content.Open(Path, FileAccessHint::SEQUENTIAL) ||
+            Utility::Hash(Content.GetData(), Content.GetSize()) != ContentHash)
+        {
+            return false;
+        }
+
+        Binary.Dependencies.push_back({Path, ContentHash});
+    }
+
+    Offset = (Offset + 3) & ~size_t(3);
+
+    if (Header.CodeSize == 0 || Offset + Header.CodeSize != Size)
+    {
+        return false;
+    }
+
+    Binary.Code = reinterpret_cast<const uint32_t*>(Data + Offset);
+    Binary.CodeSize = Header.CodeSize;
+    Binary.FromCache = true;
+    Binary.CacheFile = std::move(File);
+    return true;
+}
+
+void ShaderCompiler::StoreCached(uint64_t RequestKey, const ShaderBinary& Binary) const
+{
+    ShaderCacheHeader Header;
+    Header.Magic = SHADER_CACHE_MAGIC;
+    Header.Version = SHADER_CACHE_VERSION;
+    Header.RequestKey = RequestKey;
+    Header.CompilerHash = m_CompilerHash;
+    Header.NumDependencies = static_cast<uint32_t>(Binary.Dependencies.size());
+    Header.CodeSize = static_cast<uint32_t>(Binary.CodeSize);
+
+    std::vector<uint8_t> Data(sizeof(Header));
+    memcpy(Data.data(), &Header, sizeof(Header));
+
+    for (auto& Dependency : Binary.Dependencies)
+    {
+        std::string Path = Dependency.Path.string();
+        uint32_t PathLength = static_cast<uint32_t>(Path.size());
+
+        const uint8_t* HashBytes = reinterpret_cast<const uint8_t*>(&Dependency.ContentHash);
+        const uint8_t* LengthBytes = reinterpret_cast<const uint8_t*>(&PathLength);
+        Data.insert(Data.end(), HashBytes, HashBytes + sizeof(Dependency.ContentHash));
+        Data.insert(Data.end(), LengthBytes, LengthBytes + sizeof(PathLength));
+        Data.insert(Data.end(), Path.begin(), Path.end());
+    }
+
+    // The SPIR-V is mapped straight from the file on load, so it has to stay word aligned
+    Data.resize((Data.size() + 3) & ~size_t(3));
+
+    const uint8_t* CodeBytes = reinterpret_cast<const uint8_t*>(Binary.Code);
+    Data.insert(Data.end(), CodeBytes, CodeBytes + Binary.CodeSize);
+
+    // Workers may store the same entry at once, each one writes its own temporary file
+    std::filesystem::path Path = GetCachePath(RequestKey);
+    std::filesystem::path TemporaryPath = Path;
+    TemporaryPath +=
+        Utility::Format(".%zx.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+        File.write(reinterpret_cast<const char*>(Data.data()), Data.size());
+
+        if (!File)
+        {
+            DEBUG_WARNING("Failed to write shader cache entry %s", TemporaryPath.string().c_str());
+            return;
+        }
+    }
+
+    std::error_code Error;
+    std::filesystem::rename(TemporaryPath, Path, Error);
+
+    if (Error)
+    {
+        std::filesystem::remove(TemporaryPath, Error);
+    }
+}
+
+bool ShaderCompiler::CompileSource(const ShaderDesc& Desc, ShaderBinary& Binary) const
+{
+    MappedFile SourceFile;
+    if (!SourceFile.Open(Desc.Path, FileAccessHint::SEQUENTIAL))
+    {
+        Binary.Log = "Failed to read " + Desc.Path.string();
+        return false;
+    }
+
+    std::filesystem::path SourcePath = std::filesystem::absolute(Desc.Path).lexically_normal();
+    std::string_view Source = SourceFile.GetText();
+    Binary.Dependencies.push_back({SourcePath, Utility::Hash(Source.data(), Source.size())});
+
+    EShLanguage Language = GetLanguage(Desc.Stage);
+
+    glslang::EShTargetClientVersion ClientVersion;
+    glslang::EShTargetLanguageVersion LanguageVersion;
+    GetTargetVersions(m_ApiVersion, &ClientVersion, &LanguageVersion);
+
+    std::string Name = SourcePath.string();
+    std::string Preamble = GetPreamble(Desc.Defines);
+    const char* Strings[] = {Source.data()};
+    const int Lengths[] = {static_cast<int>(Source.size())};
+    const char* Names[] = {Name.c_str()};
+
+    glslang::TShader Shader(Language);
+    Shader.setStringsWithLengthsAndNames(Strings, Lengths, Names, 1);
+    Shader.setPreamble(Preamble.c_str());
+    Shader.setEntryPoint(Desc.EntryPoint.c_str());
+    Shader.setSourceEntryPoint(Desc.EntryPoint.c_str());
+    Shader.setEnvInput(glslang::EShSourceGlsl, Language, glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, ClientVersion);
+    Shader.setEnvTarget(glslang::EShTargetSpv, LanguageVersion);
+
+    EShMessages Messages = static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules);
+    ShaderIncluder Includer(m_IncludeDirectories, Binary.Dependencies);
+
+    if (!Shader.parse(GetDefaultResources(), 450, false, Messages, Includer))
+    {
+        Binary.Log = std::string(Shader.getInfoLog()) + Shader.getInfoDebugLog();
+        return false;
+    }
+
+    // The program refers to the shader, so it is declared last and destroyed first
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(Messages))
+    {
+        Binary.Log = std::string(Program.getInfoLog()) + Program.getInfoDebugLog();
+        return false;
+    }
+
+    spv::SpvBuildLogger Logger;
+    glslang::SpvOptions Options;
+    glslang::GlslangToSpv(*Program.getIntermediate(Language), Binary.Words, &Logger, &Options);
+
+    Binary.Log = Logger.getAllMessages();
+    Binary.Code = Binary.Words.data();
+    Binary.CodeSize = Binary.Words.size() * sizeof(uint32_t);
+    return !Binary.Words.empty();
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include "pch.h"
+
+#define SHADER_CACHE_MAGIC 0x43565053  // "SPVC"
+#define SHADER_CACHE_VERSION 1
+
+enum class ShaderStage
+{
+    VERTEX = 0,
+    TESSELLATION_CONTROL,
+    TESSELLATION_EVALUATION,
+    GEOMETRY,
+    FRAGMENT,
+    COMPUTE,
+};
+
+struct ShaderDesc
+{
+    std::filesystem::path Path;
+    ShaderStage Stage;
+    std::string EntryPoint = "main";
+    // "NAME" or "NAME=VALUE"
+    std::vector<std::string> Defines;
+};
+
+struct ShaderDependency
+{
+    std::filesystem::path Path;
+    uint64_t ContentHash;
+};
+
+struct ShaderBinary
+{
+    const uint32_t* Code = nullptr;
+    size_t CodeSize = 0;
+    std::vector<ShaderDependency> Dependencies;
+    bool FromCache = false;
+    std::string Log;
+
+    bool IsValid() const { return Code != nullptr; }
+
+    // Either a view into the mapped cache file or the words produced by a compile
+    MappedFile CacheFile;
+    std::vector<uint32_t> Words;
+};
+
+// GLSL to SPIR-V through glslang. Results are cached on disk per source path, stage, entry point,
+// defines and compiler version, together with a content hash of the source and every file it
+// included. A warm start only rehashes those files and maps the stored SPIR-V
+class ShaderCompiler
+{
+public:
+    ShaderCompiler();
+    ~ShaderCompiler() = default;
+    void Init(const std::filesystem::path& CacheDirectory,
+        const std::vector<std::filesystem::path>& IncludeDirectories, uint32_t ApiVersion);
+    void Destroy();
+
+    // Safe to call from any thread
+    std::unique_ptr<ShaderBinary> Compile(const ShaderDesc& Desc);
+    std::vector<std::unique_ptr<ShaderBinary>> CompileAll(
+        JobSystem& Jobs, const std::vector<ShaderDesc>& Descs);
+
+    static ShaderStage GetStageFromExtension(const std::filesystem::path& Path);
+    const std::vector<std::filesystem::path>& GetIncludeDirectories() const
+    {
+        return m_IncludeDirectories;
+    }
+    void LogStatistics() const;
+
+private:
+    uint64_t GetRequestKey(const ShaderDesc& Desc) const;
+    std::filesystem::path GetCachePath(uint64_t RequestKey) const;
+    bool LoadCached(uint64_t RequestKey, ShaderBinary& Binary) const;
+    void StoreCached(uint64_t RequestKey, const ShaderBinary& Binary) const;
+    bool CompileSource(const ShaderDesc& Desc, ShaderBinary& Binary) const;
+
+    std::filesystem::path m_CacheDirectory;
+    std::vector<std::filesystem::path> m_IncludeDirectories;
+    uint32_t m_ApiVersion;
+    uint64_t m_CompilerHash;
+    bool m_Initialized;
+    std::atomic<uint32_t> m_NumCompiled;
+    std::atomic<uint32_t> m_NumCacheHits;
+    std::atomic<uint32_t> m_NumFailed;
+};
@@ -0,0 +1,296 @@
+#include "ShaderReloader.h"
+#include "VulkanUtility.h"
+
+static VkShaderStageFlagBits GetVulkanStage(ShaderStage Stage)
+{
+    switch (Stage)
+    {
+    case ShaderStage::VERTEX:
+        return VK_SHADER_STAGE_VERTEX_BIT;
+    case ShaderStage::TESSELLATION_CONTROL:
+        return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+    case ShaderStage::TESSELLATION_EVALUATION:
+        return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+    case ShaderStage::GEOMETRY:
+        return VK_SHADER_STAGE_GEOMETRY_BIT;
+    case ShaderStage::FRAGMENT:
+        return VK_SHADER_STAGE_FRAGMENT_BIT;
+    case ShaderStage::COMPUTE:
+        return VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    return VK_SHADER_STAGE_ALL;
+}
+
+ShaderReloader::ShaderReloader()
+    : m_Device(VK_NULL_HANDLE), m_Compiler(nullptr), m_NumReloads(0), m_NumFailed(0)
+{
+}
+
+void ShaderReloader::Init(VkDevice Device, ShaderCompiler& Compiler,
+    const std::vector<std::filesystem::path>& WatchDirectories)
+{
+    m_Device = Device;
+    m_Compiler = &Compiler;
+
+    if (!WatchDirectories.empty())
+    {
+        m_Watcher.Init(WatchDirectories,
+            [this](const std::vector<std::filesystem::path>& Paths) { OnFilesChanged(Paths); });
+    }
+}
+
+void ShaderReloader::Destroy()
+{
+    // Joins the watcher thread, no rebuild can be in flight afterwards
+    m_Watcher.Destroy();
+
+    if (m_NumReloads || m_NumFailed)
+    {
+        DEBUG_DISPLAY("Shader reloads: %u succeeded, %u failed", m_NumReloads.load(),
+            m_NumFailed.load());
+    }
+
+    // The device is idle at this point
+    for (auto& Target : m_Programs)
+    {
+        m_UnfencedPipelines.push_back(Target->Pipeline.Handle);
+        m_UnfencedPipelines.push_back(Target->PendingHandle);
+    }
+
+    for (auto& Retired : m_RetiredPipelines)
+    {
+        m_UnfencedPipelines.push_back(Retired.Handle);
+    }
+
+    for (VkPipeline Handle : m_UnfencedPipelines)
+    {
+        if (Handle)
+        {
+            vkDestroyPipeline(m_Device, Handle, nullptr);
+        }
+    }
+
+    m_Programs.clear();
+    m_UnfencedPipelines.clear();
+    m_RetiredPipelines.clear();
+    m_Compiler = nullptr;
+    m_Device = VK_NULL_HANDLE;
+}
+
+ReloadablePipeline* ShaderReloader::CreatePipeline(
+    const std::vector<ShaderDesc>& Shaders, const PipelineBuildFunction& Build)
+{
+    DEBUG_ASSERT(m_Compiler);
+
+    auto Target = std::make_shared<Program>();
+    Target->Shaders = Shaders;
+    Target->Build = Build;
+
+    std::vector<const ShaderBinary*> Binaries;
+    for (auto& Shader : Shaders)
+    {
+        Target->Binaries.push_back(m_Compiler->Compile(Shader));
+        CHECK(Target->Binaries.back()->IsValid(), "Failed to compile %s:\n%s",
+            Shader.Path.string().c_str(), Target->Binaries.back()->Log.c_str());
+        Binaries.push_back(Target->Binaries.back().get());
+    }
+
+    Target->Pipeline.Handle = BuildPipeline(*Target, Binaries);
+    CHECK(Target->Pipeline.Handle, "Failed to build pipeline");
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Programs.push_back(Target);
+    return &Target->Pipeline;
+}
+
+void ShaderReloader::DestroyPipeline(ReloadablePipeline*& Pipeline)
+{
+    if (!Pipeline)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    auto Found = std::find_if(m_Programs.begin(), m_Programs.end(),
+        [Pipeline](const auto& Target) { return &Target->Pipeline == Pipeline; });
+    DEBUG_ASSERT(Found != m_Programs.end(), "Unknown reloadable pipeline");
+
+    // A rebuild still running on the watcher thread sees the flag and drops its result
+    Program& Target = **Found;
+    Target.Destroyed = true;
+    m_UnfencedPipelines.push_back(Target.Pipeline.Handle);
+    m_UnfencedPipelines.push_back(Target.PendingHandle);
+    m_Programs.erase(Found);
+
+    Pipeline = nullptr;
+}
+
+void ShaderReloader::Update(uint64_t GraphicsSubmitted, uint64_t GraphicsCompleted,
+    uint64_t ComputeSubmitted, uint64_t ComputeCompleted)
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        for (auto& Target : m_Programs)
+        {
+            if (Target->PendingHandle)
+            {
+                m_UnfencedPipelines.push_back(Target->Pipeline.Handle);
+                Target->Pipeline.Handle = Target->PendingHandle;
+                Target->Pipeline.Generation++;
+                Target->PendingHandle = VK_NULL_HANDLE;
+            }
+        }
+
+        // Everything recorded before this boundary has been submitted by now
+        for (VkPipeline Handle : m_UnfencedPipelines)
+        {
+            if (Handle)
+            {
+                m_RetiredPipelines.push_back({Handle, GraphicsSubmitted, ComputeSubmitted});
+            }
+        }
+        m_UnfencedPipelines.clear();
+    }
+
+    while (!m_RetiredPipelines.empty() &&
+           m_RetiredPipelines.front().GraphicsValue <= GraphicsCompleted &&
+           m_RetiredPipelines.front().ComputeValue <= ComputeCompleted)
+    {
+        vkDestroyPipeline(m_Device, m_RetiredPipelines.front().Handle, nullptr);
+        m_RetiredPipelines.pop_front();
+    }
+}
+
+VkPipeline ShaderReloader::BuildPipeline(
+    const Program& Target, const std::vector<const ShaderBinary*>& Binaries) const
+{
+    std::vector<VkPipelineShaderStageCreateInfo> Stages(Binaries.size());
+
+    for (size_t Index = 0; Index < Binaries.size(); ++Index)
+    {
+        VkShaderModuleCreateInfo ModuleInfo = {};
+        ModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        ModuleInfo.codeSize = Binaries[Index]->CodeSize;
+        ModuleInfo.pCode = Binaries[Index]->Code;
+
+        VkPipelineShaderStageCreateInfo& Stage = Stages[Index];
+        Stage = {};
+        Stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        Stage.stage = GetVulkanStage(Target.Shaders[Index].Stage);
+        Stage.pName = Target.Shaders[Index].EntryPoint.c_str();
+        VULKAN_RESULT(vkCreateShaderModule(m_Device, &ModuleInfo, nullptr, &Stage.module));
+    }
+
+    VkPipeline Pipeline = VK_NULL_HANDLE;
+
+    try
+    {
+        Pipeline = Target.Build(Stages);
+    }
+    catch (const std::exception& Exception)
+    {
+        DEBUG_ERROR("Pipeline build failed: %s", Exception.what());
+    }
+
+    // Modules are only needed during pipeline creation
+    for (auto& Stage : Stages)
+    {
+        vkDestroyShaderModule(m_Device, Stage.module, nullptr);
+    }
+
+    return Pipeline;
+}
+
+void ShaderReloader::OnFilesChanged(const std::vector<std::filesystem::path>& Paths)
+{
+    std::vector<std::shared_ptr<Program>> Programs;
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        Programs = m_Programs;
+    }
+
+    std::unordered_set<std::string> ChangedPaths;
+    for (auto& Path : Paths)
+    {
+        ChangedPaths.insert(Path.lexically_normal().string());
+    }
+
+    for (auto& Target : Programs)
+    {
+        // Only the shaders that read one of the changed files are compiled again
+        std::vector<std::unique_ptr<ShaderBinary>> Recompiled(Target->Shaders.size());
+        std::vector<const ShaderBinary*> Binaries(Target->Shaders.size());
+        bool Stale = false;
+        bool Failed = false;
+
+        for (size_t Index = 0; Index < Target->Shaders.size(); ++Index)
+        {
+            Binaries[Index] = Target->Binaries[Index].get();
+
+            bool Changed = std::any_of(Target->Binaries[Index]->Dependencies.begin(),
+                Target->Binaries[Index]->Dependencies.end(), [&](const ShaderDependency& Dependency)
+                { return ChangedPaths.count(Dependency.Path.string()) != 0; });
+
+            if (!Changed)
+            {
+                continue;
+            }
+
+            const ShaderDesc& Shader = Target->Shaders[Index];
+            DEBUG_INFO("Recompiling %s", Shader.Path.string().c_str());
+
+            Stale = true;
+            Recompiled[Index] = m_Compiler->Compile(Shader);
+            Binaries[Index] = Recompiled[Index].get();
+
+            if (!Recompiled[Index]->IsValid())
+            {
+                DEBUG_ERROR("Failed to compile %s, keeping the current pipeline:\n%s",
+                    Shader.Path.string().c_str(), Recompiled[Index]->Log.c_str());
+                Failed = true;
+                break;
+            }
+        }
+
+        if (!Stale)
+        {
+            continue;
+        }
+
+        VkPipeline Pipeline = Failed ? VK_NULL_HANDLE : BuildPipeline(*Target, Binaries);
+
+        if (!Pipeline)
+        {
+            m_NumFailed++;
+            continue;
+        }
+
+        for (size_t Index = 0; Index < Recompiled.size(); ++Index)
+        {
+            if (Recompiled[Index])
+            {
+                Target->Binaries[Index] = std::move(Recompiled[Index]);
+            }
+        }
+
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        // Never bound, so neither a dropped result nor an unclaimed earlier rebuild needs fencing
+        if (Target->Destroyed)
+        {
+            vkDestroyPipeline(m_Device, Pipeline, nullptr);
+            continue;
+        }
+
+        if (Target->PendingHandle)
+        {
+            vkDestroyPipeline(m_Device, Target->PendingHandle, nullptr);
+        }
+
+        Target->PendingHandle = Pipeline;
+        m_NumReloads++;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "FileWatcher.h"
+#include "ShaderCompiler.h"
+#include "pch.h"
+
+// Receives one stage per shader, in the order the shaders were given. Rebuilds run on the watcher
+// thread, so the function must only use state that is safe to touch from there
+using PipelineBuildFunction =
+    std::function<VkPipeline(const std::vector<VkPipelineShaderStageCreateInfo>& Stages)>;
+
+struct ReloadablePipeline
+{
+    VkPipeline Handle = VK_NULL_HANDLE;
+    uint32_t Generation = 0;
+};
+
+// Owns pipelines built from GLSL sources and rebuilds them when a source or one of its includes
+// changes on disk. Only the shaders that depend on a modified file are recompiled, on the watcher
+// thread. Rebuilt pipelines are swapped in at the next frame boundary and the replaced ones are
+// destroyed once the frames using them have retired. A failed compile keeps the current pipeline
+class ShaderReloader
+{
+public:
+    ShaderReloader();
+    ~ShaderReloader() = default;
+    void Init(VkDevice Device, ShaderCompiler& Compiler,
+        const std::vector<std::filesystem::path>& WatchDirectories);
+    void Destroy();
+
+    ReloadablePipeline* CreatePipeline(
+        const std::vector<ShaderDesc>& Shaders, const PipelineBuildFunction& Build);
+    void DestroyPipeline(ReloadablePipeline*& Pipeline);
+
+    // Called at a frame boundary, before recording. The submitted values are the last ones that
+    // may reference the current pipelines
+    void Update(uint64_t GraphicsSubmitted, uint64_t GraphicsCompleted, uint64_t ComputeSubmitted,
+        uint64_t ComputeCompleted);
+
+private:
+    struct Program
+    {
+        ReloadablePipeline Pipeline;
+        std::vector<ShaderDesc> Shaders;
+        PipelineBuildFunction Build;
+        // Only touched by the watcher thread once the program is registered
+        std::vector<std::unique_ptr<ShaderBinary>> Binaries;
+        // Guarded by m_Mutex
+        VkPipeline PendingHandle = VK_NULL_HANDLE;
+        bool Destroyed = false;
+    };
+
+    struct RetiredPipeline
+    {
+        VkPipeline Handle;
+        uint64_t GraphicsValue;
+        uint64_t ComputeValue;
+    };
+
+    VkPipeline BuildPipeline(
+        const Program& Target, const std::vector<const ShaderBinary*>& Binaries) const;
+    void OnFilesChanged(const std::vector<std::filesystem::path>& Paths);
+
+    VkDevice m_Device;
+    ShaderCompiler* m_Compiler;
+    FileWatcher m_Watcher;
+    std::mutex m_Mutex;
+    std::vector<std::shared_ptr<Program>> m_Programs;
+    // Replaced or destroyed since the last frame boundary, fenced by the next one
+    std::vector<VkPipeline> m_UnfencedPipelines;
+    std::deque<RetiredPipeline> m_RetiredPipelines;
+    std::atomic<uint32_t> m_NumReloads;
+    std::atomic<uint32_t> m_NumFailed;
+};
@@ -0,0 +1,62 @@
+#include "TextureFile.h"
+
+TextureFile::TextureFile() : m_Header(nullptr) {}
+
+bool TextureFile::Open(const std::filesystem::path& Path)
+{
+    Close();
+
+    // Every level gets uploaded, smallest first, so the whole file is read ahead
+    if (!m_File.Open(Path, FileAccessHint::WILL_NEED))
+    {
+        DEBUG_WARNING("Failed to open texture %s", Path.string().c_str());
+        return false;
+    }
+
+    const TextureFileHeader* Header = reinterpret_cast<const TextureFileHeader*>(m_File.GetData());
+
+    if (m_File.GetSize() < sizeof(TextureFileHeader) || !ValidateHeader(*Header, m_File.GetSize()))
+    {
+        DEBUG_WARNING("Discarding texture %s: unknown format or levels out of bounds",
+            Path.string().c_str());
+        Close();
+        return false;
+    }
+
+    m_Header = Header;
+    return true;
+}
+
+void TextureFile::Close()
+{
+    m_File.Close();
+    m_Header = nullptr;
+}
+
+bool TextureFile::ValidateHeader(const TextureFileHeader& Header, uint64_t FileSize)
+{
+    if (Header.Magic != TEXTURE_FILE_MAGIC || Header.Version != TEXTURE_FILE_VERSION ||
+        Header.NumLevels == 0 || Header.NumLevels > TEXTURE_FILE_MAX_LEVELS ||
+        Header.BlockExtent == 0 || Header.BlockSize == 0)
+    {
+        return false;
+    }
+
+    for (uint32_t Level = 0; Level < Header.NumLevels; ++Level)
+    {
+        const TextureLevel& Info = Header.Levels[Level];
+        uint64_t BlocksWide = (Info.Width + Header.BlockExtent - 1) / Header.BlockExtent;
+        uint64_t BlocksHigh = (Info.Height + Header.BlockExtent - 1) / Header.BlockExtent;
+
+        if (Info.Width != std::max(Header.Width >> Level, 1u) ||
+            Info.Height != std::max(Header.Height >> Level, 1u) ||
+            Info.RowPitch != BlocksWide * Header.BlockSize ||
+            Info.Size != BlocksHigh * Info.RowPitch || Info.Offset % TEXTURE_FILE_ALIGNMENT != 0 ||
+            Info.Offset > FileSize || Info.Size > FileSize - Info.Offset)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
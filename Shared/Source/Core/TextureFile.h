@@ -0,0 +1,65 @@
+#pragma once
+#include "MappedFile.h"
+#include "pch.h"
+
+#define TEXTURE_FILE_MAGIC 0x58455454  // "TTEX"
+#define TEXTURE_FILE_VERSION 1
+#define TEXTURE_FILE_MAX_LEVELS 16
+// Levels start at multiples of this, enough for any texel block
+#define TEXTURE_FILE_ALIGNMENT 16
+
+struct TextureLevel
+{
+    // Byte range in the file, tightly packed rows of blocks
+    uint64_t Offset;
+    uint64_t Size;
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t RowPitch;
+    uint32_t Reserved;
+};
+
+// The level index is part of the fixed size header, as in KTX2, and the levels are stored smallest
+// first. A streamer reads the header alone, checks it with ValidateHeader and then requests the
+// levels one by one from the far end of the mip chain
+struct TextureFileHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    // VkFormat of the data, block compressed or R8G8B8A8
+    uint32_t Format;
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t NumLevels;
+    // Bytes per block and texels per block side, 1 for uncompressed formats
+    uint32_t BlockSize;
+    uint32_t BlockExtent;
+    TextureLevel Levels[TEXTURE_FILE_MAX_LEVELS];
+};
+
+// Cooked texture read in place from a mapping, each level can be handed to the upload as it is
+class TextureFile
+{
+public:
+    TextureFile();
+    bool Open(const std::filesystem::path& Path);
+    void Close();
+    static bool ValidateHeader(const TextureFileHeader& Header, uint64_t FileSize);
+
+    bool IsOpen() const { return m_Header != nullptr; }
+    const TextureFileHeader& GetHeader() const { return *m_Header; }
+    VkFormat GetFormat() const { return static_cast<VkFormat>(m_Header->Format); }
+    uint32_t GetNumLevels() const { return m_Header->NumLevels; }
+    VkExtent3D GetExtent(uint32_t Level) const
+    {
+        return {m_Header->Levels[Level].Width, m_Header->Levels[Level].Height, 1};
+    }
+    std::span<const uint8_t> GetLevel(uint32_t Level) const
+    {
+        return m_File.GetSpan(m_Header->Levels[Level].Offset, m_Header->Levels[Level].Size);
+    }
+
+private:
+    MappedFile m_File;
+    const TextureFileHeader* m_Header;
+};
@@ -24,8 +24,12 @@ namespace Utility
     {
         va_list args;
         va_start(args, format);
+        // Measuring consumes the list, the second pass needs its own copy
+        va_list measure;
+        va_copy(measure, args);
         std::string result;
-        result.resize(vsnprintf(nullptr, 0, format, args));
+        result.resize(vsnprintf(nullptr, 0, format, measure));
+        va_end(measure);
         vsnprintf(result.data(), result.size() + 1, format, args);
         va_end(args);
         return result;
@@ -36,25 +40,23 @@ namespace Utility
         return "";
     };
 
-    inline std::string LoadFile(const char* Filename)
+    // FNV-1a, pass a previous result as the seed to hash several ranges into one value
+    inline uint64_t Hash(const void* Data, size_t Size, uint64_t Seed = 0xcbf29ce484222325ull)
     {
-        std::ifstream File;
-        std::stringstream Stream;
+        const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
 
-        File.exceptions(std::ifstream::badbit | std::ifstream::failbit);
-
-        try
-        {
-            File.open(Filename);
-            Stream << File.rdbuf();
-            File.close();
-        }
-        catch (const std::exception& e)
+        for (size_t Index = 0; Index < Size; ++Index)
         {
-            throw std::runtime_error(Utility::Format("Failed to load file at %s", Filename));
+            Seed ^= Bytes[Index];
+            Seed *= 0x100000001b3ull;
         }
 
-        return Stream.str();
+        return Seed;
+    }
+
+    inline uint64_t Hash(const std::string& Text, uint64_t Seed = 0xcbf29ce484222325ull)
+    {
+        return Hash(Text.data(), Text.size(), Seed);
     }
 }  // namespace Utility
 
@@ -1,19 +1,20 @@
 #include "VulkanApplication.h"
-
-#define VULKAN_RESULT(Result) CHECK(Result == VK_SUCCESS, "Vulkan Error (%d): %s", Result, #Result)
+#include "VulkanUtility.h"
 
 VulkanApplication::VulkanApplication(const ApplicationInfo& Info)
     : Application(Info),
       m_Instance(VK_NULL_HANDLE),
       m_DebugMessenger(VK_NULL_HANDLE),
       m_Device(VK_NULL_HANDLE),
+      m_PipelineCreationFeedback(false),
+      m_DynamicRendering(false),
+      m_CmdBeginRendering(nullptr),
+      m_CmdEndRendering(nullptr),
       m_Surface(VK_NULL_HANDLE),
       m_SwapChain(VK_NULL_HANDLE),
       m_RenderPass(VK_NULL_HANDLE),
-      m_CommandPool(VK_NULL_HANDLE),
-      m_CurrentFrameIndex(-1),
-      m_ImageSemaphoreIndex(-1),
-      m_CommandBufferIndex(-1)
+      m_FrameIndex(-1),
+      m_ImageIndex(0)
 {
 }
 
@@ -21,6 +22,9 @@ void VulkanApplication::Init()
 {
     Application::Init();
 
+    // The main thread becomes worker 0 and helps whenever it waits on jobs
+    m_JobSystem.Init(m_Info.WorkerThreads);
+
     InitGraphics();
 };
 
@@ -28,8 +32,10 @@ void VulkanApplication::Destroy()
 {
     DeviceWaitIdle();
 
-    DestroySyncObjects();
-    DestroyCommandPool();
+    DestroyFrames();
+    m_UploadManager.Destroy();
+    m_ShaderReloader.Destroy();
+    m_BindlessTable.Destroy();
 
     for (auto& FrameBuffer : m_FrameBuffers)
     {
@@ -40,34 +46,71 @@ void VulkanApplication::Destroy()
     DestroyBackBuffers();
     DestroySwapChain();
     DestroySurface();
+    m_PipelineCache.Destroy();
+    m_MemoryAllocator.LogStatistics();
+    m_MemoryAllocator.Destroy();
     DestroyDevice();
     DestroyDebugMessenger();
     DestroyInstance();
+    m_ShaderCompiler.Destroy();
+    m_JobSystem.Destroy();
 
     Application::Destroy();
 };
 
 void VulkanApplication::InitGraphics()
 {
+    PROFILE_FUNCTION();
+
     CreateInstance();
     CreateDebugMessenger();
     SelectPhysicalDevice();
     CreateDevice();
-    CreateSurface();
-    SetupPresentQueue();
-    CreateSwapChain(
-        VK_FORMAT_B8G8R8A8_SRGB, m_Info.WindowWidth, m_Info.WindowHeight, NUM_BACKBUFFERS);
-    CreateBackBuffers(VK_FORMAT_B8G8R8A8_SRGB, m_Info.WindowWidth, m_Info.WindowHeight);
-    CreateRenderPass(m_BackBuffers[0]);
+    m_MemoryAllocator.Init(m_PhysicalDevice, m_Device);
+    m_UploadManager.Init(m_Device, m_MemoryAllocator, m_TransferQueue.Handle,
+        m_TransferQueue.FamilyIndex, m_GraphicsQueue.FamilyIndex, m_Features12.timelineSemaphore);
+    m_PipelineCache.Init(m_PhysicalDevice, m_Device,
+        std::filesystem::current_path() / m_Info.PipelineCachePath, m_PipelineCreationFeedback);
+
+    std::vector<std::filesystem::path> ShaderDirectories(
+        m_Info.ShaderDirectories.begin(), m_Info.ShaderDirectories.end());
+    m_ShaderCompiler.Init(std::filesystem::current_path() / m_Info.ShaderCachePath,
+        ShaderDirectories, m_Info.ApiVersion);
+    m_ShaderReloader.Init(m_Device, m_ShaderCompiler,
+        m_Info.ShaderHotReload ? ShaderDirectories : std::vector<std::filesystem::path>());
+
+    if (VulkanBindlessTable::IsSupported(m_Features12))
+    {
+        m_BindlessTable.Init(m_PhysicalDevice, m_Device);
+    }
+
+    if (IsHeadless())
+    {
+        CreateOffscreenBackBuffers(
+            VK_FORMAT_B8G8R8A8_SRGB, m_Info.WindowWidth, m_Info.WindowHeight, NUM_BACKBUFFERS);
+    }
+    else
+    {
+        CreateSurface();
+        SetupPresentQueue();
+        CreateSwapChain(
+            VK_FORMAT_B8G8R8A8_SRGB, m_Info.WindowWidth, m_Info.WindowHeight, NUM_BACKBUFFERS);
+        CreateBackBuffers(VK_FORMAT_B8G8R8A8_SRGB, m_Info.WindowWidth, m_Info.WindowHeight);
+    }
 
-    m_FrameBuffers.resize(NUM_BACKBUFFERS);
-    for (uint32_t Index = 0; Index < m_FrameBuffers.size(); ++Index)
+    // Dynamic rendering takes the back buffer view directly at the start of every pass
+    if (!m_DynamicRendering)
     {
-        m_FrameBuffers[Index] = CreateFrameBuffer(m_BackBuffers[Index]);
+        CreateRenderPass(m_BackBuffers[0]);
+
+        m_FrameBuffers.resize(m_BackBuffers.size());
+        for (uint32_t Index = 0; Index < m_FrameBuffers.size(); ++Index)
+        {
+            m_FrameBuffers[Index] = CreateFrameBuffer(m_BackBuffers[Index]);
+        }
     }
 
-    CreateCommandPool();
-    CreateSyncObjects();
+    CreateFrames(m_Info.FramesInFlight);
 }
 
 inline std::vector<const char*> GetValidationLayers()
@@ -75,10 +118,15 @@ inline std::vector<const char*> GetValidationLayers()
     return {"VK_LAYER_KHRONOS_validation"};
 }
 
-inline std::vector<const char*> GetInstanceExtensions()
+inline std::vector<const char*> GetInstanceExtensions(bool Headless)
 {
     std::vector<const char*> InstanceExtensions = {"VK_EXT_debug_utils"};
 
+    if (Headless)
+    {
+        return InstanceExtensions;
+    }
+
     uint32_t ExtensionCount = 0;
     auto Extensions = glfwGetRequiredInstanceExtensions(&ExtensionCount);
     for (uint32_t Index = 0; Index < ExtensionCount; ++Index)
@@ -90,6 +138,8 @@ inline std::vector<const char*> GetInstanceExtensions()
 
 void VulkanApplication::CreateInstance()
 {
+    PROFILE_FUNCTION();
+
     uint32_t ApiVersion = m_Info.ApiVersion;
 
     VkApplicationInfo AppInfo = {};
@@ -104,7 +154,7 @@ void VulkanApplication::CreateInstance()
     InstanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     InstanceInfo.pApplicationInfo = &AppInfo;
 
-    auto Extensions = GetInstanceExtensions();
+    auto Extensions = GetInstanceExtensions(IsHeadless());
     InstanceInfo.enabledExtensionCount = Extensions.size();
     InstanceInfo.ppEnabledExtensionNames = Extensions.size() > 0 ? Extensions.data() : nullptr;
 
@@ -194,6 +244,8 @@ inline std::string GetDeviceTypeDescription(VkPhysicalDeviceType DeviceType)
 
 void VulkanApplication::SelectPhysicalDevice()
 {
+    PROFILE_FUNCTION();
+
     DEBUG_ASSERT(m_Instance != VK_NULL_HANDLE);
 
     uint32_t PhysicalDeviceCount = 0;
@@ -249,11 +301,29 @@ void VulkanApplication::SelectPhysicalDevice()
         VK_API_VERSION_MINOR(Properties.apiVersion), VK_API_VERSION_PATCH(Properties.apiVersion));
 }
 
-inline std::vector<const char*> GetDeviceExtensions()
+inline std::vector<const char*> GetDeviceExtensions(bool Headless)
 {
+    if (Headless)
+    {
+        return {};
+    }
+
     return {"VK_KHR_swapchain"};
 }
 
+inline bool IsDeviceExtensionSupported(VkPhysicalDevice PhysicalDevice, const char* Name)
+{
+    uint32_t ExtensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(PhysicalDevice, nullptr, &ExtensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> Extensions(ExtensionCount);
+    vkEnumerateDeviceExtensionProperties(
+        PhysicalDevice, nullptr, &ExtensionCount, Extensions.data());
+
+    return std::any_of(Extensions.begin(), Extensions.end(),
+        [Name](const auto& Extension) { return strcmp(Extension.extensionName, Name) == 0; });
+}
+
 inline std::vector<VkQueueFamilyProperties> GetQueueFamilyProperties(
     VkPhysicalDevice PhysicalDevice)
 {
@@ -296,14 +366,25 @@ inline std::string GetQueueFamilyDescription(VkQueueFamilyProperties Properties)
 
 void VulkanApplication::CreateDevice()
 {
+    PROFILE_FUNCTION();
+
     DEBUG_ASSERT(m_PhysicalDevice != VK_NULL_HANDLE);
 
     std::vector<VkQueueFamilyProperties> QueueFamilies = GetQueueFamilyProperties(m_PhysicalDevice);
 
-    std::vector<float> QueuePriorities;
     std::vector<VkDeviceQueueCreateInfo> QueueCreateInfos;
 
+    // Shared by every create info, so it must not be resized once the first one points into it
+    uint32_t MaxQueueCount = 0;
+    for (auto& Family : QueueFamilies)
+    {
+        MaxQueueCount = std::max(MaxQueueCount, Family.queueCount);
+    }
+    std::vector<float> QueuePriorities(MaxQueueCount, 1.0f);
+
     uint32_t GraphicsQueueFamilyIndex = UINT32_MAX;
+    uint32_t TransferQueueFamilyIndex = UINT32_MAX;
+    uint32_t ComputeQueueFamilyIndex = UINT32_MAX;
 
     for (uint32_t FamilyIndex = 0; FamilyIndex < QueueFamilies.size(); ++FamilyIndex)
     {
@@ -319,6 +400,24 @@ void VulkanApplication::CreateDevice()
             }
         }
 
+        // A transfer-only family is a copy engine that runs uploads beside the graphics queue
+        VkQueueFlags TypeFlags = CurrentFamilyQueue.queueFlags &
+            (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT);
+
+        if (TypeFlags == VK_QUEUE_TRANSFER_BIT && TransferQueueFamilyIndex == UINT32_MAX)
+        {
+            TransferQueueFamilyIndex = FamilyIndex;
+            ValidQueue = true;
+        }
+
+        // A compute family without graphics runs async compute beside the raster work
+        if ((TypeFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == VK_QUEUE_COMPUTE_BIT &&
+            ComputeQueueFamilyIndex == UINT32_MAX)
+        {
+            ComputeQueueFamilyIndex = FamilyIndex;
+            ValidQueue = true;
+        }
+
         if (!ValidQueue)
         {
             DEBUG_WARNING("Skipping unnecessary family queue (index=%d, count=%d): %s", FamilyIndex,
@@ -327,9 +426,6 @@ void VulkanApplication::CreateDevice()
             continue;
         }
 
-        QueuePriorities.resize(CurrentFamilyQueue.queueCount);
-        std::fill(QueuePriorities.begin(), QueuePriorities.end(), 1.0f);
-
         VkDeviceQueueCreateInfo QueueCreateInfo = {};
         QueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
         QueueCreateInfo.pQueuePriorities = QueuePriorities.data();
@@ -342,24 +438,118 @@ void VulkanApplication::CreateDevice()
         QueueCreateInfos.push_back(QueueCreateInfo);
     }
 
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(m_PhysicalDevice, &Properties);
+
+    bool Vulkan12 = m_Info.ApiVersion >= VK_API_VERSION_1_2 &&
+                    Properties.apiVersion >= VK_API_VERSION_1_2;
+    bool Vulkan13 = m_Info.ApiVersion >= VK_API_VERSION_1_3 &&
+                    Properties.apiVersion >= VK_API_VERSION_1_3;
+
+    // Dynamic rendering is core from Vulkan 1.3, the extension needs the 1.2 depth resolve
+    bool DynamicRenderingExtension =
+        Vulkan12 && !Vulkan13 &&
+        IsDeviceExtensionSupported(m_PhysicalDevice, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR DynamicRenderingFeatures = {};
+    DynamicRenderingFeatures.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+    VkPhysicalDeviceVulkan12Features SupportedFeatures12 = {};
+    SupportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    SupportedFeatures12.pNext =
+        Vulkan13 || DynamicRenderingExtension ? &DynamicRenderingFeatures : nullptr;
+
+    if (Vulkan12)
+    {
+        VkPhysicalDeviceFeatures2 Features = {};
+        Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        Features.pNext = &SupportedFeatures12;
+        vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &Features);
+    }
+
+    m_Features12 = {};
+    m_Features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    m_Features12.timelineSemaphore =
+        m_Info.TimelineSemaphores && SupportedFeatures12.timelineSemaphore;
+    // Lets the GPU profiler reset its queries without recording a command
+    m_Features12.hostQueryReset = SupportedFeatures12.hostQueryReset;
+
+    if (m_Info.BindlessDescriptors && VulkanBindlessTable::IsSupported(SupportedFeatures12))
+    {
+        VulkanBindlessTable::EnableFeatures(m_Features12);
+    }
+    else if (m_Info.BindlessDescriptors)
+    {
+        DEBUG_WARNING("Bindless descriptors requested but descriptor indexing is not supported");
+    }
+
+    m_DynamicRendering = m_Info.DynamicRendering && DynamicRenderingFeatures.dynamicRendering;
+    if (m_DynamicRendering)
+    {
+        m_Features12.pNext = &DynamicRenderingFeatures;
+    }
+    else if (m_Info.DynamicRendering)
+    {
+        DEBUG_WARNING("Dynamic rendering requested but not supported, using render passes");
+    }
+
     VkDeviceCreateInfo DeviceInfo = {};
     DeviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    auto Extensions = GetDeviceExtensions();
+    auto Extensions = GetDeviceExtensions(IsHeadless());
+
+    // Creation feedback reports pipeline cache hits, it is core from Vulkan 1.3
+    m_PipelineCreationFeedback = Vulkan13 || IsDeviceExtensionSupported(m_PhysicalDevice,
+                                                 VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+    if (m_PipelineCreationFeedback && !Vulkan13)
+    {
+        Extensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    }
+
+    if (m_DynamicRendering && !Vulkan13)
+    {
+        Extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    }
+
     DeviceInfo.enabledExtensionCount = Extensions.size();
-    DeviceInfo.ppEnabledExtensionNames = Extensions.data();
+    DeviceInfo.ppEnabledExtensionNames = Extensions.size() > 0 ? Extensions.data() : nullptr;
     auto Layers = GetValidationLayers();
     DeviceInfo.enabledLayerCount = Layers.size();
     DeviceInfo.ppEnabledLayerNames = Layers.data();
     DeviceInfo.pEnabledFeatures = nullptr;
+    DeviceInfo.pNext = Vulkan12 ? &m_Features12 : nullptr;
     DeviceInfo.queueCreateInfoCount = QueueCreateInfos.size();
     DeviceInfo.pQueueCreateInfos = QueueCreateInfos.data();
 
     VULKAN_RESULT(vkCreateDevice(m_PhysicalDevice, &DeviceInfo, nullptr, &m_Device));
+    m_Features12.pNext = nullptr;
+
+    if (m_DynamicRendering)
+    {
+        m_CmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(
+            m_Device, Vulkan13 ? "vkCmdBeginRendering" : "vkCmdBeginRenderingKHR");
+        m_CmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(
+            m_Device, Vulkan13 ? "vkCmdEndRendering" : "vkCmdEndRenderingKHR");
+        CHECK(m_CmdBeginRendering && m_CmdEndRendering, "Failed to load dynamic rendering");
+    }
+
+    DEBUG_DISPLAY("Rendering: %s", m_DynamicRendering ? "Dynamic" : "Render passes");
 
     if (GraphicsQueueFamilyIndex != UINT32_MAX)
     {
         m_GraphicsQueue = CreateQueue(GraphicsQueueFamilyIndex);
     }
+
+    m_TransferQueue = TransferQueueFamilyIndex != UINT32_MAX ? CreateQueue(TransferQueueFamilyIndex)
+                                                             : m_GraphicsQueue;
+
+    // Work on a second queue can only be ordered against the graphics queue with timelines
+    bool AsyncCompute = ComputeQueueFamilyIndex != UINT32_MAX && m_Features12.timelineSemaphore;
+    m_ComputeQueue = AsyncCompute ? CreateQueue(ComputeQueueFamilyIndex) : m_GraphicsQueue;
+
+    DEBUG_DISPLAY("Compute queue: %s (family %u)", AsyncCompute ? "Async" : "Graphics",
+        m_ComputeQueue.FamilyIndex);
 }
 
 void VulkanApplication::DeviceWaitIdle()
@@ -523,7 +713,10 @@ void VulkanApplication::CreateSwapChain(
     SwapChainInfo.imageColorSpace = SurfaceFormat.colorSpace;
     SwapChainInfo.imageFormat = SurfaceFormat.format;
     SwapChainInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    SwapChainInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Transfer writes let render graphs blit their result into the back buffer
+    SwapChainInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                               (SurfaceCapabilities.supportedUsageFlags &
+                                   VK_IMAGE_USAGE_TRANSFER_DST_BIT);
     SwapChainInfo.imageArrayLayers = 1;
     SwapChainInfo.compositeAlpha = GetCompositeAlpha(SurfaceCapabilities);
     SwapChainInfo.presentMode = GetPresentMode();
@@ -561,20 +754,195 @@ void VulkanApplication::CreateBackBuffers(VkFormat Format, uint32_t Width, uint3
         m_BackBuffers[Index].Format = Format;
         m_BackBuffers[Index].Width = Width;
         m_BackBuffers[Index].Height = Height;
+        m_BackBuffers[Index].Image = SwapChainImages[Index];
         m_BackBuffers[Index].ImageView =
             CreateImageView(VK_IMAGE_VIEW_TYPE_2D, Format, SwapChainImages[Index]);
     }
 }
 
+void VulkanApplication::CreateOffscreenBackBuffers(
+    VkFormat Format, uint32_t Width, uint32_t Height, uint32_t NumBackBuffers)
+{
+    DEBUG_ASSERT(m_Device);
+
+    m_BackBuffers.resize(NumBackBuffers);
+    for (auto& BackBuffer : m_BackBuffers)
+    {
+        VkImageCreateInfo ImageInfo = {};
+        ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        ImageInfo.imageType = VK_IMAGE_TYPE_2D;
+        ImageInfo.format = Format;
+        ImageInfo.extent.width = Width;
+        ImageInfo.extent.height = Height;
+        ImageInfo.extent.depth = 1;
+        ImageInfo.mipLevels = 1;
+        ImageInfo.arrayLayers = 1;
+        ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ImageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                          VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VULKAN_RESULT(vkCreateImage(m_Device, &ImageInfo, nullptr, &BackBuffer.Image));
+
+        BackBuffer.Allocation = m_MemoryAllocator.AllocateForImage(
+            BackBuffer.Image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        BackBuffer.Format = Format;
+        BackBuffer.Width = Width;
+        BackBuffer.Height = Height;
+        BackBuffer.ImageView = CreateImageView(VK_IMAGE_VIEW_TYPE_2D, Format, BackBuffer.Image);
+    }
+
+    DEBUG_DISPLAY("Offscreen images: %d", NumBackBuffers);
+    DEBUG_DISPLAY("Offscreen extent: (%d, %d)", Width, Height);
+}
+
 void VulkanApplication::DestroyBackBuffers()
 {
     for (auto& BackBuffer : m_BackBuffers)
     {
         vkDestroyImageView(m_Device, BackBuffer.ImageView, nullptr);
         BackBuffer.ImageView = VK_NULL_HANDLE;
+
+        // Swap chain images are owned by the swap chain, only offscreen images carry memory
+        if (BackBuffer.Allocation.IsValid())
+        {
+            vkDestroyImage(m_Device, BackBuffer.Image, nullptr);
+            m_MemoryAllocator.Free(BackBuffer.Allocation);
+        }
+
+        BackBuffer.Image = VK_NULL_HANDLE;
+    }
+}
+
+VulkanBuffer VulkanApplication::CreateBuffer(VkDeviceSize Size, VkBufferUsageFlags Usage,
+    VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Preferred)
+{
+    DEBUG_ASSERT(m_Device);
+
+    VkBufferCreateInfo BufferInfo = {};
+    BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferInfo.size = Size;
+    BufferInfo.usage = Usage;
+    BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VulkanBuffer Buffer;
+    Buffer.Size = Size;
+    VULKAN_RESULT(vkCreateBuffer(m_Device, &BufferInfo, nullptr, &Buffer.Handle));
+    Buffer.Allocation = m_MemoryAllocator.AllocateForBuffer(Buffer.Handle, Required, Preferred);
+
+    return Buffer;
+}
+
+void VulkanApplication::DestroyBuffer(VulkanBuffer& Buffer)
+{
+    if (Buffer.Handle)
+    {
+        vkDestroyBuffer(m_Device, Buffer.Handle, nullptr);
+        m_MemoryAllocator.Free(Buffer.Allocation);
+        Buffer.Handle = VK_NULL_HANDLE;
+    }
+}
+
+std::vector<std::unique_ptr<ShaderBinary>> VulkanApplication::CompileShaders(
+    const std::vector<ShaderDesc>& Descs)
+{
+    return m_ShaderCompiler.CompileAll(m_JobSystem, Descs);
+}
+
+VkShaderModule VulkanApplication::CreateShaderModule(const ShaderBinary& Binary)
+{
+    DEBUG_ASSERT(m_Device);
+    CHECK(Binary.IsValid(), "Creating a shader module from a failed compile");
+
+    VkShaderModuleCreateInfo ModuleInfo = {};
+    ModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    ModuleInfo.codeSize = Binary.CodeSize;
+    ModuleInfo.pCode = Binary.Code;
+
+    VkShaderModule ShaderModule = VK_NULL_HANDLE;
+    VULKAN_RESULT(vkCreateShaderModule(m_Device, &ModuleInfo, nullptr, &ShaderModule));
+    return ShaderModule;
+}
+
+void VulkanApplication::DestroyShaderModule(VkShaderModule& ShaderModule)
+{
+    if (ShaderModule)
+    {
+        vkDestroyShaderModule(m_Device, ShaderModule, nullptr);
+        ShaderModule = VK_NULL_HANDLE;
     }
 }
 
+VkPipeline VulkanApplication::CreateGraphicsPipeline(
+    const VkGraphicsPipelineCreateInfo& PipelineInfo)
+{
+    DEBUG_ASSERT(m_Device);
+
+    if (!m_DynamicRendering || PipelineInfo.renderPass)
+    {
+        return m_PipelineCache.CreateGraphicsPipeline(PipelineInfo);
+    }
+
+    // Without a render pass the attachment formats come from the pNext chain, pipelines that
+    // do not provide them render into the back buffer
+    for (auto Next = static_cast<const VkBaseInStructure*>(PipelineInfo.pNext); Next;
+         Next = Next->pNext)
+    {
+        if (Next->sType == VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR)
+        {
+            return m_PipelineCache.CreateGraphicsPipeline(PipelineInfo);
+        }
+    }
+
+    VkPipelineRenderingCreateInfoKHR RenderingInfo = {};
+    RenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    RenderingInfo.pNext = PipelineInfo.pNext;
+    RenderingInfo.colorAttachmentCount = 1;
+    RenderingInfo.pColorAttachmentFormats = &m_BackBuffers[0].Format;
+
+    VkGraphicsPipelineCreateInfo BackBufferPipelineInfo = PipelineInfo;
+    BackBufferPipelineInfo.pNext = &RenderingInfo;
+    return m_PipelineCache.CreateGraphicsPipeline(BackBufferPipelineInfo);
+}
+
+VkPipeline VulkanApplication::CreateComputePipeline(const VkComputePipelineCreateInfo& PipelineInfo)
+{
+    DEBUG_ASSERT(m_Device);
+
+    return m_PipelineCache.CreateComputePipeline(PipelineInfo);
+}
+
+void VulkanApplication::DestroyPipeline(VkPipeline& Pipeline)
+{
+    if (Pipeline)
+    {
+        vkDestroyPipeline(m_Device, Pipeline, nullptr);
+        Pipeline = VK_NULL_HANDLE;
+    }
+}
+
+VkDescriptorSet VulkanApplication::AllocateDescriptorSet(VkDescriptorSetLayout Layout)
+{
+    // Transient, the set is recycled when this frame slot comes around again
+    return GetCurrentFrame().DescriptorAllocator.Allocate(Layout);
+}
+
+ReloadablePipeline* VulkanApplication::CreateReloadablePipeline(
+    const std::vector<ShaderDesc>& Shaders, const PipelineBuildFunction& Build)
+{
+    DEBUG_ASSERT(m_Device);
+
+    return m_ShaderReloader.CreatePipeline(Shaders, Build);
+}
+
+void VulkanApplication::DestroyReloadablePipeline(ReloadablePipeline*& Pipeline)
+{
+    m_ShaderReloader.DestroyPipeline(Pipeline);
+}
+
 VkImageView VulkanApplication::CreateImageView(VkImageViewType Type, VkFormat Format, VkImage Image)
 {
     VkImageViewCreateInfo ViewInfo = {};
@@ -600,7 +968,8 @@ VkImageView VulkanApplication::CreateImageView(VkImageViewType Type, VkFormat Fo
 void VulkanApplication::CreateRenderPass(VulkanBackBuffer& ColorBuffer)
 {
     VkAttachmentDescription ColorAttachment = {};
-    ColorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    ColorAttachment.finalLayout =
+        IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
     ColorAttachment.format = ColorBuffer.Format;
     ColorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     ColorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
@@ -679,43 +1048,65 @@ void VulkanApplication::DestroyFrameBuffer(VkFramebuffer& FrameBuffer)
     }
 }
 
-void VulkanApplication::CreateCommandPool()
+void VulkanApplication::CreateCommandPool(VulkanCommandPool& CommandPool, uint32_t FamilyIndex)
 {
     VkCommandPoolCreateInfo PoolInfo = {};
     PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    PoolInfo.queueFamilyIndex = m_GraphicsQueue.FamilyIndex;
-    PoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-
-    VULKAN_RESULT(vkCreateCommandPool(m_Device, &PoolInfo, nullptr, &m_CommandPool));
+    PoolInfo.queueFamilyIndex = FamilyIndex;
+    PoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
-    m_CommandBuffers.resize(NUM_BACKBUFFERS);
+    VULKAN_RESULT(vkCreateCommandPool(m_Device, &PoolInfo, nullptr, &CommandPool.Handle));
+}
 
-    for (uint32_t Index = 0; Index < m_CommandBuffers.size(); ++Index)
+void VulkanApplication::ResetCommandPool(VulkanCommandPool& CommandPool)
+{
+    // Recycles every command buffer of the pool at once, the buffers stay allocated for reuse
+    if (CommandPool.NumUsedPrimaryCommandBuffers > 0 ||
+        CommandPool.NumUsedSecondaryCommandBuffers > 0)
     {
-        m_CommandBuffers[Index] = CreateCommandBuffer();
+        VULKAN_RESULT(vkResetCommandPool(m_Device, CommandPool.Handle, 0));
+        CommandPool.NumUsedPrimaryCommandBuffers = 0;
+        CommandPool.NumUsedSecondaryCommandBuffers = 0;
     }
 }
 
-void VulkanApplication::DestroyCommandPool()
+void VulkanApplication::DestroyCommandPool(VulkanCommandPool& CommandPool)
 {
-    if (m_CommandPool)
+    if (CommandPool.Handle)
     {
-        vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
-        m_CommandPool = VK_NULL_HANDLE;
+        vkDestroyCommandPool(m_Device, CommandPool.Handle, nullptr);
+        CommandPool.Handle = VK_NULL_HANDLE;
     }
+
+    CommandPool.PrimaryCommandBuffers.clear();
+    CommandPool.SecondaryCommandBuffers.clear();
+    CommandPool.NumUsedPrimaryCommandBuffers = 0;
+    CommandPool.NumUsedSecondaryCommandBuffers = 0;
 }
 
-VkCommandBuffer VulkanApplication::CreateCommandBuffer()
+VkCommandBuffer VulkanApplication::AllocateCommandBuffer(
+    VulkanCommandPool& CommandPool, VkCommandBufferLevel Level)
 {
-    VkCommandBufferAllocateInfo AllocateInfo = {};
-    AllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    AllocateInfo.commandPool = m_CommandPool;
-    AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    AllocateInfo.commandBufferCount = 1;
+    bool Primary = Level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    auto& CommandBuffers =
+        Primary ? CommandPool.PrimaryCommandBuffers : CommandPool.SecondaryCommandBuffers;
+    uint32_t& NumUsedCommandBuffers = Primary ? CommandPool.NumUsedPrimaryCommandBuffers
+                                              : CommandPool.NumUsedSecondaryCommandBuffers;
 
-    VkCommandBuffer CommandBuffer;
-    VULKAN_RESULT(vkAllocateCommandBuffers(m_Device, &AllocateInfo, &CommandBuffer));
-    return CommandBuffer;
+    if (NumUsedCommandBuffers == CommandBuffers.size())
+    {
+        VkCommandBufferAllocateInfo AllocateInfo = {};
+        AllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        AllocateInfo.commandPool = CommandPool.Handle;
+        AllocateInfo.level = Level;
+        AllocateInfo.commandBufferCount = 1;
+
+        VkCommandBuffer CommandBuffer;
+        VULKAN_RESULT(vkAllocateCommandBuffers(m_Device, &AllocateInfo, &CommandBuffer));
+        CommandBuffers.push_back(CommandBuffer);
+    }
+
+    return CommandBuffers[NumUsedCommandBuffers++];
 }
 
 VkFence VulkanApplication::CreateFence(bool Signaled)
@@ -748,6 +1139,22 @@ VkSemaphore VulkanApplication::CreateSemaphore()
     return Semaphore;
 }
 
+VkSemaphore VulkanApplication::CreateTimelineSemaphore(uint64_t InitialValue)
+{
+    VkSemaphoreTypeCreateInfo TypeInfo = {};
+    TypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    TypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    TypeInfo.initialValue = InitialValue;
+
+    VkSemaphoreCreateInfo SemaphoreInfo = {};
+    SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    SemaphoreInfo.pNext = &TypeInfo;
+
+    VkSemaphore Semaphore = VK_NULL_HANDLE;
+    VULKAN_RESULT(vkCreateSemaphore(m_Device, &SemaphoreInfo, nullptr, &Semaphore));
+    return Semaphore;
+}
+
 void VulkanApplication::DestroySemaphore(VkSemaphore& Semaphore)
 {
     if (Semaphore)
@@ -757,62 +1164,240 @@ void VulkanApplication::DestroySemaphore(VkSemaphore& Semaphore)
     }
 }
 
-void VulkanApplication::CreateSyncObjects()
+uint64_t VulkanApplication::GetCompletedValue()
 {
-    m_AcquiredImageFences.resize(NUM_BACKBUFFERS);
-    for (uint32_t Index = 0; Index < m_AcquiredImageFences.size(); ++Index)
+    if (UseTimelineSemaphores())
     {
-        m_AcquiredImageFences[Index] = CreateFence();
+        VULKAN_RESULT(vkGetSemaphoreCounterValue(
+            m_Device, m_GraphicsTimeline.Semaphore, &m_GraphicsTimeline.CompletedValue));
+        return m_GraphicsTimeline.CompletedValue;
     }
 
-    m_AcquiredImageSemaphores.resize(NUM_BACKBUFFERS);
-    for (uint32_t Index = 0; Index < m_AcquiredImageSemaphores.size(); ++Index)
+    // Submissions to one queue retire in order, so the newest signaled fence bounds everything
+    for (auto& Frame : m_Frames)
     {
-        m_AcquiredImageSemaphores[Index] = CreateSemaphore();
+        if (Frame.TimelineValue > m_GraphicsTimeline.CompletedValue &&
+            vkGetFenceStatus(m_Device, Frame.RenderingDoneFence) == VK_SUCCESS)
+        {
+            m_GraphicsTimeline.CompletedValue = Frame.TimelineValue;
+        }
     }
 
-    m_RenderingDoneFences.resize(NUM_BACKBUFFERS);
-    for (uint32_t Index = 0; Index < m_RenderingDoneFences.size(); ++Index)
+    return m_GraphicsTimeline.CompletedValue;
+}
+
+bool VulkanApplication::IsValueRetired(uint64_t Value)
+{
+    return Value <= m_GraphicsTimeline.CompletedValue || Value <= GetCompletedValue();
+}
+
+void VulkanApplication::WaitForValue(uint64_t Value)
+{
+    PROFILE_FUNCTION();
+
+    DEBUG_ASSERT(Value <= m_GraphicsTimeline.SubmittedValue);
+
+    if (Value <= m_GraphicsTimeline.CompletedValue)
     {
-        m_RenderingDoneFences[Index] = CreateFence();
+        return;
     }
 
-    m_RenderingDoneSemaphores.resize(NUM_BACKBUFFERS);
-    for (uint32_t Index = 0; Index < m_RenderingDoneSemaphores.size(); ++Index)
+    if (UseTimelineSemaphores())
     {
-        m_RenderingDoneSemaphores[Index] = CreateSemaphore();
+        WaitForTimeline(m_GraphicsTimeline, Value);
+        return;
+    }
+
+    // A value no longer held by any slot was already waited on when its slot was reused
+    for (auto& Frame : m_Frames)
+    {
+        if (Frame.TimelineValue > m_GraphicsTimeline.CompletedValue && Frame.TimelineValue <= Value)
+        {
+            VULKAN_RESULT(
+                vkWaitForFences(m_Device, 1, &Frame.RenderingDoneFence, VK_TRUE, UINT64_MAX));
+        }
+    }
+
+    m_GraphicsTimeline.CompletedValue = Value;
+}
+
+void VulkanApplication::WaitForTimeline(VulkanTimeline& Timeline, uint64_t Value)
+{
+    if (Value <= Timeline.CompletedValue)
+    {
+        return;
+    }
+
+    VkSemaphoreWaitInfo WaitInfo = {};
+    WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    WaitInfo.semaphoreCount = 1;
+    WaitInfo.pSemaphores = &Timeline.Semaphore;
+    WaitInfo.pValues = &Value;
+
+    VULKAN_RESULT(vkWaitSemaphores(m_Device, &WaitInfo, UINT64_MAX));
+    Timeline.CompletedValue = Value;
+}
+
+uint64_t VulkanApplication::GetCompletedComputeValue()
+{
+    if (m_ComputeTimeline.Semaphore)
+    {
+        VULKAN_RESULT(vkGetSemaphoreCounterValue(
+            m_Device, m_ComputeTimeline.Semaphore, &m_ComputeTimeline.CompletedValue));
     }
+
+    return m_ComputeTimeline.CompletedValue;
 }
 
-void VulkanApplication::DestroySyncObjects()
+void VulkanApplication::WaitForComputeValue(uint64_t Value)
 {
-    for (auto& AcquiredFence : m_AcquiredImageFences)
+    DEBUG_ASSERT(Value <= m_ComputeTimeline.SubmittedValue);
+
+    if (m_ComputeTimeline.Semaphore)
     {
-        DestroyFence(AcquiredFence);
+        WaitForTimeline(m_ComputeTimeline, Value);
     }
+}
+
+void VulkanApplication::CreateFrames(uint32_t NumFramesInFlight)
+{
+    CHECK(NumFramesInFlight > 0, "At least one frame in flight is required");
 
-    for (auto& AcquiredSemaphore : m_AcquiredImageSemaphores)
+    // Each frame slot owns the objects it records and submits with, so the CPU only has to wait
+    // for a slot when it comes around again, NumFramesInFlight frames later. Command pools are
+    // externally synchronized, so every recording thread also gets a pool of its own
+    m_Frames.resize(NumFramesInFlight);
+    for (auto& Frame : m_Frames)
     {
-        DestroySemaphore(AcquiredSemaphore);
+        CreateCommandPool(Frame.CommandPool, m_GraphicsQueue.FamilyIndex);
+
+        Frame.ThreadCommandPools.resize(m_Info.RecordingThreads);
+        for (auto& ThreadCommandPool : Frame.ThreadCommandPools)
+        {
+            CreateCommandPool(ThreadCommandPool, m_GraphicsQueue.FamilyIndex);
+        }
+
+        CreateCommandPool(Frame.ComputeCommandPool, m_ComputeQueue.FamilyIndex);
+        Frame.DescriptorAllocator.Init(m_Device);
     }
 
-    for (auto& RenderingDoneFence : m_RenderingDoneFences)
+    m_GpuProfiler.Init(m_PhysicalDevice, m_Device, m_GraphicsQueue.FamilyIndex,
+        NumFramesInFlight, m_Features12.hostQueryReset);
+
+    // A single timeline value per submission replaces the per-slot fences when available
+    if (m_Features12.timelineSemaphore)
+    {
+        m_GraphicsTimeline.Semaphore = CreateTimelineSemaphore();
+        m_ComputeTimeline.Semaphore = CreateTimelineSemaphore();
+    }
+    else
     {
-        DestroyFence(RenderingDoneFence);
+        for (auto& Frame : m_Frames)
+        {
+            Frame.RenderingDoneFence = CreateFence();
+        }
+    }
+
+    DEBUG_DISPLAY("Frames in flight: %u", NumFramesInFlight);
+    DEBUG_DISPLAY("Frame synchronization: %s",
+        UseTimelineSemaphores() ? "Timeline semaphore" : "Fences");
+
+    if (IsHeadless())
+    {
+        return;
+    }
+
+    for (auto& Frame : m_Frames)
+    {
+        Frame.AcquiredImageSemaphore = CreateSemaphore();
+    }
+
+    // Presentation waits on these, so they follow the swap chain image rather than the frame slot
+    m_RenderingDoneSemaphores.resize(m_BackBuffers.size());
+    for (uint32_t Index = 0; Index < m_RenderingDoneSemaphores.size(); ++Index)
+    {
+        m_RenderingDoneSemaphores[Index] = CreateSemaphore();
+    }
+}
+
+void VulkanApplication::DestroyFrames()
+{
+    for (auto& Frame : m_Frames)
+    {
+        DestroyCommandPool(Frame.CommandPool);
+
+        for (auto& ThreadCommandPool : Frame.ThreadCommandPools)
+        {
+            DestroyCommandPool(ThreadCommandPool);
+        }
+
+        DestroyCommandPool(Frame.ComputeCommandPool);
+        Frame.DescriptorAllocator.Destroy();
+        DestroyFence(Frame.RenderingDoneFence);
+        DestroySemaphore(Frame.AcquiredImageSemaphore);
     }
 
     for (auto& RenderingDoneSemaphore : m_RenderingDoneSemaphores)
     {
         DestroySemaphore(RenderingDoneSemaphore);
     }
+
+    DestroySemaphore(m_GraphicsTimeline.Semaphore);
+    DestroySemaphore(m_ComputeTimeline.Semaphore);
+    m_GpuProfiler.Destroy();
+
+    m_Frames.clear();
+    m_RenderingDoneSemaphores.clear();
 }
 
 bool VulkanApplication::AcquireImageIndex(uint32_t* OutImageIndex)
 {
-    m_ImageSemaphoreIndex = (m_ImageSemaphoreIndex + 1) % m_AcquiredImageSemaphores.size();
+    PROFILE_FUNCTION();
+
+    m_FrameIndex = (m_FrameIndex + 1) % m_Frames.size();
+
+    VulkanFrame& Frame = GetCurrentFrame();
+
+    // Wait for the previous submission of this slot before its objects are reused
+    WaitForValue(Frame.TimelineValue);
+    WaitForComputeValue(Frame.ComputeValue);
+    ResetCommandPool(Frame.CommandPool);
+    ResetCommandPool(Frame.ComputeCommandPool);
+    Frame.DescriptorAllocator.Reset();
+    Frame.Submitted = false;
+
+    for (auto& ThreadCommandPool : Frame.ThreadCommandPools)
+    {
+        ResetCommandPool(ThreadCommandPool);
+    }
+
+    // Timestamps of the frame that last used this slot are ready by now
+    m_GpuProfiler.BeginFrame(m_FrameIndex);
+
+    double GpuMilliseconds = m_GpuProfiler.GetFrameMilliseconds();
+    if (GpuMilliseconds >= 0.0)
+    {
+        m_FrameStatistics.AddGpuFrame(static_cast<float>(GpuMilliseconds));
+    }
 
-    VkResult Result = vkAcquireNextImageKHR(m_Device, m_SwapChain, UINT32_MAX,
-        m_AcquiredImageSemaphores[m_ImageSemaphoreIndex], nullptr, OutImageIndex);
+    // Swap in pipelines rebuilt in the background and recycle released bindless slots before this
+    // frame records anything
+    uint64_t GraphicsCompleted = GetCompletedValue();
+    uint64_t ComputeCompleted = GetCompletedComputeValue();
+    m_ShaderReloader.Update(m_GraphicsTimeline.SubmittedValue, GraphicsCompleted,
+        m_ComputeTimeline.SubmittedValue, ComputeCompleted);
+    m_BindlessTable.Update(m_GraphicsTimeline.SubmittedValue, GraphicsCompleted,
+        m_ComputeTimeline.SubmittedValue, ComputeCompleted);
+
+    if (IsHeadless())
+    {
+        m_ImageIndex = (m_ImageIndex + 1) % m_BackBuffers.size();
+        *OutImageIndex = m_ImageIndex;
+        return true;
+    }
+
+    VkResult Result = vkAcquireNextImageKHR(m_Device, m_SwapChain, UINT64_MAX,
+        Frame.AcquiredImageSemaphore, VK_NULL_HANDLE, OutImageIndex);
 
     if (Result == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -821,20 +1406,27 @@ bool VulkanApplication::AcquireImageIndex(uint32_t* OutImageIndex)
 
     CHECK(Result == VK_SUCCESS || Result == VK_SUBOPTIMAL_KHR, "Failed to acquire image");
 
-    m_CurrentFrameIndex = *OutImageIndex;
+    m_ImageIndex = *OutImageIndex;
 
     return true;
 }
 
 bool VulkanApplication::Present()
 {
+    PROFILE_FUNCTION();
+
+    if (IsHeadless())
+    {
+        return true;
+    }
+
     VkPresentInfoKHR PresentInfo = {};
     PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    PresentInfo.pImageIndices = &m_CurrentFrameIndex;
+    PresentInfo.pImageIndices = &m_ImageIndex;
     PresentInfo.swapchainCount = 1;
     PresentInfo.pSwapchains = &m_SwapChain;
     PresentInfo.waitSemaphoreCount = 1;
-    VkSemaphore WaitSemaphores[] = {m_RenderingDoneSemaphores[m_ImageSemaphoreIndex]};
+    VkSemaphore WaitSemaphores[] = {m_RenderingDoneSemaphores[m_ImageIndex]};
     PresentInfo.pWaitSemaphores = WaitSemaphores;
 
     VkResult Result = vkQueuePresentKHR(m_PresentQueue.Handle, &PresentInfo);
@@ -851,14 +1443,16 @@ bool VulkanApplication::Present()
 
 VkCommandBuffer VulkanApplication::BeginCommandBuffer()
 {
-    m_CommandBufferIndex = (m_CommandBufferIndex + 1) % m_CommandBuffers.size();
-
-    VkCommandBuffer CommandBuffer = m_CommandBuffers[m_CommandBufferIndex];
+    VkCommandBuffer CommandBuffer =
+        AllocateCommandBuffer(GetCurrentFrame().CommandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
     VkCommandBufferBeginInfo BeginInfo = {};
     BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
 
+    m_GpuProfiler.ResetQueries(CommandBuffer);
+
     return CommandBuffer;
 }
 
@@ -869,43 +1463,398 @@ void VulkanApplication::EndCommandBuffer(VkCommandBuffer& CommandBuffer)
 
 void VulkanApplication::Submit(VkCommandBuffer& CommandBuffer)
 {
+    Submit(&CommandBuffer, 1);
+}
+
+void VulkanApplication::Submit(const std::vector<VkCommandBuffer>& CommandBuffers)
+{
+    Submit(CommandBuffers.data(), static_cast<uint32_t>(CommandBuffers.size()));
+}
+
+void VulkanApplication::Submit(const VkCommandBuffer* CommandBuffers, uint32_t NumCommandBuffers)
+{
+    PROFILE_FUNCTION();
+
+    VulkanFrame& Frame = GetCurrentFrame();
+
+    // A second submit would wait on the acquire semaphore again with nothing left to signal it
+    DEBUG_ASSERT(!Frame.Submitted, "Submit called more than once for frame slot %u", m_FrameIndex);
+    Frame.Submitted = true;
+
+    VkSemaphore WaitSemaphores[MAX_SUBMIT_WAITS];
+    VkPipelineStageFlags WaitStages[MAX_SUBMIT_WAITS];
+    uint64_t WaitValues[MAX_SUBMIT_WAITS] = {};
+    uint32_t WaitCount = 0;
+
+    // Uploads issued while recording go out first, the frame waits for them on the GPU only
+    m_UploadManager.Flush();
+
+    if (uint64_t UploadValue = m_UploadManager.TakeGraphicsWaitValue())
+    {
+        AddGraphicsWait({m_UploadManager.GetTimelineSemaphore(), UploadValue,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT});
+    }
+
+    CHECK(m_PendingGraphicsWaits.size() < MAX_SUBMIT_WAITS, "Too many graphics queue waits");
+
+    for (auto& Wait : m_PendingGraphicsWaits)
+    {
+        WaitSemaphores[WaitCount] = Wait.Semaphore;
+        WaitValues[WaitCount] = Wait.Value;
+        WaitStages[WaitCount++] = Wait.Stages;
+    }
+
+    m_PendingGraphicsWaits.clear();
+
+    // Resources released by a dedicated transfer queue are acquired before any frame work
+    std::vector<VkCommandBuffer> AcquireAndCommandBuffers;
+    if (m_UploadManager.HasPendingAcquires())
+    {
+        VkCommandBuffer AcquireCommandBuffer = BeginCommandBuffer();
+        m_UploadManager.RecordAcquireBarriers(AcquireCommandBuffer);
+        EndCommandBuffer(AcquireCommandBuffer);
+
+        AcquireAndCommandBuffers.push_back(AcquireCommandBuffer);
+        AcquireAndCommandBuffers.insert(
+            AcquireAndCommandBuffers.end(), CommandBuffers, CommandBuffers + NumCommandBuffers);
+
+        CommandBuffers = AcquireAndCommandBuffers.data();
+        NumCommandBuffers = static_cast<uint32_t>(AcquireAndCommandBuffers.size());
+    }
+
+    VkSemaphore SignalSemaphores[2];
+    uint64_t SignalValues[2] = {0, 0};
+    uint32_t SignalCount = 0;
+
+    // Offscreen images are neither acquired nor presented, queue order is enough for them
+    if (!IsHeadless())
+    {
+        WaitSemaphores[WaitCount] = Frame.AcquiredImageSemaphore;
+        WaitStages[WaitCount++] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        SignalSemaphores[SignalCount++] = m_RenderingDoneSemaphores[m_ImageIndex];
+    }
+
+    Frame.TimelineValue = ++m_GraphicsTimeline.SubmittedValue;
+
+    VkFence Fence = VK_NULL_HANDLE;
+    if (UseTimelineSemaphores())
+    {
+        SignalSemaphores[SignalCount] = m_GraphicsTimeline.Semaphore;
+        SignalValues[SignalCount++] = Frame.TimelineValue;
+    }
+    else
+    {
+        // Reset only once the submit is certain, an early out in AcquireImageIndex must leave
+        // the fence untouched or the next wait on this slot would never return
+        Fence = Frame.RenderingDoneFence;
+        VULKAN_RESULT(vkResetFences(m_Device, 1, &Fence));
+    }
+
+    VkTimelineSemaphoreSubmitInfo TimelineInfo = {};
+    TimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    TimelineInfo.waitSemaphoreValueCount = WaitCount;
+    TimelineInfo.pWaitSemaphoreValues = WaitValues;
+    TimelineInfo.signalSemaphoreValueCount = SignalCount;
+    TimelineInfo.pSignalSemaphoreValues = SignalValues;
+
     VkSubmitInfo SubmitInfo = {};
     SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    SubmitInfo.commandBufferCount = 1;
-    SubmitInfo.pCommandBuffers = &CommandBuffer;
-    VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    SubmitInfo.pWaitDstStageMask = &waitStageMask;
-    VkSemaphore WaitSemaphores[] = {m_AcquiredImageSemaphores[m_ImageSemaphoreIndex]};
-    SubmitInfo.waitSemaphoreCount = 1;
+    SubmitInfo.pNext = UseTimelineSemaphores() ? &TimelineInfo : nullptr;
+    SubmitInfo.commandBufferCount = NumCommandBuffers;
+    SubmitInfo.pCommandBuffers = CommandBuffers;
+    SubmitInfo.waitSemaphoreCount = WaitCount;
     SubmitInfo.pWaitSemaphores = WaitSemaphores;
-    VkSemaphore SignalSemaphores[] = {m_RenderingDoneSemaphores[m_ImageSemaphoreIndex]};
-    SubmitInfo.signalSemaphoreCount = 1;
+    SubmitInfo.pWaitDstStageMask = WaitStages;
+    SubmitInfo.signalSemaphoreCount = SignalCount;
     SubmitInfo.pSignalSemaphores = SignalSemaphores;
 
-    VULKAN_RESULT(vkQueueSubmit(
-        m_GraphicsQueue.Handle, 1, &SubmitInfo, m_RenderingDoneFences[m_ImageSemaphoreIndex]));
-
-    vkWaitForFences(m_Device, 1, &m_RenderingDoneFences[m_ImageSemaphoreIndex], true, UINT32_MAX);
-    vkResetFences(m_Device, 1, &m_RenderingDoneFences[m_ImageSemaphoreIndex]);
+    VULKAN_RESULT(vkQueueSubmit(m_GraphicsQueue.Handle, 1, &SubmitInfo, Fence));
 }
 
-void VulkanApplication::BeginRenderPass(VkCommandBuffer& CommandBuffer)
+void VulkanApplication::BeginRenderPass(VkCommandBuffer& CommandBuffer, VkSubpassContents Contents)
 {
+    if (m_DynamicRendering)
+    {
+        // Same dependency as the render pass, chained to the image acquire wait
+        VkImageMemoryBarrier Barrier = {};
+        Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        Barrier.srcAccessMask = 0;
+        Barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        Barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        Barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.image = m_BackBuffers[m_ImageIndex].Image;
+        Barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 1,
+            &Barrier);
+
+        VkRenderingAttachmentInfoKHR ColorAttachment = {};
+        ColorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        ColorAttachment.imageView = m_BackBuffers[m_ImageIndex].ImageView;
+        ColorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        ColorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        ColorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        ColorAttachment.clearValue = {0.5f, 0.55f, 0.6f, 1.0f};
+
+        VkRenderingInfoKHR RenderingInfo = {};
+        RenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        RenderingInfo.flags = Contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                  ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR
+                                  : 0;
+        RenderingInfo.renderArea.extent.width = m_Info.WindowWidth;
+        RenderingInfo.renderArea.extent.height = m_Info.WindowHeight;
+        RenderingInfo.layerCount = 1;
+        RenderingInfo.colorAttachmentCount = 1;
+        RenderingInfo.pColorAttachments = &ColorAttachment;
+        m_CmdBeginRendering(CommandBuffer, &RenderingInfo);
+        return;
+    }
+
     VkRenderPassBeginInfo BeginInfo = {};
     BeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     BeginInfo.clearValueCount = 1;
     VkClearValue ClearValue = {0.5f, 0.55f, 0.6f, 1.0f};
     BeginInfo.pClearValues = &ClearValue;
-    BeginInfo.framebuffer = m_FrameBuffers[m_CurrentFrameIndex];
+    BeginInfo.framebuffer = m_FrameBuffers[m_ImageIndex];
     BeginInfo.renderArea.offset.x = 0;
     BeginInfo.renderArea.offset.y = 0;
     BeginInfo.renderArea.extent.width = m_Info.WindowWidth;
     BeginInfo.renderArea.extent.height = m_Info.WindowHeight;
     BeginInfo.renderPass = m_RenderPass;
-    vkCmdBeginRenderPass(CommandBuffer, &BeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(CommandBuffer, &BeginInfo, Contents);
 }
 
 void VulkanApplication::EndRenderPass(VkCommandBuffer& CommandBuffer)
 {
-    vkCmdEndRenderPass(CommandBuffer);
+    if (!m_DynamicRendering)
+    {
+        vkCmdEndRenderPass(CommandBuffer);
+        return;
+    }
+
+    m_CmdEndRendering(CommandBuffer);
+
+    // The final layout transition the render pass would have done
+    VkImageMemoryBarrier Barrier = {};
+    Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    Barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    Barrier.dstAccessMask = 0;
+    Barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    Barrier.newLayout =
+        IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier.image = m_BackBuffers[m_ImageIndex].Image;
+    Barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &Barrier);
+}
+
+VkCommandBuffer VulkanApplication::BeginSecondaryCommandBuffer(uint32_t ThreadIndex)
+{
+    VulkanFrame& Frame = GetCurrentFrame();
+
+    DEBUG_ASSERT(ThreadIndex < Frame.ThreadCommandPools.size(), "Invalid recording thread");
+
+    VkCommandBuffer CommandBuffer = AllocateCommandBuffer(
+        Frame.ThreadCommandPools[ThreadIndex], VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+
+    VkCommandBufferInheritanceRenderingInfoKHR InheritanceRenderingInfo = {};
+    InheritanceRenderingInfo.sType =
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+    InheritanceRenderingInfo.colorAttachmentCount = 1;
+    InheritanceRenderingInfo.pColorAttachmentFormats = &m_BackBuffers[m_ImageIndex].Format;
+    InheritanceRenderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkCommandBufferInheritanceInfo InheritanceInfo = {};
+    InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+    if (m_DynamicRendering)
+    {
+        InheritanceInfo.pNext = &InheritanceRenderingInfo;
+    }
+    else
+    {
+        InheritanceInfo.renderPass = m_RenderPass;
+        InheritanceInfo.subpass = 0;
+        InheritanceInfo.framebuffer = m_FrameBuffers[m_ImageIndex];
+    }
+
+    VkCommandBufferBeginInfo BeginInfo = {};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                      VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    BeginInfo.pInheritanceInfo = &InheritanceInfo;
+    vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
+
+    return CommandBuffer;
+}
+
+void VulkanApplication::ExecuteCommandBuffers(
+    VkCommandBuffer& CommandBuffer, const std::vector<VkCommandBuffer>& SecondaryCommandBuffers)
+{
+    if (SecondaryCommandBuffers.empty())
+    {
+        return;
+    }
+
+    vkCmdExecuteCommands(CommandBuffer, static_cast<uint32_t>(SecondaryCommandBuffers.size()),
+        SecondaryCommandBuffers.data());
+}
+
+VkCommandBuffer VulkanApplication::BeginComputeCommandBuffer()
+{
+    VkCommandBuffer CommandBuffer = AllocateCommandBuffer(
+        GetCurrentFrame().ComputeCommandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+    VkCommandBufferBeginInfo BeginInfo = {};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
+
+    return CommandBuffer;
+}
+
+uint64_t VulkanApplication::SubmitCompute(const VkCommandBuffer* CommandBuffers,
+    uint32_t NumCommandBuffers, const std::vector<VulkanSemaphoreWait>& Waits)
+{
+    VkSubmitInfo SubmitInfo = {};
+    SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.commandBufferCount = NumCommandBuffers;
+    SubmitInfo.pCommandBuffers = CommandBuffers;
+
+    // Without timelines the compute queue is the graphics queue, submission order is the only
+    // dependency and the work retires together with the next graphics submission
+    if (!UseTimelineSemaphores())
+    {
+        VULKAN_RESULT(vkQueueSubmit(m_ComputeQueue.Handle, 1, &SubmitInfo, VK_NULL_HANDLE));
+        return m_GraphicsTimeline.SubmittedValue + 1;
+    }
+
+    CHECK(Waits.size() <= MAX_SUBMIT_WAITS, "Too many compute queue waits");
+
+    VkSemaphore WaitSemaphores[MAX_SUBMIT_WAITS];
+    VkPipelineStageFlags WaitStages[MAX_SUBMIT_WAITS];
+    uint64_t WaitValues[MAX_SUBMIT_WAITS];
+    uint32_t WaitCount = 0;
+
+    for (auto& Wait : Waits)
+    {
+        WaitSemaphores[WaitCount] = Wait.Semaphore;
+        WaitValues[WaitCount] = Wait.Value;
+        WaitStages[WaitCount++] = Wait.Stages;
+    }
+
+    VulkanFrame& Frame = GetCurrentFrame();
+    Frame.ComputeValue = ++m_ComputeTimeline.SubmittedValue;
+
+    VkTimelineSemaphoreSubmitInfo TimelineInfo = {};
+    TimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    TimelineInfo.waitSemaphoreValueCount = WaitCount;
+    TimelineInfo.pWaitSemaphoreValues = WaitValues;
+    TimelineInfo.signalSemaphoreValueCount = 1;
+    TimelineInfo.pSignalSemaphoreValues = &Frame.ComputeValue;
+
+    SubmitInfo.pNext = &TimelineInfo;
+    SubmitInfo.waitSemaphoreCount = WaitCount;
+    SubmitInfo.pWaitSemaphores = WaitSemaphores;
+    SubmitInfo.pWaitDstStageMask = WaitStages;
+    SubmitInfo.signalSemaphoreCount = 1;
+    SubmitInfo.pSignalSemaphores = &m_ComputeTimeline.Semaphore;
+
+    VULKAN_RESULT(vkQueueSubmit(m_ComputeQueue.Handle, 1, &SubmitInfo, VK_NULL_HANDLE));
+
+    return Frame.ComputeValue;
+}
+
+VulkanSemaphoreWait VulkanApplication::GetGraphicsWait(
+    uint64_t Value, VkPipelineStageFlags Stages) const
+{
+    return {m_GraphicsTimeline.Semaphore, Value, Stages};
+}
+
+VulkanSemaphoreWait VulkanApplication::GetComputeWait(
+    uint64_t Value, VkPipelineStageFlags Stages) const
+{
+    return {m_ComputeTimeline.Semaphore, Value, Stages};
+}
+
+void VulkanApplication::AddGraphicsWait(const VulkanSemaphoreWait& Wait)
+{
+    // Fence mode has no semaphores to wait on, the queues are one and the same there
+    if (Wait.Semaphore)
+    {
+        m_PendingGraphicsWaits.push_back(Wait);
+    }
+}
+
+void VulkanApplication::ReleaseOwnership(
+    VkCommandBuffer CommandBuffer, const VulkanOwnershipTransfer& Transfer)
+{
+    // Within one family the acquire alone is a regular barrier
+    if (Transfer.SourceFamilyIndex == Transfer.DestinationFamilyIndex)
+    {
+        return;
+    }
+
+    VkBufferMemoryBarrier BufferBarrier = {};
+    BufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    BufferBarrier.srcAccessMask = Transfer.SourceAccess;
+    BufferBarrier.srcQueueFamilyIndex = Transfer.SourceFamilyIndex;
+    BufferBarrier.dstQueueFamilyIndex = Transfer.DestinationFamilyIndex;
+    BufferBarrier.buffer = Transfer.Buffer;
+    BufferBarrier.size = VK_WHOLE_SIZE;
+
+    VkImageMemoryBarrier ImageBarrier = {};
+    ImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    ImageBarrier.srcAccessMask = Transfer.SourceAccess;
+    ImageBarrier.oldLayout = Transfer.OldLayout;
+    ImageBarrier.newLayout = Transfer.NewLayout;
+    ImageBarrier.srcQueueFamilyIndex = Transfer.SourceFamilyIndex;
+    ImageBarrier.dstQueueFamilyIndex = Transfer.DestinationFamilyIndex;
+    ImageBarrier.image = Transfer.Image;
+    ImageBarrier.subresourceRange = Transfer.SubresourceRange;
+
+    vkCmdPipelineBarrier(CommandBuffer, Transfer.SourceStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0, 0, nullptr, Transfer.Buffer ? 1 : 0, &BufferBarrier, Transfer.Image ? 1 : 0,
+        &ImageBarrier);
+}
+
+void VulkanApplication::AcquireOwnership(
+    VkCommandBuffer CommandBuffer, const VulkanOwnershipTransfer& Transfer)
+{
+    bool SameFamily = Transfer.SourceFamilyIndex == Transfer.DestinationFamilyIndex;
+
+    // The semaphore wait covers the source side of a real transfer
+    VkPipelineStageFlags SourceStages =
+        SameFamily ? Transfer.SourceStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    VkAccessFlags SourceAccess = SameFamily ? Transfer.SourceAccess : 0;
+    uint32_t SourceFamilyIndex = SameFamily ? VK_QUEUE_FAMILY_IGNORED : Transfer.SourceFamilyIndex;
+    uint32_t DestinationFamilyIndex =
+        SameFamily ? VK_QUEUE_FAMILY_IGNORED : Transfer.DestinationFamilyIndex;
+
+    VkBufferMemoryBarrier BufferBarrier = {};
+    BufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    BufferBarrier.srcAccessMask = SourceAccess;
+    BufferBarrier.dstAccessMask = Transfer.DestinationAccess;
+    BufferBarrier.srcQueueFamilyIndex = SourceFamilyIndex;
+    BufferBarrier.dstQueueFamilyIndex = DestinationFamilyIndex;
+    BufferBarrier.buffer = Transfer.Buffer;
+    BufferBarrier.size = VK_WHOLE_SIZE;
+
+    VkImageMemoryBarrier ImageBarrier = {};
+    ImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    ImageBarrier.srcAccessMask = SourceAccess;
+    ImageBarrier.dstAccessMask = Transfer.DestinationAccess;
+    ImageBarrier.oldLayout = Transfer.OldLayout;
+    ImageBarrier.newLayout = Transfer.NewLayout;
+    ImageBarrier.srcQueueFamilyIndex = SourceFamilyIndex;
+    ImageBarrier.dstQueueFamilyIndex = DestinationFamilyIndex;
+    ImageBarrier.image = Transfer.Image;
+    ImageBarrier.subresourceRange = Transfer.SubresourceRange;
+
+    vkCmdPipelineBarrier(CommandBuffer, SourceStages, Transfer.DestinationStages, 0, 0, nullptr,
+        Transfer.Buffer ? 1 : 0, &BufferBarrier, Transfer.Image ? 1 : 0, &ImageBarrier);
 }
\ No newline at end of file
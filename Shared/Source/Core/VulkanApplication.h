@@ -1,8 +1,17 @@
 #pragma once
 #include "Application.h"
+#include "JobSystem.h"
+#include "ShaderCompiler.h"
+#include "ShaderReloader.h"
+#include "VulkanDescriptorAllocator.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanUploadManager.h"
 #include "pch.h"
 
 #define NUM_BACKBUFFERS 3
+#define MAX_SUBMIT_WAITS 8
 
 struct VulkanQueue
 {
@@ -10,12 +19,76 @@ struct VulkanQueue
     VkQueue Handle = VK_NULL_HANDLE;
 };
 
+struct VulkanTimeline
+{
+    VkSemaphore Semaphore = VK_NULL_HANDLE;
+    uint64_t SubmittedValue = 0;
+    uint64_t CompletedValue = 0;
+};
+
+struct VulkanSemaphoreWait
+{
+    VkSemaphore Semaphore = VK_NULL_HANDLE;
+    uint64_t Value = 0;
+    VkPipelineStageFlags Stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+};
+
+// Both halves of a queue family ownership transfer, the release is recorded on the source queue
+// and the acquire on the destination queue after a semaphore wait on the release submission
+struct VulkanOwnershipTransfer
+{
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    VkImage Image = VK_NULL_HANDLE;
+    VkImageSubresourceRange SubresourceRange = {
+        VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+    VkImageLayout OldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    VkImageLayout NewLayout = VK_IMAGE_LAYOUT_GENERAL;
+    uint32_t SourceFamilyIndex;
+    uint32_t DestinationFamilyIndex;
+    VkPipelineStageFlags SourceStages;
+    VkAccessFlags SourceAccess;
+    VkPipelineStageFlags DestinationStages;
+    VkAccessFlags DestinationAccess;
+};
+
+struct VulkanCommandPool
+{
+    VkCommandPool Handle = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> PrimaryCommandBuffers;
+    std::vector<VkCommandBuffer> SecondaryCommandBuffers;
+    uint32_t NumUsedPrimaryCommandBuffers = 0;
+    uint32_t NumUsedSecondaryCommandBuffers = 0;
+};
+
+struct VulkanFrame
+{
+    VulkanCommandPool CommandPool;
+    std::vector<VulkanCommandPool> ThreadCommandPools;
+    VulkanCommandPool ComputeCommandPool;
+    VulkanDescriptorAllocator DescriptorAllocator;
+    VkFence RenderingDoneFence = VK_NULL_HANDLE;
+    VkSemaphore AcquiredImageSemaphore = VK_NULL_HANDLE;
+    uint64_t TimelineValue = 0;
+    uint64_t ComputeValue = 0;
+    // Set by Submit, cleared when AcquireImageIndex hands the slot out again
+    bool Submitted = false;
+};
+
 struct VulkanBackBuffer
 {
     VkFormat Format;
     uint32_t Width;
     uint32_t Height;
+    VkImage Image = VK_NULL_HANDLE;
     VkImageView ImageView = VK_NULL_HANDLE;
+    VulkanAllocation Allocation;
+};
+
+struct VulkanBuffer
+{
+    VkBuffer Handle = VK_NULL_HANDLE;
+    VkDeviceSize Size = 0;
+    VulkanAllocation Allocation;
 };
 
 class VulkanApplication : public Application
@@ -47,54 +120,112 @@ protected:
     void CreateSwapChain(VkFormat Format, uint32_t Width, uint32_t Height, uint32_t NumBackBuffers);
     void DestroySwapChain();
     void CreateBackBuffers(VkFormat Format, uint32_t Width, uint32_t Height);
+    void CreateOffscreenBackBuffers(
+        VkFormat Format, uint32_t Width, uint32_t Height, uint32_t NumBackBuffers);
     void DestroyBackBuffers();
+    VulkanBuffer CreateBuffer(VkDeviceSize Size, VkBufferUsageFlags Usage,
+        VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Preferred = 0);
+    void DestroyBuffer(VulkanBuffer& Buffer);
+    std::vector<std::unique_ptr<ShaderBinary>> CompileShaders(const std::vector<ShaderDesc>& Descs);
+    VkShaderModule CreateShaderModule(const ShaderBinary& Binary);
+    void DestroyShaderModule(VkShaderModule& ShaderModule);
+    VkPipeline CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& PipelineInfo);
+    VkPipeline CreateComputePipeline(const VkComputePipelineCreateInfo& PipelineInfo);
+    void DestroyPipeline(VkPipeline& Pipeline);
+    ReloadablePipeline* CreateReloadablePipeline(
+        const std::vector<ShaderDesc>& Shaders, const PipelineBuildFunction& Build);
+    void DestroyReloadablePipeline(ReloadablePipeline*& Pipeline);
+    VkDescriptorSet AllocateDescriptorSet(VkDescriptorSetLayout Layout);
+    bool UseBindlessDescriptors() const { return m_BindlessTable.IsInitialized(); }
+    bool UseDynamicRendering() const { return m_DynamicRendering; }
     VkImageView CreateImageView(VkImageViewType Type, VkFormat Format, VkImage Image);
     void CreateRenderPass(VulkanBackBuffer& ColorBuffer);
     void DestroyRenderPass();
     VkFramebuffer CreateFrameBuffer(VulkanBackBuffer& BackBuffer);
     void CreateFrameBuffers();
     void DestroyFrameBuffer(VkFramebuffer& FrameBuffer);
-    void CreateCommandPool();
-    void DestroyCommandPool();
-    VkCommandBuffer CreateCommandBuffer();
-    void DestroyCommandBuffer();
+    void CreateCommandPool(VulkanCommandPool& CommandPool, uint32_t FamilyIndex);
+    void ResetCommandPool(VulkanCommandPool& CommandPool);
+    void DestroyCommandPool(VulkanCommandPool& CommandPool);
+    VkCommandBuffer AllocateCommandBuffer(
+        VulkanCommandPool& CommandPool, VkCommandBufferLevel Level);
     VkFence CreateFence(bool Signaled = false);
     void DestroyFence(VkFence& Fence);
     VkSemaphore CreateSemaphore();
+    VkSemaphore CreateTimelineSemaphore(uint64_t InitialValue = 0);
     void DestroySemaphore(VkSemaphore& Semaphore);
-    void CreateSyncObjects();
-    void DestroySyncObjects();
+    bool UseTimelineSemaphores() const { return m_GraphicsTimeline.Semaphore != VK_NULL_HANDLE; }
+    uint64_t GetSubmittedValue() const { return m_GraphicsTimeline.SubmittedValue; }
+    uint64_t GetCompletedValue();
+    bool IsValueRetired(uint64_t Value);
+    void WaitForValue(uint64_t Value);
+    void WaitForTimeline(VulkanTimeline& Timeline, uint64_t Value);
+    uint64_t GetCompletedComputeValue();
+    void WaitForComputeValue(uint64_t Value);
+    void CreateFrames(uint32_t NumFramesInFlight);
+    void DestroyFrames();
+    VulkanFrame& GetCurrentFrame() { return m_Frames[m_FrameIndex]; }
 
     bool AcquireImageIndex(uint32_t* OutImageIndex);
     bool Present();
     VkCommandBuffer BeginCommandBuffer();
     void EndCommandBuffer(VkCommandBuffer& CommandBuffer);
+    // Exactly once per AcquireImageIndex that returned true, the submit waits on the acquired image
+    // and, without timeline semaphores, resets and signals the fence of the frame slot
     void Submit(VkCommandBuffer& CommandBuffer);
-    void BeginRenderPass(VkCommandBuffer& CommandBuffer);
+    void Submit(const std::vector<VkCommandBuffer>& CommandBuffers);
+    void Submit(const VkCommandBuffer* CommandBuffers, uint32_t NumCommandBuffers);
+    // Renders into the current back buffer, with dynamic rendering when it is enabled
+    void BeginRenderPass(
+        VkCommandBuffer& CommandBuffer, VkSubpassContents Contents = VK_SUBPASS_CONTENTS_INLINE);
     void EndRenderPass(VkCommandBuffer& CommandBuffer);
+    VkCommandBuffer BeginSecondaryCommandBuffer(uint32_t ThreadIndex);
+    VkCommandBuffer BeginComputeCommandBuffer();
+    uint64_t SubmitCompute(const VkCommandBuffer* CommandBuffers, uint32_t NumCommandBuffers,
+        const std::vector<VulkanSemaphoreWait>& Waits = {});
+    VulkanSemaphoreWait GetGraphicsWait(uint64_t Value, VkPipelineStageFlags Stages) const;
+    VulkanSemaphoreWait GetComputeWait(uint64_t Value, VkPipelineStageFlags Stages) const;
+    void AddGraphicsWait(const VulkanSemaphoreWait& Wait);
+    void ReleaseOwnership(VkCommandBuffer CommandBuffer, const VulkanOwnershipTransfer& Transfer);
+    void AcquireOwnership(VkCommandBuffer CommandBuffer, const VulkanOwnershipTransfer& Transfer);
+    void ExecuteCommandBuffers(VkCommandBuffer& CommandBuffer,
+        const std::vector<VkCommandBuffer>& SecondaryCommandBuffers);
 
     static VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT MessageSeverity,
         VkDebugUtilsMessageTypeFlagsEXT MessageType,
         const VkDebugUtilsMessengerCallbackDataEXT* CallbackDataPtr, void* UserDataPtr);
 
+    JobSystem m_JobSystem;
+    ShaderCompiler m_ShaderCompiler;
     VkInstance m_Instance;
     VkDebugUtilsMessengerEXT m_DebugMessenger;
     VkPhysicalDevice m_PhysicalDevice;
     VkDevice m_Device;
     VulkanQueue m_GraphicsQueue;
+    VulkanQueue m_TransferQueue;
+    VulkanQueue m_ComputeQueue;
+    VulkanTimeline m_GraphicsTimeline;
+    VulkanTimeline m_ComputeTimeline;
+    std::vector<VulkanSemaphoreWait> m_PendingGraphicsWaits;
+    VkPhysicalDeviceVulkan12Features m_Features12;
+    VulkanMemoryAllocator m_MemoryAllocator;
+    VulkanUploadManager m_UploadManager;
+    VulkanPipelineCache m_PipelineCache;
+    ShaderReloader m_ShaderReloader;
+    VulkanBindlessTable m_BindlessTable;
+    VulkanGpuProfiler m_GpuProfiler;
+    bool m_PipelineCreationFeedback;
+    bool m_DynamicRendering;
+    PFN_vkCmdBeginRenderingKHR m_CmdBeginRendering;
+    PFN_vkCmdEndRenderingKHR m_CmdEndRendering;
     VkSurfaceKHR m_Surface;
     VulkanQueue m_PresentQueue;
     VkSwapchainKHR m_SwapChain;
     std::vector<VulkanBackBuffer> m_BackBuffers;
     VkRenderPass m_RenderPass;
     std::vector<VkFramebuffer> m_FrameBuffers;
-    VkCommandPool m_CommandPool;
-    std::vector<VkCommandBuffer> m_CommandBuffers;
-    std::vector<VkFence> m_AcquiredImageFences;
-    std::vector<VkSemaphore> m_AcquiredImageSemaphores;
-    std::vector<VkFence> m_RenderingDoneFences;
+    std::vector<VulkanFrame> m_Frames;
     std::vector<VkSemaphore> m_RenderingDoneSemaphores;
-    uint32_t m_CurrentFrameIndex;
-    uint32_t m_ImageSemaphoreIndex;
-    uint32_t m_CommandBufferIndex;
+    uint32_t m_FrameIndex;
+    uint32_t m_ImageIndex;
 };
\ No newline at end of file
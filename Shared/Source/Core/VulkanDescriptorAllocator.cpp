@@ -0,0 +1,421 @@
+#include "VulkanDescriptorAllocator.h"
+#include "VulkanUtility.h"
+
+// Descriptors reserved per set in every pool, a set asking for more of one type than its pool
+// still holds moves on to the next pool
+static const std::pair<VkDescriptorType, float> DescriptorPoolRatios[] = {
+    {VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f},
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+    {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 4.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f},
+    {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f},
+};
+
+VulkanDescriptorAllocator::VulkanDescriptorAllocator()
+    : m_Device(VK_NULL_HANDLE),
+      m_CurrentPool(VK_NULL_HANDLE),
+      m_SetsPerPool(DESCRIPTOR_POOL_INITIAL_SETS),
+      m_NumAllocated(0)
+{
+}
+
+void VulkanDescriptorAllocator::Init(VkDevice Device, uint32_t SetsPerPool)
+{
+    m_Device = Device;
+    m_SetsPerPool = SetsPerPool;
+    m_NumAllocated = 0;
+}
+
+void VulkanDescriptorAllocator::Destroy()
+{
+    Reset();
+
+    for (VkDescriptorPool Pool : m_FreePools)
+    {
+        vkDestroyDescriptorPool(m_Device, Pool, nullptr);
+    }
+
+    m_FreePools.clear();
+    m_Device = VK_NULL_HANDLE;
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::Allocate(VkDescriptorSetLayout Layout)
+{
+    DEBUG_ASSERT(m_Device);
+
+    if (!m_CurrentPool)
+    {
+        m_CurrentPool = GrabPool();
+    }
+
+    VkDescriptorSetAllocateInfo AllocateInfo = {};
+    AllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    AllocateInfo.descriptorPool = m_CurrentPool;
+    AllocateInfo.descriptorSetCount = 1;
+    AllocateInfo.pSetLayouts = &Layout;
+
+    VkDescriptorSet Set = VK_NULL_HANDLE;
+    VkResult Result = vkAllocateDescriptorSets(m_Device, &AllocateInfo, &Set);
+
+    if (Result == VK_ERROR_OUT_OF_POOL_MEMORY || Result == VK_ERROR_FRAGMENTED_POOL)
+    {
+        m_FullPools.push_back(m_CurrentPool);
+        m_CurrentPool = GrabPool();
+
+        AllocateInfo.descriptorPool = m_CurrentPool;
+        Result = vkAllocateDescriptorSets(m_Device, &AllocateInfo, &Set);
+    }
+
+    CHECK(Result == VK_SUCCESS, "Failed to allocate descriptor set (%d)", Result);
+
+    m_NumAllocated++;
+    return Set;
+}
+
+void VulkanDescriptorAllocator::Reset()
+{
+    if (m_CurrentPool)
+    {
+        m_FullPools.push_back(m_CurrentPool);
+        m_CurrentPool = VK_NULL_HANDLE;
+    }
+
+    for (VkDescriptorPool Pool : m_FullPools)
+    {
+        VULKAN_RESULT(vkResetDescriptorPool(m_Device, Pool, 0));
+        m_FreePools.push_back(Pool);
+    }
+
+    m_FullPools.clear();
+    m_NumAllocated = 0;
+}
+
+uint32_t VulkanDescriptorAllocator::GetNumPools() const
+{
+    return static_cast<uint32_t>(m_FullPools.size() + m_FreePools.size()) + (m_CurrentPool ? 1 : 0);
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::GrabPool()
+{
+    if (!m_FreePools.empty())
+    {
+        VkDescriptorPool Pool = m_FreePools.back();
+        m_FreePools.pop_back();
+        return Pool;
+    }
+
+    std::vector<VkDescriptorPoolSize> PoolSizes;
+    for (auto& [Type, Ratio] : DescriptorPoolRatios)
+    {
+        uint32_t Count = static_cast<uint32_t>(Ratio * m_SetsPerPool);
+        PoolSizes.push_back({Type, std::max(Count, 1u)});
+    }
+
+    VkDescriptorPoolCreateInfo PoolInfo = {};
+    PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    PoolInfo.maxSets = m_SetsPerPool;
+    PoolInfo.poolSizeCount = static_cast<uint32_t>(PoolSizes.size());
+    PoolInfo.pPoolSizes = PoolSizes.data();
+
+    VkDescriptorPool Pool = VK_NULL_HANDLE;
+    VULKAN_RESULT(vkCreateDescriptorPool(m_Device, &PoolInfo, nullptr, &Pool));
+
+    DEBUG_INFO("Descriptor pool %u created (%u sets)", GetNumPools() + 1, m_SetsPerPool);
+
+    // Frames that needed more than one pool are likely to need it again, grow geometrically
+    m_SetsPerPool = std::min(m_SetsPerPool * 2, static_cast<uint32_t>(DESCRIPTOR_POOL_MAX_SETS));
+
+    return Pool;
+}
+
+VulkanBindlessTable::VulkanBindlessTable()
+    : m_Device(VK_NULL_HANDLE),
+      m_SetLayout(VK_NULL_HANDLE),
+      m_PipelineLayout(VK_NULL_HANDLE),
+      m_Pool(VK_NULL_HANDLE),
+      m_Set(VK_NULL_HANDLE)
+{
+}
+
+void VulkanBindlessTable::Init(VkPhysicalDevice PhysicalDevice, VkDevice Device)
+{
+    m_Device = Device;
+
+    VkPhysicalDeviceVulkan12Properties Properties12 = {};
+    Properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 Properties = {};
+    Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    Properties.pNext = &Properties12;
+    vkGetPhysicalDeviceProperties2(PhysicalDevice, &Properties);
+
+    m_Bindings[BINDLESS_TEXTURE_BINDING].Type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    m_Bindings[BINDLESS_TEXTURE_BINDING].Capacity = std::min({BINDLESS_MAX_TEXTURES,
+        Properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+        Properties12.maxDescriptorSetUpdateAfterBindSampledImages});
+
+    m_Bindings[BINDLESS_BUFFER_BINDING].Type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    m_Bindings[BINDLESS_BUFFER_BINDING].Capacity = std::min({BINDLESS_MAX_BUFFERS,
+        Properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+        Properties12.maxDescriptorSetUpdateAfterBindStorageBuffers});
+
+    m_Bindings[BINDLESS_SAMPLER_BINDING].Type = VK_DESCRIPTOR_TYPE_SAMPLER;
+    m_Bindings[BINDLESS_SAMPLER_BINDING].Capacity = std::min({BINDLESS_MAX_SAMPLERS,
+        Properties12.maxPerStageDescriptorUpdateAfterBindSamplers,
+        Properties12.maxDescriptorSetUpdateAfterBindSamplers});
+
+    // The three arrays also share a per stage budget, the texture array gives way first
+    uint32_t MaxResources = Properties12.maxPerStageUpdateAfterBindResources;
+    uint32_t OtherResources = m_Bindings[BINDLESS_BUFFER_BINDING].Capacity +
+                              m_Bindings[BINDLESS_SAMPLER_BINDING].Capacity;
+    CHECK(OtherResources < MaxResources, "Bindless limits too low");
+    m_Bindings[BINDLESS_TEXTURE_BINDING].Capacity =
+        std::min(m_Bindings[BINDLESS_TEXTURE_BINDING].Capacity, MaxResources - OtherResources);
+
+    std::array<VkDescriptorSetLayoutBinding, BINDLESS_NUM_BINDINGS> LayoutBindings = {};
+    std::array<VkDescriptorBindingFlags, BINDLESS_NUM_BINDINGS> BindingFlags = {};
+    std::array<VkDescriptorPoolSize, BINDLESS_NUM_BINDINGS> PoolSizes = {};
+
+    for (uint32_t Index = 0; Index < BINDLESS_NUM_BINDINGS; ++Index)
+    {
+        LayoutBindings[Index].binding = Index;
+        LayoutBindings[Index].descriptorType = m_Bindings[Index].Type;
+        LayoutBindings[Index].descriptorCount = m_Bindings[Index].Capacity;
+        LayoutBindings[Index].stageFlags = VK_SHADER_STAGE_ALL;
+
+        // Slots can be written while the set is bound and while other slots are in use
+        BindingFlags[Index] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                              VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                              VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+        PoolSizes[Index] = {m_Bindings[Index].Type, m_Bindings[Index].Capacity};
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo BindingFlagsInfo = {};
+    BindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    BindingFlagsInfo.bindingCount = BINDLESS_NUM_BINDINGS;
+    BindingFlagsInfo.pBindingFlags = BindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo LayoutInfo = {};
+    LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    LayoutInfo.pNext = &BindingFlagsInfo;
+    LayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    LayoutInfo.bindingCount = BINDLESS_NUM_BINDINGS;
+    LayoutInfo.pBindings = LayoutBindings.data();
+    VULKAN_RESULT(vkCreateDescriptorSetLayout(m_Device, &LayoutInfo, nullptr, &m_SetLayout));
+
+    VkPushConstantRange PushConstantRange = {};
+    PushConstantRange.stageFlags = VK_SHADER_STAGE_ALL;
+    PushConstantRange.size = BINDLESS_PUSH_CONSTANT_SIZE;
+
+    VkPipelineLayoutCreateInfo PipelineLayoutInfo = {};
+    PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    PipelineLayoutInfo.setLayoutCount = 1;
+    PipelineLayoutInfo.pSetLayouts = &m_SetLayout;
+    PipelineLayoutInfo.pushConstantRangeCount = 1;
+    PipelineLayoutInfo.pPushConstantRanges = &PushConstantRange;
+    VULKAN_RESULT(
+        vkCreatePipelineLayout(m_Device, &PipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+    VkDescriptorPoolCreateInfo PoolInfo = {};
+    PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    PoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    PoolInfo.maxSets = 1;
+    PoolInfo.poolSizeCount = BINDLESS_NUM_BINDINGS;
+    PoolInfo.pPoolSizes = PoolSizes.data();
+    VULKAN_RESULT(vkCreateDescriptorPool(m_Device, &PoolInfo, nullptr, &m_Pool));
+
+    VkDescriptorSetAllocateInfo AllocateInfo = {};
+    AllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    AllocateInfo.descriptorPool = m_Pool;
+    AllocateInfo.descriptorSetCount = 1;
+    AllocateInfo.pSetLayouts = &m_SetLayout;
+    VULKAN_RESULT(vkAllocateDescriptorSets(m_Device, &AllocateInfo, &m_Set));
+
+    DEBUG_DISPLAY("Bindless descriptors: %u textures, %u buffers, %u samplers",
+        m_Bindings[BINDLESS_TEXTURE_BINDING].Capacity, m_Bindings[BINDLESS_BUFFER_BINDING].Capacity,
+        m_Bindings[BINDLESS_SAMPLER_BINDING].Capacity);
+}
+
+void VulkanBindlessTable::Destroy()
+{
+    if (m_Pool)
+    {
+        vkDestroyDescriptorPool(m_Device, m_Pool, nullptr);
+        m_Pool = VK_NULL_HANDLE;
+        m_Set = VK_NULL_HANDLE;
+    }
+
+    if (m_PipelineLayout)
+    {
+        vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+        m_PipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_SetLayout)
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_SetLayout, nullptr);
+        m_SetLayout = VK_NULL_HANDLE;
+    }
+
+    m_Bindings = {};
+    m_UnfencedSlots.clear();
+    m_RetiredSlots.clear();
+}
+
+bool VulkanBindlessTable::IsSupported(const VkPhysicalDeviceVulkan12Features& Features)
+{
+    return Features.runtimeDescriptorArray && Features.descriptorBindingPartiallyBound &&
+           Features.descriptorBindingUpdateUnusedWhilePending &&
+           Features.descriptorBindingSampledImageUpdateAfterBind &&
+           Features.descriptorBindingStorageBufferUpdateAfterBind &&
+           Features.shaderSampledImageArrayNonUniformIndexing &&
+           Features.shaderStorageBufferArrayNonUniformIndexing;
+}
+
+void VulkanBindlessTable::EnableFeatures(VkPhysicalDeviceVulkan12Features& Features)
+{
+    Features.runtimeDescriptorArray = VK_TRUE;
+    Features.descriptorBindingPartiallyBound = VK_TRUE;
+    Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    Features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+}
+
+uint32_t VulkanBindlessTable::AddTexture(VkImageView View, VkImageLayout Layout)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    uint32_t Index = AllocateSlot(BINDLESS_TEXTURE_BINDING);
+
+    VkDescriptorImageInfo ImageInfo = {VK_NULL_HANDLE, View, Layout};
+    Write(BINDLESS_TEXTURE_BINDING, Index, &ImageInfo, nullptr);
+    return Index;
+}
+
+uint32_t VulkanBindlessTable::AddBuffer(VkBuffer Buffer, VkDeviceSize Offset, VkDeviceSize Range)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    uint32_t Index = AllocateSlot(BINDLESS_BUFFER_BINDING);
+
+    VkDescriptorBufferInfo BufferInfo = {Buffer, Offset, Range};
+    Write(BINDLESS_BUFFER_BINDING, Index, nullptr, &BufferInfo);
+    return Index;
+}
+
+uint32_t VulkanBindlessTable::AddSampler(VkSampler Sampler)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    uint32_t Index = AllocateSlot(BINDLESS_SAMPLER_BINDING);
+
+    VkDescriptorImageInfo ImageInfo = {Sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED};
+    Write(BINDLESS_SAMPLER_BINDING, Index, &ImageInfo, nullptr);
+    return Index;
+}
+
+void VulkanBindlessTable::RemoveTexture(uint32_t Index)
+{
+    ReleaseSlot(BINDLESS_TEXTURE_BINDING, Index);
+}
+
+void VulkanBindlessTable::RemoveBuffer(uint32_t Index)
+{
+    ReleaseSlot(BINDLESS_BUFFER_BINDING, Index);
+}
+
+void VulkanBindlessTable::RemoveSampler(uint32_t Index)
+{
+    ReleaseSlot(BINDLESS_SAMPLER_BINDING, Index);
+}
+
+void VulkanBindlessTable::Update(uint64_t GraphicsSubmitted, uint64_t GraphicsCompleted,
+    uint64_t ComputeSubmitted, uint64_t ComputeCompleted)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    for (auto& [BindingIndex, Index] : m_UnfencedSlots)
+    {
+        m_RetiredSlots.push_back({BindingIndex, Index, GraphicsSubmitted, ComputeSubmitted});
+    }
+    m_UnfencedSlots.clear();
+
+    // A slot is only written again once no submitted work can index it
+    while (!m_RetiredSlots.empty() && m_RetiredSlots.front().GraphicsValue <= GraphicsCompleted &&
+           m_RetiredSlots.front().ComputeValue <= ComputeCompleted)
+    {
+        RetiredSlot& Slot = m_RetiredSlots.front();
+        m_Bindings[Slot.Binding].FreeIndices.push_back(Slot.Index);
+        m_RetiredSlots.pop_front();
+    }
+}
+
+void VulkanBindlessTable::Bind(VkCommandBuffer CommandBuffer, VkPipelineBindPoint BindPoint) const
+{
+    DEBUG_ASSERT(m_Set);
+
+    vkCmdBindDescriptorSets(CommandBuffer, BindPoint, m_PipelineLayout, 0, 1, &m_Set, 0, nullptr);
+}
+
+uint32_t VulkanBindlessTable::AllocateSlot(uint32_t BindingIndex)
+{
+    DEBUG_ASSERT(m_Set, "Bindless descriptors are not enabled");
+
+    Binding& Target = m_Bindings[BindingIndex];
+
+    if (!Target.FreeIndices.empty())
+    {
+        uint32_t Index = Target.FreeIndices.back();
+        Target.FreeIndices.pop_back();
+        Target.Released[Index] = false;
+        return Index;
+    }
+
+    CHECK(Target.NumUsed < Target.Capacity, "Bindless binding %u is full (%u descriptors)",
+        BindingIndex, Target.Capacity);
+
+    Target.Released.push_back(false);
+    return Target.NumUsed++;
+}
+
+void VulkanBindlessTable::ReleaseSlot(uint32_t BindingIndex, uint32_t Index)
+{
+    if (Index == BINDLESS_INVALID_INDEX)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    Binding& Target = m_Bindings[BindingIndex];
+    DEBUG_ASSERT(Index < Target.NumUsed, "Invalid bindless index");
+    DEBUG_ASSERT(!Target.Released[Index], "Bindless index %u of binding %u released twice", Index,
+        BindingIndex);
+
+    Target.Released[Index] = true;
+    m_UnfencedSlots.push_back({BindingIndex, Index});
+}
+
+void VulkanBindlessTable::Write(uint32_t BindingIndex, uint32_t Index,
+    const VkDescriptorImageInfo* ImageInfo, const VkDescriptorBufferInfo* BufferInfo)
+{
+    VkWriteDescriptorSet DescriptorWrite = {};
+    DescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    DescriptorWrite.dstSet = m_Set;
+    DescriptorWrite.dstBinding = BindingIndex;
+    DescriptorWrite.dstArrayElement = Index;
+    DescriptorWrite.descriptorCount = 1;
+    DescriptorWrite.descriptorType = m_Bindings[BindingIndex].Type;
+    DescriptorWrite.pImageInfo = ImageInfo;
+    DescriptorWrite.pBufferInfo = BufferInfo;
+
+    // Writes to the set are externally synchronized, callers hold the mutex
+    vkUpdateDescriptorSets(m_Device, 1, &DescriptorWrite, 0, nullptr);
+}
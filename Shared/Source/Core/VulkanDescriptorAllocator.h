@@ -0,0 +1,119 @@
+#pragma once
+#include "pch.h"
+
+#define DESCRIPTOR_POOL_INITIAL_SETS 64
+#define DESCRIPTOR_POOL_MAX_SETS 4096
+
+#define BINDLESS_TEXTURE_BINDING 0
+#define BINDLESS_BUFFER_BINDING 1
+#define BINDLESS_SAMPLER_BINDING 2
+#define BINDLESS_NUM_BINDINGS 3
+#define BINDLESS_MAX_TEXTURES (1u << 16)
+#define BINDLESS_MAX_BUFFERS (1u << 16)
+#define BINDLESS_MAX_SAMPLERS 256
+#define BINDLESS_PUSH_CONSTANT_SIZE 128
+#define BINDLESS_INVALID_INDEX UINT32_MAX
+
+// Hands out transient descriptor sets from a chain of pools. A pool that runs out is retired until
+// the next Reset and replaced by a recycled one, or by a new one twice as large. Reset returns
+// every pool at once, so it is meant to be owned by a frame slot and reset when the slot is reused.
+// Externally synchronized, like command pools
+class VulkanDescriptorAllocator
+{
+public:
+    VulkanDescriptorAllocator();
+    ~VulkanDescriptorAllocator() = default;
+    void Init(VkDevice Device, uint32_t SetsPerPool = DESCRIPTOR_POOL_INITIAL_SETS);
+    void Destroy();
+
+    VkDescriptorSet Allocate(VkDescriptorSetLayout Layout);
+    void Reset();
+
+    uint32_t GetNumPools() const;
+    uint32_t GetNumAllocated() const { return m_NumAllocated; }
+
+private:
+    VkDescriptorPool GrabPool();
+
+    VkDevice m_Device;
+    VkDescriptorPool m_CurrentPool;
+    std::vector<VkDescriptorPool> m_FullPools;
+    std::vector<VkDescriptorPool> m_FreePools;
+    uint32_t m_SetsPerPool;
+    uint32_t m_NumAllocated;
+};
+
+// A single descriptor set holding large update-after-bind arrays of sampled images, storage
+// buffers and samplers, bound once per command buffer and indexed from shaders with indices passed
+// through push constants. Slots are written as resources are added and recycled once the frames
+// that could still read them have retired. Set 0 in shaders:
+//   layout(set = 0, binding = 0) uniform texture2D Textures[];
+//   layout(set = 0, binding = 1) buffer Buffers { uint Data[]; } BufferArray[];
+//   layout(set = 0, binding = 2) uniform sampler Samplers[];
+class VulkanBindlessTable
+{
+public:
+    VulkanBindlessTable();
+    ~VulkanBindlessTable() = default;
+    void Init(VkPhysicalDevice PhysicalDevice, VkDevice Device);
+    void Destroy();
+    bool IsInitialized() const { return m_Set != VK_NULL_HANDLE; }
+
+    static bool IsSupported(const VkPhysicalDeviceVulkan12Features& Features);
+    static void EnableFeatures(VkPhysicalDeviceVulkan12Features& Features);
+
+    // Safe to call from any thread
+    uint32_t AddTexture(
+        VkImageView View, VkImageLayout Layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint32_t AddBuffer(
+        VkBuffer Buffer, VkDeviceSize Offset = 0, VkDeviceSize Range = VK_WHOLE_SIZE);
+    uint32_t AddSampler(VkSampler Sampler);
+    void RemoveTexture(uint32_t Index);
+    void RemoveBuffer(uint32_t Index);
+    void RemoveSampler(uint32_t Index);
+
+    // Called at a frame boundary, see ShaderReloader::Update
+    void Update(uint64_t GraphicsSubmitted, uint64_t GraphicsCompleted, uint64_t ComputeSubmitted,
+        uint64_t ComputeCompleted);
+    void Bind(VkCommandBuffer CommandBuffer, VkPipelineBindPoint BindPoint) const;
+
+    VkDescriptorSetLayout GetSetLayout() const { return m_SetLayout; }
+    // The bindless set plus BINDLESS_PUSH_CONSTANT_SIZE bytes of push constants for all stages
+    VkPipelineLayout GetPipelineLayout() const { return m_PipelineLayout; }
+    VkDescriptorSet GetSet() const { return m_Set; }
+
+private:
+    struct Binding
+    {
+        VkDescriptorType Type;
+        uint32_t Capacity = 0;
+        uint32_t NumUsed = 0;
+        std::vector<uint32_t> FreeIndices;
+        // Per allocated index, set from removal until the index is handed out again
+        std::vector<bool> Released;
+    };
+
+    struct RetiredSlot
+    {
+        uint32_t Binding;
+        uint32_t Index;
+        uint64_t GraphicsValue;
+        uint64_t ComputeValue;
+    };
+
+    uint32_t AllocateSlot(uint32_t BindingIndex);
+    void ReleaseSlot(uint32_t BindingIndex, uint32_t Index);
+    void Write(uint32_t BindingIndex, uint32_t Index, const VkDescriptorImageInfo* ImageInfo,
+        const VkDescriptorBufferInfo* BufferInfo);
+
+    VkDevice m_Device;
+    VkDescriptorSetLayout m_SetLayout;
+    VkPipelineLayout m_PipelineLayout;
+    VkDescriptorPool m_Pool;
+    VkDescriptorSet m_Set;
+    std::mutex m_Mutex;
+    std::array<Binding, BINDLESS_NUM_BINDINGS> m_Bindings;
+    // Removed since the last frame boundary, fenced by the next one
+    std::vector<std::pair<uint32_t, uint32_t>> m_UnfencedSlots;
+    std::deque<RetiredSlot> m_RetiredSlots;
+};
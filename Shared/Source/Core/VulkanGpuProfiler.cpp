@@ -0,0 +1,272 @@
+#include "VulkanGpuProfiler.h"
+#include "VulkanUtility.h"
+
+VulkanGpuProfiler::VulkanGpuProfiler()
+    : m_Device(VK_NULL_HANDLE),
+      m_TimestampPeriod(0.0),
+      m_TimestampMask(0),
+      m_MaxScopes(0),
+      m_HostQueryReset(false),
+      m_FrameIndex(0),
+      m_FrameMilliseconds(-1.0)
+{
+}
+
+void VulkanGpuProfiler::Init(VkPhysicalDevice PhysicalDevice, VkDevice Device,
+    uint32_t QueueFamilyIndex, uint32_t NumFrames, bool HostQueryReset, uint32_t MaxScopes)
+{
+    m_Device = Device;
+
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+
+    uint32_t NumQueueFamilies = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &NumQueueFamilies, nullptr);
+    std::vector<VkQueueFamilyProperties> QueueFamilies(NumQueueFamilies);
+    vkGetPhysicalDeviceQueueFamilyProperties(
+        PhysicalDevice, &NumQueueFamilies, QueueFamilies.data());
+
+    uint32_t ValidBits = QueueFamilies[QueueFamilyIndex].timestampValidBits;
+    if (ValidBits == 0)
+    {
+        DEBUG_WARNING("Timestamps are not supported on queue family %u, GPU profiling disabled",
+            QueueFamilyIndex);
+        return;
+    }
+
+    // Nanoseconds per tick, only the low bits of a timestamp are meaningful
+    m_TimestampPeriod = Properties.limits.timestampPeriod;
+    m_TimestampMask = ValidBits >= 64 ? UINT64_MAX : (1ull << ValidBits) - 1;
+    m_MaxScopes = MaxScopes;
+    m_HostQueryReset = HostQueryReset;
+
+    VkQueryPoolCreateInfo QueryPoolInfo = {};
+    QueryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    QueryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    QueryPoolInfo.queryCount = m_MaxScopes * 2;
+
+    m_Frames.resize(NumFrames);
+    for (auto& Target : m_Frames)
+    {
+        VULKAN_RESULT(vkCreateQueryPool(m_Device, &QueryPoolInfo, nullptr, &Target.QueryPool));
+
+        // Queries have to be reset once before their first use
+        if (m_HostQueryReset)
+        {
+            vkResetQueryPool(m_Device, Target.QueryPool, 0, QueryPoolInfo.queryCount);
+        }
+        else
+        {
+            Target.ResetPending = true;
+        }
+    }
+
+    m_Results.resize(QueryPoolInfo.queryCount * 2);
+
+    DEBUG_DISPLAY("GPU profiler: %u scopes per frame, %.2f ns per tick, %s query reset", MaxScopes,
+        m_TimestampPeriod, m_HostQueryReset ? "host" : "command buffer");
+}
+
+void VulkanGpuProfiler::Destroy()
+{
+    if (!m_Statistics.empty())
+    {
+        LogStatistics();
+    }
+
+    for (auto& Target : m_Frames)
+    {
+        vkDestroyQueryPool(m_Device, Target.QueryPool, nullptr);
+    }
+
+    m_Frames.clear();
+    m_Statistics.clear();
+    m_StatisticsIndices.clear();
+    m_Results.clear();
+    m_Device = VK_NULL_HANDLE;
+}
+
+void VulkanGpuProfiler::BeginFrame(uint32_t FrameIndex)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    m_FrameIndex = FrameIndex;
+    m_FrameMilliseconds = -1.0;
+    Frame& Target = m_Frames[m_FrameIndex];
+
+    if (Target.NumQueries > 0)
+    {
+        ReadResults(Target);
+
+        if (m_HostQueryReset)
+        {
+            vkResetQueryPool(m_Device, Target.QueryPool, 0, Target.NumQueries);
+        }
+        else
+        {
+            Target.ResetPending = true;
+        }
+    }
+
+    Target.Scopes.clear();
+    Target.NumQueries = 0;
+}
+
+void VulkanGpuProfiler::ResetQueries(VkCommandBuffer CommandBuffer)
+{
+    if (!IsEnabled() || m_HostQueryReset)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    Frame& Target = m_Frames[m_FrameIndex];
+    if (Target.ResetPending)
+    {
+        vkCmdResetQueryPool(CommandBuffer, Target.QueryPool, 0, m_MaxScopes * 2);
+        Target.ResetPending = false;
+    }
+}
+
+uint32_t VulkanGpuProfiler::BeginScope(VkCommandBuffer CommandBuffer, const std::string& Name)
+{
+    if (!IsEnabled())
+    {
+        return GPU_PROFILER_INVALID_SCOPE;
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    Frame& Target = m_Frames[m_FrameIndex];
+    DEBUG_ASSERT(!Target.ResetPending, "GPU scope recorded before the frame queries were reset");
+
+    if (Target.Scopes.size() >= m_MaxScopes)
+    {
+        return GPU_PROFILER_INVALID_SCOPE;
+    }
+
+    Scope NewScope = {FindStatistics(Name), Target.NumQueries, Target.NumQueries + 1};
+    Target.NumQueries += 2;
+    Target.Scopes.push_back(NewScope);
+
+    vkCmdWriteTimestamp(
+        CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, Target.QueryPool, NewScope.BeginQuery);
+
+    return static_cast<uint32_t>(Target.Scopes.size() - 1);
+}
+
+void VulkanGpuProfiler::EndScope(VkCommandBuffer CommandBuffer, uint32_t Scope)
+{
+    if (Scope == GPU_PROFILER_INVALID_SCOPE)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    Frame& Target = m_Frames[m_FrameIndex];
+    vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Target.QueryPool,
+        Target.Scopes[Scope].EndQuery);
+}
+
+std::vector<VulkanGpuScopeStatistics> VulkanGpuProfiler::GetStatistics() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_Statistics;
+}
+
+void VulkanGpuProfiler::ClearStatistics()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    for (auto& Statistics : m_Statistics)
+    {
+        Statistics = {Statistics.Name};
+    }
+}
+
+void VulkanGpuProfiler::LogStatistics() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    for (auto& Statistics : m_Statistics)
+    {
+        if (Statistics.NumSamples == 0)
+        {
+            continue;
+        }
+
+        DEBUG_DISPLAY("GPU %s: %.3f ms avg, %.3f ms min, %.3f ms max (%u frames)",
+            Statistics.Name.c_str(), Statistics.GetAverageMilliseconds(),
+            Statistics.MinMilliseconds, Statistics.MaxMilliseconds, Statistics.NumSamples);
+    }
+}
+
+void VulkanGpuProfiler::ReadResults(Frame& Target)
+{
+    // The slot has retired, so every query is available unless a scope was never submitted
+    VkResult Result = vkGetQueryPoolResults(m_Device, Target.QueryPool, 0, Target.NumQueries,
+        Target.NumQueries * 2 * sizeof(uint64_t), m_Results.data(), 2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    CHECK(Result == VK_SUCCESS || Result == VK_NOT_READY, "Failed to read timestamps (%d)",
+        Result);
+
+    // Scopes of parallel recorded command buffers may run in any order, the frame spans them all
+    bool HasFrame = false;
+    uint64_t FrameBegin = 0;
+    uint64_t FrameEnd = 0;
+
+    for (auto& Recorded : Target.Scopes)
+    {
+        const uint64_t* Begin = &m_Results[Recorded.BeginQuery * 2];
+        const uint64_t* End = &m_Results[Recorded.EndQuery * 2];
+
+        if (!Begin[1] || !End[1])
+        {
+            continue;
+        }
+
+        uint64_t Ticks = (End[0] - Begin[0]) & m_TimestampMask;
+        double Milliseconds = Ticks * m_TimestampPeriod / 1000000.0;
+
+        FrameBegin = HasFrame ? std::min(FrameBegin, Begin[0]) : Begin[0];
+        FrameEnd = HasFrame ? std::max(FrameEnd, End[0]) : End[0];
+        HasFrame = true;
+
+        VulkanGpuScopeStatistics& Statistics = m_Statistics[Recorded.Statistics];
+        Statistics.MinMilliseconds = Statistics.NumSamples
+                                         ? std::min(Statistics.MinMilliseconds, Milliseconds)
+                                         : Milliseconds;
+        Statistics.MaxMilliseconds = std::max(Statistics.MaxMilliseconds, Milliseconds);
+        Statistics.LastMilliseconds = Milliseconds;
+        Statistics.TotalMilliseconds += Milliseconds;
+        Statistics.NumSamples++;
+    }
+
+    if (HasFrame)
+    {
+        m_FrameMilliseconds =
+            ((FrameEnd - FrameBegin) & m_TimestampMask) * m_TimestampPeriod / 1000000.0;
+    }
+}
+
+uint32_t VulkanGpuProfiler::FindStatistics(const std::string& Name)
+{
+    auto Found = m_StatisticsIndices.find(Name);
+    if (Found != m_StatisticsIndices.end())
+    {
+        return Found->second;
+    }
+
+    uint32_t Index = static_cast<uint32_t>(m_Statistics.size());
+    m_Statistics.push_back({Name});
+    m_StatisticsIndices[Name] = Index;
+    return Index;
+}
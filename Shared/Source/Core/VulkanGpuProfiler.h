@@ -0,0 +1,103 @@
+#pragma once
+#include "pch.h"
+
+#define GPU_PROFILER_MAX_SCOPES 256
+#define GPU_PROFILER_INVALID_SCOPE UINT32_MAX
+
+struct VulkanGpuScopeStatistics
+{
+    std::string Name;
+    double LastMilliseconds = 0.0;
+    double MinMilliseconds = 0.0;
+    double MaxMilliseconds = 0.0;
+    double TotalMilliseconds = 0.0;
+    uint32_t NumSamples = 0;
+
+    double GetAverageMilliseconds() const
+    {
+        return NumSamples ? TotalMilliseconds / NumSamples : 0.0;
+    }
+};
+
+// Timestamp queries around named regions of graphics command buffers. Every frame slot owns a
+// query pool, and the results of a slot are read when the slot comes around again, after its
+// fence has been waited on, so reading never stalls and the numbers lag by the frames in flight.
+// Scopes with the same name are folded into one entry with min, average and max over all frames
+class VulkanGpuProfiler
+{
+public:
+    VulkanGpuProfiler();
+    ~VulkanGpuProfiler() = default;
+    void Init(VkPhysicalDevice PhysicalDevice, VkDevice Device, uint32_t QueueFamilyIndex,
+        uint32_t NumFrames, bool HostQueryReset, uint32_t MaxScopes = GPU_PROFILER_MAX_SCOPES);
+    void Destroy();
+    bool IsEnabled() const { return !m_Frames.empty(); }
+
+    // Called once the previous submission of the frame slot has completed
+    void BeginFrame(uint32_t FrameIndex);
+    // Resets the queries of the frame on the GPU when host resets are unavailable, recorded at the
+    // start of the first command buffer of the frame
+    void ResetQueries(VkCommandBuffer CommandBuffer);
+
+    // Safe to call from recording threads, outside or inside render passes
+    uint32_t BeginScope(VkCommandBuffer CommandBuffer, const std::string& Name);
+    void EndScope(VkCommandBuffer CommandBuffer, uint32_t Scope);
+
+    // From the first scope begin to the last scope end of the frame read back by BeginFrame,
+    // negative when that frame recorded no complete scope
+    double GetFrameMilliseconds() const { return m_FrameMilliseconds; }
+    std::vector<VulkanGpuScopeStatistics> GetStatistics() const;
+    void ClearStatistics();
+    void LogStatistics() const;
+
+private:
+    struct Scope
+    {
+        uint32_t Statistics;
+        uint32_t BeginQuery;
+        uint32_t EndQuery;
+    };
+
+    struct Frame
+    {
+        VkQueryPool QueryPool = VK_NULL_HANDLE;
+        std::vector<Scope> Scopes;
+        uint32_t NumQueries = 0;
+        bool ResetPending = false;
+    };
+
+    void ReadResults(Frame& Target);
+    uint32_t FindStatistics(const std::string& Name);
+
+    VkDevice m_Device;
+    double m_TimestampPeriod;
+    uint64_t m_TimestampMask;
+    uint32_t m_MaxScopes;
+    bool m_HostQueryReset;
+    std::vector<Frame> m_Frames;
+    uint32_t m_FrameIndex;
+    double m_FrameMilliseconds;
+    mutable std::mutex m_Mutex;
+    std::vector<VulkanGpuScopeStatistics> m_Statistics;
+    std::unordered_map<std::string, uint32_t> m_StatisticsIndices;
+    std::vector<uint64_t> m_Results;
+};
+
+// Times the commands recorded between construction and destruction
+class VulkanGpuScope
+{
+public:
+    VulkanGpuScope(VulkanGpuProfiler& Profiler, VkCommandBuffer CommandBuffer,
+        const std::string& Name)
+        : m_Profiler(Profiler),
+          m_CommandBuffer(CommandBuffer),
+          m_Scope(Profiler.BeginScope(CommandBuffer, Name))
+    {
+    }
+    ~VulkanGpuScope() { m_Profiler.EndScope(m_CommandBuffer, m_Scope); }
+
+private:
+    VulkanGpuProfiler& m_Profiler;
+    VkCommandBuffer m_CommandBuffer;
+    uint32_t m_Scope;
+};
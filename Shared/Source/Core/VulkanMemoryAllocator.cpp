@@ -0,0 +1,773 @@
+#include "VulkanMemoryAllocator.h"
+#include "VulkanUtility.h"
+
+void TlsfAllocator::Init(VkDeviceSize Size)
+{
+    m_Nodes.clear();
+    m_UnusedNodes.clear();
+    m_FLBitmap = 0;
+    m_SLBitmaps.fill(0);
+    m_FreeLists.fill(InvalidNode);
+    m_Size = Size;
+    m_UsedSize = 0;
+    m_NumAllocations = 0;
+
+    uint32_t NodeIndex = CreateNode();
+    m_Nodes[NodeIndex].Offset = 0;
+    m_Nodes[NodeIndex].Size = Size;
+    InsertFree(NodeIndex);
+}
+
+bool TlsfAllocator::Allocate(
+    VkDeviceSize Size, VkDeviceSize Alignment, VkDeviceSize* OutOffset, uint32_t* OutNode)
+{
+    DEBUG_ASSERT(Size > 0);
+
+    // Searching for the worst case padding keeps the lookup a single bitmap scan
+    uint32_t NodeIndex = FindFree(Size + (Alignment > 1 ? Alignment - 1 : 0));
+
+    if (NodeIndex == InvalidNode)
+    {
+        return false;
+    }
+
+    RemoveFree(NodeIndex);
+
+    VkDeviceSize Offset = m_Nodes[NodeIndex].Offset;
+    VkDeviceSize Padding = VulkanUtility::AlignUp(Offset, Alignment) - Offset;
+
+    // The front padding goes back to the free lists, its physical predecessor is never free
+    if (Padding > 0)
+    {
+        uint32_t AlignedIndex = SplitNode(NodeIndex, Padding);
+        InsertFree(NodeIndex);
+        NodeIndex = AlignedIndex;
+    }
+
+    if (m_Nodes[NodeIndex].Size - Size >= TLSF_MIN_SPLIT_SIZE)
+    {
+        uint32_t RemainderIndex = SplitNode(NodeIndex, Size);
+        InsertFree(RemainderIndex);
+    }
+
+    Node& AllocatedNode = m_Nodes[NodeIndex];
+    AllocatedNode.Free = false;
+
+    m_UsedSize += AllocatedNode.Size;
+    m_NumAllocations++;
+
+    *OutOffset = AllocatedNode.Offset;
+    *OutNode = NodeIndex;
+    return true;
+}
+
+void TlsfAllocator::Free(uint32_t NodeIndex)
+{
+    DEBUG_ASSERT(NodeIndex < m_Nodes.size() && !m_Nodes[NodeIndex].Free);
+
+    m_UsedSize -= m_Nodes[NodeIndex].Size;
+    m_NumAllocations--;
+
+    uint32_t PrevIndex = m_Nodes[NodeIndex].PrevPhysical;
+    if (PrevIndex != InvalidNode && m_Nodes[PrevIndex].Free)
+    {
+        RemoveFree(PrevIndex);
+        m_Nodes[PrevIndex].Size += m_Nodes[NodeIndex].Size;
+        m_Nodes[PrevIndex].NextPhysical = m_Nodes[NodeIndex].NextPhysical;
+        if (m_Nodes[NodeIndex].NextPhysical != InvalidNode)
+        {
+            m_Nodes[m_Nodes[NodeIndex].NextPhysical].PrevPhysical = PrevIndex;
+        }
+        ReleaseNode(NodeIndex);
+        NodeIndex = PrevIndex;
+    }
+
+    uint32_t NextIndex = m_Nodes[NodeIndex].NextPhysical;
+    if (NextIndex != InvalidNode && m_Nodes[NextIndex].Free)
+    {
+        RemoveFree(NextIndex);
+        m_Nodes[NodeIndex].Size += m_Nodes[NextIndex].Size;
+        m_Nodes[NodeIndex].NextPhysical = m_Nodes[NextIndex].NextPhysical;
+        if (m_Nodes[NextIndex].NextPhysical != InvalidNode)
+        {
+            m_Nodes[m_Nodes[NextIndex].NextPhysical].PrevPhysical = NodeIndex;
+        }
+        ReleaseNode(NextIndex);
+    }
+
+    InsertFree(NodeIndex);
+}
+
+uint32_t TlsfAllocator::CreateNode()
+{
+    if (!m_UnusedNodes.empty())
+    {
+        uint32_t NodeIndex = m_UnusedNodes.back();
+        m_UnusedNodes.pop_back();
+        m_Nodes[NodeIndex] = Node();
+        return NodeIndex;
+    }
+
+    m_Nodes.emplace_back();
+    return static_cast<uint32_t>(m_Nodes.size() - 1);
+}
+
+void TlsfAllocator::ReleaseNode(uint32_t NodeIndex)
+{
+    m_UnusedNodes.push_back(NodeIndex);
+}
+
+void TlsfAllocator::Mapping(VkDeviceSize Size, uint32_t* OutFL, uint32_t* OutSL) const
+{
+    if (Size < TLSF_SMALL_SIZE)
+    {
+        *OutFL = 0;
+        *OutSL = static_cast<uint32_t>(Size / (TLSF_SMALL_SIZE / TLSF_SL_COUNT));
+        return;
+    }
+
+    uint32_t MostSignificantBit = static_cast<uint32_t>(std::bit_width(Size)) - 1;
+    *OutFL = MostSignificantBit - TLSF_SMALL_SHIFT + 1;
+    *OutSL =
+        static_cast<uint32_t>(Size >> (MostSignificantBit - TLSF_SL_BITS)) - TLSF_SL_COUNT;
+}
+
+void TlsfAllocator::InsertFree(uint32_t NodeIndex)
+{
+    uint32_t FL, SL;
+    Mapping(m_Nodes[NodeIndex].Size, &FL, &SL);
+    DEBUG_ASSERT(FL < TLSF_FL_COUNT);
+
+    uint32_t& Head = m_FreeLists[FL * TLSF_SL_COUNT + SL];
+
+    Node& FreeNode = m_Nodes[NodeIndex];
+    FreeNode.Free = true;
+    FreeNode.PrevFree = InvalidNode;
+    FreeNode.NextFree = Head;
+
+    if (Head != InvalidNode)
+    {
+        m_Nodes[Head].PrevFree = NodeIndex;
+    }
+
+    Head = NodeIndex;
+    m_FLBitmap |= 1u << FL;
+    m_SLBitmaps[FL] |= 1u << SL;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t NodeIndex)
+{
+    uint32_t FL, SL;
+    Mapping(m_Nodes[NodeIndex].Size, &FL, &SL);
+
+    Node& FreeNode = m_Nodes[NodeIndex];
+
+    if (FreeNode.PrevFree != InvalidNode)
+    {
+        m_Nodes[FreeNode.PrevFree].NextFree = FreeNode.NextFree;
+    }
+    else
+    {
+        m_FreeLists[FL * TLSF_SL_COUNT + SL] = FreeNode.NextFree;
+    }
+
+    if (FreeNode.NextFree != InvalidNode)
+    {
+        m_Nodes[FreeNode.NextFree].PrevFree = FreeNode.PrevFree;
+    }
+
+    if (m_FreeLists[FL * TLSF_SL_COUNT + SL] == InvalidNode)
+    {
+        m_SLBitmaps[FL] &= ~(1u << SL);
+        if (m_SLBitmaps[FL] == 0)
+        {
+            m_FLBitmap &= ~(1u << FL);
+        }
+    }
+
+    FreeNode.Free = false;
+    FreeNode.PrevFree = InvalidNode;
+    FreeNode.NextFree = InvalidNode;
+}
+
+uint32_t TlsfAllocator::FindFree(VkDeviceSize Size) const
+{
+    // Round up to the next list so that any node found is guaranteed to fit
+    if (Size < TLSF_SMALL_SIZE)
+    {
+        Size = VulkanUtility::AlignUp(Size, TLSF_SMALL_SIZE / TLSF_SL_COUNT);
+    }
+    else
+    {
+        Size += (1ull << (std::bit_width(Size) - 1 - TLSF_SL_BITS)) - 1;
+    }
+
+    uint32_t FL, SL;
+    Mapping(Size, &FL, &SL);
+
+    if (FL >= TLSF_FL_COUNT)
+    {
+        return InvalidNode;
+    }
+
+    uint32_t SLBitmap = m_SLBitmaps[FL] & (~0u << SL);
+
+    if (SLBitmap == 0)
+    {
+        uint32_t FLBitmap = FL + 1 < TLSF_FL_COUNT ? m_FLBitmap & (~0u << (FL + 1)) : 0;
+
+        if (FLBitmap == 0)
+        {
+            return InvalidNode;
+        }
+
+        FL = std::countr_zero(FLBitmap);
+        SLBitmap = m_SLBitmaps[FL];
+    }
+
+    SL = std::countr_zero(SLBitmap);
+    return m_FreeLists[FL * TLSF_SL_COUNT + SL];
+}
+
+uint32_t TlsfAllocator::SplitNode(uint32_t NodeIndex, VkDeviceSize Size)
+{
+    uint32_t NewIndex = CreateNode();
+
+    Node& CurrentNode = m_Nodes[NodeIndex];
+    Node& NewNode = m_Nodes[NewIndex];
+
+    NewNode.Offset = CurrentNode.Offset + Size;
+    NewNode.Size = CurrentNode.Size - Size;
+    NewNode.PrevPhysical = NodeIndex;
+    NewNode.NextPhysical = CurrentNode.NextPhysical;
+
+    if (CurrentNode.NextPhysical != InvalidNode)
+    {
+        m_Nodes[CurrentNode.NextPhysical].PrevPhysical = NewIndex;
+    }
+
+    CurrentNode.Size = Size;
+    CurrentNode.NextPhysical = NewIndex;
+
+    return NewIndex;
+}
+
+VulkanMemoryAllocator::VulkanMemoryAllocator()
+    : m_PhysicalDevice(VK_NULL_HANDLE),
+      m_Device(VK_NULL_HANDLE),
+      m_MemoryProperties({}),
+      m_BlockSize(DEFAULT_MEMORY_BLOCK_SIZE),
+      m_MaxDeviceAllocations(0),
+      m_NumDeviceAllocations(0)
+{
+}
+
+void VulkanMemoryAllocator::Init(
+    VkPhysicalDevice PhysicalDevice, VkDevice Device, VkDeviceSize BlockSize)
+{
+    m_PhysicalDevice = PhysicalDevice;
+    m_Device = Device;
+    m_BlockSize = BlockSize;
+
+    vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &m_MemoryProperties);
+
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(m_PhysicalDevice, &Properties);
+    m_MaxDeviceAllocations = Properties.limits.maxMemoryAllocationCount;
+
+    for (uint32_t Index = 0; Index < m_MemoryProperties.memoryHeapCount; ++Index)
+    {
+        DEBUG_DISPLAY("Memory heap %u: %llu MB%s", Index,
+            m_MemoryProperties.memoryHeaps[Index].size / (1024 * 1024),
+            m_MemoryProperties.memoryHeaps[Index].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT
+                ? " (device local)"
+                : "");
+    }
+}
+
+void VulkanMemoryAllocator::Destroy()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    for (auto& BlockList : m_Blocks)
+    {
+        for (auto& Block : BlockList)
+        {
+            if (!Block->Allocator.IsEmpty())
+            {
+                DEBUG_WARNING("Destroying memory block with %u live allocations",
+                    Block->Allocator.GetNumAllocations());
+            }
+            FreeDeviceMemory(Block->Memory);
+        }
+        BlockList.clear();
+    }
+
+    for (uint32_t Index = 0; Index < VK_MAX_MEMORY_TYPES; ++Index)
+    {
+        if (m_DedicatedStatistics[Index].NumDedicatedAllocations > 0)
+        {
+            DEBUG_WARNING("Leaked %u dedicated allocations of memory type %u",
+                m_DedicatedStatistics[Index].NumDedicatedAllocations, Index);
+        }
+    }
+
+    m_DedicatedStatistics.fill({});
+    m_Device = VK_NULL_HANDLE;
+}
+
+uint32_t VulkanMemoryAllocator::FindMemoryTypeIndex(uint32_t MemoryTypeBits,
+    VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Preferred) const
+{
+    uint32_t SelectedIndex = UINT32_MAX;
+    int32_t SelectedScore = -1;
+
+    for (uint32_t Index = 0; Index < m_MemoryProperties.memoryTypeCount; ++Index)
+    {
+        VkMemoryPropertyFlags Flags = m_MemoryProperties.memoryTypes[Index].propertyFlags;
+
+        if ((MemoryTypeBits & (1u << Index)) == 0 || (Flags & Required) != Required)
+        {
+            continue;
+        }
+
+        // Prefer the requested extra flags, then the type with the fewest unrequested ones
+        int32_t Score = std::popcount(Flags & Preferred) * 32 - std::popcount(Flags & ~Required);
+
+        if (Score > SelectedScore)
+        {
+            SelectedScore = Score;
+            SelectedIndex = Index;
+        }
+    }
+
+    CHECK(SelectedIndex != UINT32_MAX, "No suitable memory type found");
+    return SelectedIndex;
+}
+
+VulkanAllocation VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& Requirements,
+    VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Preferred, bool Optimal, bool Dedicated)
+{
+    return AllocateInternal(
+        Requirements, Required, Preferred, Optimal, Dedicated, VK_NULL_HANDLE, VK_NULL_HANDLE);
+}
+
+VulkanAllocation VulkanMemoryAllocator::AllocateForBuffer(
+    VkBuffer Buffer, VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Preferred)
+{
+    VkMemoryDedicatedRequirements DedicatedRequirements = {};
+    DedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+    VkMemoryRequirements2 Requirements = {};
+    Requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    Requirements.pNext = &DedicatedRequirements;
+
+    VkBufferMemoryRequirementsInfo2 RequirementsInfo = {};
+    RequirementsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+    RequirementsInfo.buffer = Buffer;
+    vkGetBufferMemoryRequirements2(m_Device, &RequirementsInfo, &Requirements);
+
+    VulkanAllocation Allocation = AllocateInternal(Requirements.memoryRequirements, Required,
+        Preferred, false, DedicatedRequirements.requiresDedicatedAllocation, VK_NULL_HANDLE,
+        Buffer);
+
+    VULKAN_RESULT(vkBindBufferMemory(m_Device, Buffer, Allocation.Memory, Allocation.Offset));
+    return Allocation;
+}
+
+VulkanAllocation VulkanMemoryAllocator::AllocateForImage(
+    VkImage Image, VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Preferred)
+{
+    VkMemoryDedicatedRequirements DedicatedRequirements = {};
+    DedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+    VkMemoryRequirements2 Requirements = {};
+    Requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    Requirements.pNext = &DedicatedRequirements;
+
+    VkImageMemoryRequirementsInfo2 RequirementsInfo = {};
+    RequirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+    RequirementsInfo.image = Image;
+    vkGetImageMemoryRequirements2(m_Device, &RequirementsInfo, &Requirements);
+
+    // Render targets and other large images are where drivers benefit from dedicated memory
+    bool Dedicated = DedicatedRequirements.requiresDedicatedAllocation ||
+                     DedicatedRequirements.prefersDedicatedAllocation;
+
+    VulkanAllocation Allocation = AllocateInternal(Requirements.memoryRequirements, Required,
+        Preferred, true, Dedicated, Image, VK_NULL_HANDLE);
+
+    VULKAN_RESULT(vkBindImageMemory(m_Device, Image, Allocation.Memory, Allocation.Offset));
+    return Allocation;
+}
+
+VulkanAllocation VulkanMemoryAllocator::AllocateInternal(const VkMemoryRequirements& Requirements,
+    VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Preferred, bool Optimal, bool Dedicated,
+    VkImage DedicatedImage, VkBuffer DedicatedBuffer)
+{
+    uint32_t MemoryTypeIndex =
+        FindMemoryTypeIndex(Requirements.memoryTypeBits, Required, Preferred);
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    VkDeviceSize BlockSize = GetBlockSize(MemoryTypeIndex);
+
+    if (Dedicated || Requirements.size > BlockSize / 2)
+    {
+        return AllocateDedicated(Requirements, MemoryTypeIndex, DedicatedImage, DedicatedBuffer);
+    }
+
+    auto& BlockList = m_Blocks[MemoryTypeIndex * 2 + (Optimal ? 1 : 0)];
+
+    VulkanAllocation Allocation;
+    Allocation.Size = Requirements.size;
+    Allocation.MemoryTypeIndex = MemoryTypeIndex;
+
+    for (auto& Block : BlockList)
+    {
+        if (Block->Allocator.GetSize() - Block->Allocator.GetUsedSize() < Requirements.size)
+        {
+            continue;
+        }
+
+        if (Block->Allocator.Allocate(
+                Requirements.size, Requirements.alignment, &Allocation.Offset, &Allocation.Node))
+        {
+            Allocation.Block = Block.get();
+            break;
+        }
+    }
+
+    if (Allocation.Block == nullptr)
+    {
+        VulkanMemoryBlock* Block = CreateBlock(MemoryTypeIndex, BlockSize);
+        BlockList.emplace_back(Block);
+
+        bool Allocated = Block->Allocator.Allocate(
+            Requirements.size, Requirements.alignment, &Allocation.Offset, &Allocation.Node);
+        CHECK(Allocated, "Failed to sub-allocate %llu bytes", Requirements.size);
+
+        Allocation.Block = Block;
+    }
+
+    Allocation.Memory = Allocation.Block->Memory;
+    Allocation.MappedData =
+        Allocation.Block->MappedData ? Allocation.Block->MappedData + Allocation.Offset : nullptr;
+
+    return Allocation;
+}
+
+void VulkanMemoryAllocator::Free(VulkanAllocation& Allocation)
+{
+    if (!Allocation.IsValid())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    if (Allocation.IsDedicated())
+    {
+        auto& Statistics = m_DedicatedStatistics[Allocation.MemoryTypeIndex];
+        Statistics.NumDedicatedAllocations--;
+        Statistics.DedicatedBytes -= Allocation.Size;
+        FreeDeviceMemory(Allocation.Memory);
+        Allocation = {};
+        return;
+    }
+
+    VulkanMemoryBlock* Block = Allocation.Block;
+    Block->Allocator.Free(Allocation.Node);
+    Allocation = {};
+
+    if (!Block->Allocator.IsEmpty())
+    {
+        return;
+    }
+
+    // Keep one empty block around per list so that a single allocation going back and forth
+    // does not hit vkAllocateMemory every time
+    for (auto& BlockList : m_Blocks)
+    {
+        auto Found = std::find_if(BlockList.begin(), BlockList.end(),
+            [Block](const auto& Current) { return Current.get() == Block; });
+
+        if (Found == BlockList.end())
+        {
+            continue;
+        }
+
+        uint32_t NumEmptyBlocks = static_cast<uint32_t>(std::count_if(BlockList.begin(),
+            BlockList.end(), [](const auto& Current) { return Current->Allocator.IsEmpty(); }));
+
+        if (NumEmptyBlocks > 1)
+        {
+            FreeDeviceMemory(Block->Memory);
+            BlockList.erase(Found);
+        }
+        return;
+    }
+}
+
+VulkanAllocation VulkanMemoryAllocator::AllocateDedicated(const VkMemoryRequirements& Requirements,
+    uint32_t MemoryTypeIndex, VkImage Image, VkBuffer Buffer)
+{
+    VkMemoryDedicatedAllocateInfo DedicatedInfo = {};
+    DedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    DedicatedInfo.image = Image;
+    DedicatedInfo.buffer = Buffer;
+
+    bool HasResource = Image != VK_NULL_HANDLE || Buffer != VK_NULL_HANDLE;
+
+    VulkanAllocation Allocation;
+    Allocation.Size = Requirements.size;
+    Allocation.MemoryTypeIndex = MemoryTypeIndex;
+    Allocation.Memory = AllocateDeviceMemory(Requirements.size, MemoryTypeIndex,
+        HasResource ? &DedicatedInfo : nullptr, &Allocation.MappedData);
+
+    auto& Statistics = m_DedicatedStatistics[MemoryTypeIndex];
+    Statistics.NumDedicatedAllocations++;
+    Statistics.DedicatedBytes += Requirements.size;
+
+    return Allocation;
+}
+
+VulkanMemoryBlock* VulkanMemoryAllocator::CreateBlock(uint32_t MemoryTypeIndex, VkDeviceSize Size)
+{
+    auto Block = new VulkanMemoryBlock();
+    Block->Size = Size;
+    Block->MemoryTypeIndex = MemoryTypeIndex;
+
+    void* MappedData = nullptr;
+    Block->Memory = AllocateDeviceMemory(Size, MemoryTypeIndex, nullptr, &MappedData);
+    Block->MappedData = static_cast<uint8_t*>(MappedData);
+    Block->Allocator.Init(Size);
+
+    return Block;
+}
+
+VkDeviceMemory VulkanMemoryAllocator::AllocateDeviceMemory(
+    VkDeviceSize Size, uint32_t MemoryTypeIndex, const void* Next, void** OutMappedData)
+{
+    CHECK(m_NumDeviceAllocations < m_MaxDeviceAllocations,
+        "Device memory allocation limit reached (%u)", m_MaxDeviceAllocations);
+
+    VkMemoryAllocateInfo AllocateInfo = {};
+    AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    AllocateInfo.pNext = Next;
+    AllocateInfo.allocationSize = Size;
+    AllocateInfo.memoryTypeIndex = MemoryTypeIndex;
+
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    VULKAN_RESULT(vkAllocateMemory(m_Device, &AllocateInfo, nullptr, &Memory));
+
+    m_NumDeviceAllocations++;
+
+    // Host visible memory stays mapped for its whole lifetime
+    *OutMappedData = nullptr;
+    if (m_MemoryProperties.memoryTypes[MemoryTypeIndex].propertyFlags &
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        VULKAN_RESULT(vkMapMemory(m_Device, Memory, 0, VK_WHOLE_SIZE, 0, OutMappedData));
+    }
+
+    return Memory;
+}
+
+void VulkanMemoryAllocator::FreeDeviceMemory(VkDeviceMemory Memory)
+{
+    vkFreeMemory(m_Device, Memory, nullptr);
+    m_NumDeviceAllocations--;
+}
+
+VkDeviceSize VulkanMemoryAllocator::GetBlockSize(uint32_t MemoryTypeIndex) const
+{
+    uint32_t HeapIndex = m_MemoryProperties.memoryTypes[MemoryTypeIndex].heapIndex;
+    VkDeviceSize HeapSize = m_MemoryProperties.memoryHeaps[HeapIndex].size;
+
+    // Small heaps such as the host visible device local window get proportionally smaller blocks
+    return std::min(m_BlockSize, HeapSize / 8);
+}
+
+VulkanMemoryStatistics VulkanMemoryAllocator::GetStatistics()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    VulkanMemoryStatistics Statistics;
+    Statistics.NumDeviceAllocations = m_NumDeviceAllocations;
+    Statistics.MaxDeviceAllocations = m_MaxDeviceAllocations;
+
+    for (uint32_t Index = 0; Index < VK_MAX_MEMORY_TYPES; ++Index)
+    {
+        auto& TypeStatistics = Statistics.MemoryTypes[Index];
+        TypeStatistics = m_DedicatedStatistics[Index];
+
+        for (uint32_t Optimal = 0; Optimal < 2; ++Optimal)
+        {
+            for (auto& Block : m_Blocks[Index * 2 + Optimal])
+            {
+                TypeStatistics.NumBlocks++;
+                TypeStatistics.NumAllocations += Block->Allocator.GetNumAllocations();
+                TypeStatistics.BlockBytes += Block->Size;
+                TypeStatistics.UsedBytes += Block->Allocator.GetUsedSize();
+            }
+        }
+
+        Statistics.Total.NumBlocks += TypeStatistics.NumBlocks;
+        Statistics.Total.NumAllocations += TypeStatistics.NumAllocations;
+        Statistics.Total.NumDedicatedAllocations += TypeStatistics.NumDedicatedAllocations;
+        Statistics.Total.BlockBytes += TypeStatistics.BlockBytes;
+        Statistics.Total.UsedBytes += TypeStatistics.UsedBytes;
+        Statistics.Total.DedicatedBytes += TypeStatistics.DedicatedBytes;
+    }
+
+    return Statistics;
+}
+
+void VulkanMemoryAllocator::LogStatistics()
+{
+    VulkanMemoryStatistics Statistics = GetStatistics();
+
+    for (uint32_t Index = 0; Index < m_MemoryProperties.memoryTypeCount; ++Index)
+    {
+        auto& TypeStatistics = Statistics.MemoryTypes[Index];
+
+        if (TypeStatistics.NumBlocks == 0 && TypeStatistics.NumDedicatedAllocations == 0)
+        {
+            continue;
+        }
+
+        DEBUG_DISPLAY("Memory type %u: %u blocks, %u allocations (%.2f / %.2f MB), %u dedicated "
+                      "(%.2f MB)",
+            Index, TypeStatistics.NumBlocks, TypeStatistics.NumAllocations,
+            TypeStatistics.UsedBytes / (1024.0 * 1024.0),
+            TypeStatistics.BlockBytes / (1024.0 * 1024.0), TypeStatistics.NumDedicatedAllocations,
+            TypeStatistics.DedicatedBytes / (1024.0 * 1024.0));
+    }
+
+    DEBUG_DISPLAY("Device memory allocations: %u / %u", Statistics.NumDeviceAllocations,
+        Statistics.MaxDeviceAllocations);
+}
+
+VulkanLinearPool::VulkanLinearPool()
+    : m_Allocator(nullptr),
+      m_Mode(VulkanLinearPoolMode::LINEAR),
+      m_Size(0),
+      m_Head(0),
+      m_Tail(0),
+      m_TotalAllocated(0),
+      m_TotalRetired(0),
+      m_PeakUsedSize(0)
+{
+}
+
+void VulkanLinearPool::Init(VulkanMemoryAllocator& Allocator,
+    const VkMemoryRequirements& Requirements, VkMemoryPropertyFlags Required,
+    VulkanLinearPoolMode Mode, VkDeviceSize Size)
+{
+    DEBUG_ASSERT(Size <= Requirements.size);
+
+    // The range handed out can be smaller than the allocation, e.g. the size of the bound buffer
+    m_Allocator = &Allocator;
+    m_Mode = Mode;
+    m_Size = Size > 0 ? Size : Requirements.size;
+    m_Allocation = Allocator.Allocate(Requirements, Required, 0, false, true);
+
+    Reset();
+}
+
+void VulkanLinearPool::Destroy()
+{
+    if (m_Allocator)
+    {
+        m_Allocator->Free(m_Allocation);
+        m_Allocator = nullptr;
+    }
+}
+
+bool VulkanLinearPool::Allocate(
+    VkDeviceSize Size, VkDeviceSize Alignment, VkDeviceSize* OutOffset, void** OutMappedData)
+{
+    if (GetUsedSize() == m_Size)
+    {
+        return false;
+    }
+
+    VkDeviceSize Offset = VulkanUtility::AlignUp(m_Head, Alignment);
+    VkDeviceSize Consumed = Offset + Size - m_Head;
+
+    if (m_Head >= m_Tail)
+    {
+        // Free space is [Head, Size) plus [0, Tail) once a ring has wrapped, the skipped end of
+        // the buffer counts as used until the tail passes it
+        if (Offset + Size > m_Size)
+        {
+            if (m_Mode == VulkanLinearPoolMode::LINEAR || Size > m_Tail)
+            {
+                return false;
+            }
+
+            Offset = 0;
+            Consumed = m_Size - m_Head + Size;
+        }
+    }
+    else if (Offset + Size > m_Tail)
+    {
+        return false;
+    }
+
+    m_TotalAllocated += Consumed;
+    m_Head = Offset + Size;
+    m_PeakUsedSize = std::max(m_PeakUsedSize, GetUsedSize());
+
+    *OutOffset = Offset;
+
+    if (OutMappedData)
+    {
+        *OutMappedData = m_Allocation.MappedData
+                             ? static_cast<uint8_t*>(m_Allocation.MappedData) + Offset
+                             : nullptr;
+    }
+
+    return true;
+}
+
+void VulkanLinearPool::Reset()
+{
+    m_Head = 0;
+    m_Tail = 0;
+    m_TotalAllocated = 0;
+    m_TotalRetired = 0;
+    m_FenceMarks.clear();
+}
+
+void VulkanLinearPool::Fence(uint64_t Value)
+{
+    DEBUG_ASSERT(m_Mode == VulkanLinearPoolMode::RING);
+
+    if (!m_FenceMarks.empty() && m_FenceMarks.back().TotalAllocated == m_TotalAllocated)
+    {
+        m_FenceMarks.back().Value = Value;
+        return;
+    }
+
+    m_FenceMarks.push_back({Value, m_Head, m_TotalAllocated});
+}
+
+void VulkanLinearPool::Retire(uint64_t CompletedValue)
+{
+    DEBUG_ASSERT(m_Mode == VulkanLinearPoolMode::RING);
+
+    while (!m_FenceMarks.empty() && m_FenceMarks.front().Value <= CompletedValue)
+    {
+        m_Tail = m_FenceMarks.front().Head;
+        m_TotalRetired = m_FenceMarks.front().TotalAllocated;
+        m_FenceMarks.pop_front();
+    }
+
+    if (GetUsedSize() == 0)
+    {
+        m_Head = 0;
+        m_Tail = 0;
+    }
+}
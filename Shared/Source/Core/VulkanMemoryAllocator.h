@@ -0,0 +1,198 @@
+#pragma once
+#include "pch.h"
+
+#define TLSF_SL_BITS 4
+#define TLSF_SL_COUNT (1 << TLSF_SL_BITS)
+#define TLSF_SMALL_SHIFT 8
+#define TLSF_SMALL_SIZE (1 << TLSF_SMALL_SHIFT)
+#define TLSF_FL_COUNT 32
+#define TLSF_MIN_SPLIT_SIZE 64
+
+#define DEFAULT_MEMORY_BLOCK_SIZE (64ull * 1024 * 1024)
+
+// Two-level segregated fit allocator over an offset range, it only tracks offsets so the memory it
+// manages never has to be mapped. Allocation and free are O(1) and free ranges are coalesced
+class TlsfAllocator
+{
+public:
+    static constexpr uint32_t InvalidNode = UINT32_MAX;
+
+    void Init(VkDeviceSize Size);
+    bool Allocate(
+        VkDeviceSize Size, VkDeviceSize Alignment, VkDeviceSize* OutOffset, uint32_t* OutNode);
+    void Free(uint32_t NodeIndex);
+    VkDeviceSize GetSize() const { return m_Size; }
+    VkDeviceSize GetUsedSize() const { return m_UsedSize; }
+    uint32_t GetNumAllocations() const { return m_NumAllocations; }
+    bool IsEmpty() const { return m_NumAllocations == 0; }
+
+private:
+    struct Node
+    {
+        VkDeviceSize Offset = 0;
+        VkDeviceSize Size = 0;
+        uint32_t PrevPhysical = InvalidNode;
+        uint32_t NextPhysical = InvalidNode;
+        uint32_t PrevFree = InvalidNode;
+        uint32_t NextFree = InvalidNode;
+        bool Free = false;
+    };
+
+    uint32_t CreateNode();
+    void ReleaseNode(uint32_t NodeIndex);
+    void Mapping(VkDeviceSize Size, uint32_t* OutFL, uint32_t* OutSL) const;
+    void InsertFree(uint32_t NodeIndex);
+    void RemoveFree(uint32_t NodeIndex);
+    uint32_t FindFree(VkDeviceSize Size) const;
+    uint32_t SplitNode(uint32_t NodeIndex, VkDeviceSize Size);
+
+    std::vector<Node> m_Nodes;
+    std::vector<uint32_t> m_UnusedNodes;
+    uint32_t m_FLBitmap = 0;
+    std::array<uint32_t, TLSF_FL_COUNT> m_SLBitmaps = {};
+    std::array<uint32_t, TLSF_FL_COUNT * TLSF_SL_COUNT> m_FreeLists = {};
+    VkDeviceSize m_Size = 0;
+    VkDeviceSize m_UsedSize = 0;
+    uint32_t m_NumAllocations = 0;
+};
+
+struct VulkanMemoryBlock
+{
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    VkDeviceSize Size = 0;
+    uint8_t* MappedData = nullptr;
+    uint32_t MemoryTypeIndex = UINT32_MAX;
+    TlsfAllocator Allocator;
+};
+
+struct VulkanAllocation
+{
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    VkDeviceSize Offset = 0;
+    VkDeviceSize Size = 0;
+    void* MappedData = nullptr;
+    uint32_t MemoryTypeIndex = UINT32_MAX;
+    VulkanMemoryBlock* Block = nullptr;
+    uint32_t Node = TlsfAllocator::InvalidNode;
+
+    bool IsValid() const { return Memory != VK_NULL_HANDLE; }
+    bool IsDedicated() const { return Block == nullptr; }
+};
+
+struct VulkanMemoryTypeStatistics
+{
+    uint32_t NumBlocks = 0;
+    uint32_t NumAllocations = 0;
+    uint32_t NumDedicatedAllocations = 0;
+    VkDeviceSize BlockBytes = 0;
+    VkDeviceSize UsedBytes = 0;
+    VkDeviceSize DedicatedBytes = 0;
+};
+
+struct VulkanMemoryStatistics
+{
+    std::array<VulkanMemoryTypeStatistics, VK_MAX_MEMORY_TYPES> MemoryTypes;
+    VulkanMemoryTypeStatistics Total;
+    uint32_t NumDeviceAllocations = 0;
+    uint32_t MaxDeviceAllocations = 0;
+};
+
+class VulkanMemoryAllocator
+{
+public:
+    VulkanMemoryAllocator();
+    ~VulkanMemoryAllocator() = default;
+    void Init(VkPhysicalDevice PhysicalDevice, VkDevice Device,
+        VkDeviceSize BlockSize = DEFAULT_MEMORY_BLOCK_SIZE);
+    void Destroy();
+
+    uint32_t FindMemoryTypeIndex(uint32_t MemoryTypeBits, VkMemoryPropertyFlags Required,
+        VkMemoryPropertyFlags Preferred = 0) const;
+    VulkanAllocation Allocate(const VkMemoryRequirements& Requirements,
+        VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Preferred, bool Optimal,
+        bool Dedicated = false);
+    VulkanAllocation AllocateForBuffer(VkBuffer Buffer, VkMemoryPropertyFlags Required,
+        VkMemoryPropertyFlags Preferred = 0);
+    VulkanAllocation AllocateForImage(VkImage Image, VkMemoryPropertyFlags Required,
+        VkMemoryPropertyFlags Preferred = 0);
+    void Free(VulkanAllocation& Allocation);
+
+    const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const
+    {
+        return m_MemoryProperties;
+    }
+    VulkanMemoryStatistics GetStatistics();
+    void LogStatistics();
+
+private:
+    VulkanAllocation AllocateDedicated(const VkMemoryRequirements& Requirements,
+        uint32_t MemoryTypeIndex, VkImage Image, VkBuffer Buffer);
+    VulkanMemoryBlock* CreateBlock(uint32_t MemoryTypeIndex, VkDeviceSize Size);
+    VkDeviceMemory AllocateDeviceMemory(
+        VkDeviceSize Size, uint32_t MemoryTypeIndex, const void* Next, void** OutMappedData);
+    void FreeDeviceMemory(VkDeviceMemory Memory);
+    VkDeviceSize GetBlockSize(uint32_t MemoryTypeIndex) const;
+    VulkanAllocation AllocateInternal(const VkMemoryRequirements& Requirements,
+        VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Preferred, bool Optimal,
+        bool Dedicated, VkImage DedicatedImage, VkBuffer DedicatedBuffer);
+
+    VkPhysicalDevice m_PhysicalDevice;
+    VkDevice m_Device;
+    VkPhysicalDeviceMemoryProperties m_MemoryProperties;
+    VkDeviceSize m_BlockSize;
+    uint32_t m_MaxDeviceAllocations;
+    uint32_t m_NumDeviceAllocations;
+    // Linear (buffers) and optimal (images) resources get separate blocks so that
+    // bufferImageGranularity never has to be honored inside a block
+    std::array<std::vector<std::unique_ptr<VulkanMemoryBlock>>, VK_MAX_MEMORY_TYPES * 2> m_Blocks;
+    std::array<VulkanMemoryTypeStatistics, VK_MAX_MEMORY_TYPES> m_DedicatedStatistics;
+    std::mutex m_Mutex;
+};
+
+enum class VulkanLinearPoolMode
+{
+    LINEAR = 0,
+    RING,
+};
+
+// Bump allocator over a single allocation for transient data. Linear pools are reset as a whole,
+// ring pools release their oldest ranges as the submissions that used them retire
+class VulkanLinearPool
+{
+public:
+    VulkanLinearPool();
+    ~VulkanLinearPool() = default;
+    void Init(VulkanMemoryAllocator& Allocator, const VkMemoryRequirements& Requirements,
+        VkMemoryPropertyFlags Required, VulkanLinearPoolMode Mode, VkDeviceSize Size = 0);
+    void Destroy();
+
+    bool Allocate(VkDeviceSize Size, VkDeviceSize Alignment, VkDeviceSize* OutOffset,
+        void** OutMappedData = nullptr);
+    void Reset();
+    void Fence(uint64_t Value);
+    void Retire(uint64_t CompletedValue);
+
+    const VulkanAllocation& GetAllocation() const { return m_Allocation; }
+    VkDeviceSize GetSize() const { return m_Size; }
+    VkDeviceSize GetUsedSize() const { return m_TotalAllocated - m_TotalRetired; }
+    VkDeviceSize GetPeakUsedSize() const { return m_PeakUsedSize; }
+
+private:
+    struct FenceMark
+    {
+        uint64_t Value;
+        VkDeviceSize Head;
+        VkDeviceSize TotalAllocated;
+    };
+
+    VulkanMemoryAllocator* m_Allocator;
+    VulkanAllocation m_Allocation;
+    VulkanLinearPoolMode m_Mode;
+    VkDeviceSize m_Size;
+    VkDeviceSize m_Head;
+    VkDeviceSize m_Tail;
+    VkDeviceSize m_TotalAllocated;
+    VkDeviceSize m_TotalRetired;
+    VkDeviceSize m_PeakUsedSize;
+    std::deque<FenceMark> m_FenceMarks;
+};
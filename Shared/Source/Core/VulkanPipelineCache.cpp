@@ -0,0 +1,277 @@
+#include "VulkanPipelineCache.h"
+#include "VulkanUtility.h"
+
+VulkanPipelineCache::VulkanPipelineCache()
+    : m_Properties({}),
+      m_Device(VK_NULL_HANDLE),
+      m_Handle(VK_NULL_HANDLE),
+      m_CreationFeedback(false)
+{
+}
+
+void VulkanPipelineCache::Init(VkPhysicalDevice PhysicalDevice, VkDevice Device,
+    const std::filesystem::path& Path, bool CreationFeedback)
+{
+    m_Device = Device;
+    m_Path = Path;
+    m_CreationFeedback = CreationFeedback;
+    m_Statistics = {};
+
+    vkGetPhysicalDeviceProperties(PhysicalDevice, &m_Properties);
+
+    // Handed to the driver straight from the mapping, it copies what it keeps
+    MappedFile File;
+    std::span<const uint8_t> Data = Load(File);
+    m_Statistics.LoadedBytes = Data.size();
+
+    VkPipelineCacheCreateInfo CacheInfo = {};
+    CacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    CacheInfo.initialDataSize = Data.size();
+    CacheInfo.pInitialData = Data.empty() ? nullptr : Data.data();
+
+    VULKAN_RESULT(vkCreatePipelineCache(m_Device, &CacheInfo, nullptr, &m_Handle));
+
+    DEBUG_DISPLAY("Pipeline cache: %s (%zu bytes)", m_Path.string().c_str(), Data.size());
+}
+
+void VulkanPipelineCache::Destroy()
+{
+    if (!m_Handle)
+    {
+        return;
+    }
+
+    Save();
+    LogStatistics();
+
+    vkDestroyPipelineCache(m_Device, m_Handle, nullptr);
+    m_Handle = VK_NULL_HANDLE;
+}
+
+void VulkanPipelineCache::Save()
+{
+    DEBUG_ASSERT(m_Handle);
+
+    size_t DataSize = 0;
+    VULKAN_RESULT(vkGetPipelineCacheData(m_Device, m_Handle, &DataSize, nullptr));
+
+    std::vector<uint8_t> Data(DataSize);
+    VULKAN_RESULT(vkGetPipelineCacheData(m_Device, m_Handle, &DataSize, Data.data()));
+    Data.resize(DataSize);
+
+    FileHeader Header;
+    Header.Magic = PIPELINE_CACHE_MAGIC;
+    Header.Version = PIPELINE_CACHE_VERSION;
+    Header.DataSize = DataSize;
+    Header.Checksum = Utility::Hash(Data.data(), Data.size());
+
+    // A crash halfway through leaves at most a stale temporary file, never a torn cache
+    std::filesystem::path TemporaryPath = m_Path;
+    TemporaryPath += ".tmp";
+
+    {
+        std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+        if (!File)
+        {
+            DEBUG_WARNING("Failed to write pipeline cache to %s", TemporaryPath.string().c_str());
+            return;
+        }
+
+        File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+        File.write(reinterpret_cast<const char*>(Data.data()), Data.size());
+        File.flush();
+
+        if (!File)
+        {
+            DEBUG_WARNING("Failed to write pipeline cache to %s", TemporaryPath.string().c_str());
+            return;
+        }
+    }
+
+    std::error_code Error;
+    std::filesystem::rename(TemporaryPath, m_Path, Error);
+
+    if (Error)
+    {
+        DEBUG_WARNING("Failed to replace pipeline cache %s: %s", m_Path.string().c_str(),
+            Error.message().c_str());
+        std::filesystem::remove(TemporaryPath, Error);
+        return;
+    }
+
+    m_Statistics.SavedBytes = DataSize;
+}
+
+VkPipeline VulkanPipelineCache::CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& Info)
+{
+    PROFILE_FUNCTION();
+
+    VkPipelineCreationFeedback Feedback = {};
+    std::vector<VkPipelineCreationFeedback> StageFeedbacks(Info.stageCount);
+
+    VkPipelineCreationFeedbackCreateInfo FeedbackInfo = {};
+    FeedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+    FeedbackInfo.pNext = Info.pNext;
+    FeedbackInfo.pPipelineCreationFeedback = &Feedback;
+    FeedbackInfo.pipelineStageCreationFeedbackCount = Info.stageCount;
+    FeedbackInfo.pPipelineStageCreationFeedbacks = StageFeedbacks.data();
+
+    VkGraphicsPipelineCreateInfo PipelineInfo = Info;
+    if (m_CreationFeedback)
+    {
+        PipelineInfo.pNext = &FeedbackInfo;
+    }
+
+    auto Start = std::chrono::high_resolution_clock::now();
+
+    VkPipeline Pipeline = VK_NULL_HANDLE;
+    VULKAN_RESULT(
+        vkCreateGraphicsPipelines(m_Device, m_Handle, 1, &PipelineInfo, nullptr, &Pipeline));
+
+    std::chrono::duration<double, std::milli> Elapsed =
+        std::chrono::high_resolution_clock::now() - Start;
+    RecordFeedback(Feedback, Elapsed.count());
+
+    return Pipeline;
+}
+
+VkPipeline VulkanPipelineCache::CreateComputePipeline(const VkComputePipelineCreateInfo& Info)
+{
+    PROFILE_FUNCTION();
+
+    VkPipelineCreationFeedback Feedback = {};
+    VkPipelineCreationFeedback StageFeedback = {};
+
+    VkPipelineCreationFeedbackCreateInfo FeedbackInfo = {};
+    FeedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+    FeedbackInfo.pNext = Info.pNext;
+    FeedbackInfo.pPipelineCreationFeedback = &Feedback;
+    FeedbackInfo.pipelineStageCreationFeedbackCount = 1;
+    FeedbackInfo.pPipelineStageCreationFeedbacks = &StageFeedback;
+
+    VkComputePipelineCreateInfo PipelineInfo = Info;
+    if (m_CreationFeedback)
+    {
+        PipelineInfo.pNext = &FeedbackInfo;
+    }
+
+    auto Start = std::chrono::high_resolution_clock::now();
+
+    VkPipeline Pipeline = VK_NULL_HANDLE;
+    VULKAN_RESULT(
+        vkCreateComputePipelines(m_Device, m_Handle, 1, &PipelineInfo, nullptr, &Pipeline));
+
+    std::chrono::duration<double, std::milli> Elapsed =
+        std::chrono::high_resolution_clock::now() - Start;
+    RecordFeedback(Feedback, Elapsed.count());
+
+    return Pipeline;
+}
+
+void VulkanPipelineCache::LogStatistics() const
+{
+    uint32_t NumPipelines = m_Statistics.NumHits + m_Statistics.NumMisses + m_Statistics.NumUnknown;
+
+    DEBUG_DISPLAY("Pipeline cache: %u pipelines in %.2f ms, %u hits, %u misses, %u unknown",
+        NumPipelines, m_Statistics.CreationMilliseconds, m_Statistics.NumHits,
+        m_Statistics.NumMisses, m_Statistics.NumUnknown);
+    DEBUG_DISPLAY("Pipeline cache: loaded %zu bytes, saved %zu bytes", m_Statistics.LoadedBytes,
+        m_Statistics.SavedBytes);
+}
+
+std::span<const uint8_t> VulkanPipelineCache::Load(MappedFile& File)
+{
+    if (!File.Open(m_Path, FileAccessHint::SEQUENTIAL))
+    {
+        DEBUG_INFO("No pipeline cache at %s, starting cold", m_Path.string().c_str());
+        return {};
+    }
+
+    FileHeader Header = {};
+    if (File.GetSize() < sizeof(Header))
+    {
+        DEBUG_WARNING("Discarding pipeline cache: truncated header");
+        return {};
+    }
+
+    memcpy(&Header, File.GetData(), sizeof(Header));
+
+    if (Header.Magic != PIPELINE_CACHE_MAGIC || Header.Version != PIPELINE_CACHE_VERSION ||
+        Header.DataSize != File.GetSize() - sizeof(Header))
+    {
+        DEBUG_WARNING("Discarding pipeline cache: unknown format or size mismatch");
+        return {};
+    }
+
+    std::span<const uint8_t> Data = File.GetSpan(sizeof(Header), Header.DataSize);
+    if (Utility::Hash(Data.data(), Data.size()) != Header.Checksum)
+    {
+        DEBUG_WARNING("Discarding pipeline cache: checksum mismatch");
+        return {};
+    }
+
+    const char* Reason = nullptr;
+    if (!Validate(Data, &Reason))
+    {
+        DEBUG_WARNING("Discarding pipeline cache: %s", Reason);
+        return {};
+    }
+
+    return Data;
+}
+
+bool VulkanPipelineCache::Validate(std::span<const uint8_t> Data, const char** OutReason) const
+{
+    VkPipelineCacheHeaderVersionOne Header;
+
+    if (Data.size() < sizeof(Header))
+    {
+        *OutReason = "truncated driver header";
+        return false;
+    }
+
+    memcpy(&Header, Data.data(), sizeof(Header));
+
+    if (Header.headerSize < sizeof(Header) ||
+        Header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+    {
+        *OutReason = "unsupported driver header version";
+        return false;
+    }
+
+    if (Header.vendorID != m_Properties.vendorID || Header.deviceID != m_Properties.deviceID)
+    {
+        *OutReason = "created on a different device";
+        return false;
+    }
+
+    // The UUID changes with the driver version as well
+    if (memcmp(Header.pipelineCacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        *OutReason = "created by a different driver";
+        return false;
+    }
+
+    return true;
+}
+
+void VulkanPipelineCache::RecordFeedback(
+    const VkPipelineCreationFeedback& Feedback, double Milliseconds)
+{
+    std::lock_guard<std::mutex> Lock(m_StatisticsMutex);
+
+    m_Statistics.CreationMilliseconds += Milliseconds;
+
+    if (!m_CreationFeedback || (Feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) == 0)
+    {
+        m_Statistics.NumUnknown++;
+    }
+    else if (Feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT)
+    {
+        m_Statistics.NumHits++;
+    }
+    else
+    {
+        m_Statistics.NumMisses++;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "MappedFile.h"
+#include "pch.h"
+
+#define PIPELINE_CACHE_MAGIC 0x48435056  // "VPCH"
+#define PIPELINE_CACHE_VERSION 1
+
+struct VulkanPipelineCacheStatistics
+{
+    size_t LoadedBytes = 0;
+    size_t SavedBytes = 0;
+    uint32_t NumHits = 0;
+    uint32_t NumMisses = 0;
+    uint32_t NumUnknown = 0;
+    double CreationMilliseconds = 0.0;
+};
+
+// VkPipelineCache persisted between runs. The driver blob is wrapped in a small header carrying
+// its size and checksum, and is only handed back to the driver when its own header matches the
+// current device. Saving writes a temporary file and renames it over the previous cache.
+// Pipelines may be created from any thread
+class VulkanPipelineCache
+{
+public:
+    VulkanPipelineCache();
+    ~VulkanPipelineCache() = default;
+    void Init(VkPhysicalDevice PhysicalDevice, VkDevice Device, const std::filesystem::path& Path,
+        bool CreationFeedback);
+    void Destroy();
+    void Save();
+
+    VkPipeline CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& Info);
+    VkPipeline CreateComputePipeline(const VkComputePipelineCreateInfo& Info);
+
+    VkPipelineCache GetHandle() const { return m_Handle; }
+    const VulkanPipelineCacheStatistics& GetStatistics() const { return m_Statistics; }
+    void LogStatistics() const;
+
+private:
+    struct FileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t DataSize;
+        uint64_t Checksum;
+    };
+
+    // The driver blob inside the file, empty when there is none that can be used
+    std::span<const uint8_t> Load(MappedFile& File);
+    bool Validate(std::span<const uint8_t> Data, const char** OutReason) const;
+    void RecordFeedback(const VkPipelineCreationFeedback& Feedback, double Milliseconds);
+
+    VkPhysicalDeviceProperties m_Properties;
+    VkDevice m_Device;
+    VkPipelineCache m_Handle;
+    std::filesystem::path m_Path;
+    bool m_CreationFeedback;
+    std::mutex m_StatisticsMutex;
+    VulkanPipelineCacheStatistics m_Statistics;
+};
@@ -0,0 +1,540 @@
+#include "VulkanUploadManager.h"
+#include "VulkanUtility.h"
+
+#define STAGING_BUFFER_ALIGNMENT 4
+#define STAGING_IMAGE_ALIGNMENT 16
+
+static bool Overlaps(const VkImageMemoryBarrier& A, const VkImageMemoryBarrier& B)
+{
+    const VkImageSubresourceRange& RangeA = A.subresourceRange;
+    const VkImageSubresourceRange& RangeB = B.subresourceRange;
+
+    return A.image == B.image && RangeA.baseMipLevel == RangeB.baseMipLevel &&
+           (RangeA.aspectMask & RangeB.aspectMask) &&
+           RangeA.baseArrayLayer < RangeB.baseArrayLayer + RangeB.layerCount &&
+           RangeB.baseArrayLayer < RangeA.baseArrayLayer + RangeA.layerCount;
+}
+
+VulkanUploadManager::VulkanUploadManager()
+    : m_Device(VK_NULL_HANDLE),
+      m_Queue(VK_NULL_HANDLE),
+      m_FamilyIndex(0),
+      m_GraphicsFamilyIndex(0),
+      m_Timeline(VK_NULL_HANDLE),
+      m_Fence(VK_NULL_HANDLE),
+      m_SubmittedValue(0),
+      m_CompletedValue(0),
+      m_GraphicsWaitValue(0),
+      m_StagingBuffer(VK_NULL_HANDLE),
+      m_UploadedBytes(0),
+      m_NumFlushes(0)
+{
+}
+
+void VulkanUploadManager::Init(VkDevice Device, VulkanMemoryAllocator& Allocator, VkQueue Queue,
+    uint32_t FamilyIndex, uint32_t GraphicsFamilyIndex, bool TimelineSemaphores,
+    VkDeviceSize StagingSize)
+{
+    m_Device = Device;
+    m_Queue = Queue;
+    m_FamilyIndex = FamilyIndex;
+    m_GraphicsFamilyIndex = GraphicsFamilyIndex;
+
+    if (TimelineSemaphores)
+    {
+        VkSemaphoreTypeCreateInfo TypeInfo = {};
+        TypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        TypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        TypeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo SemaphoreInfo = {};
+        SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        SemaphoreInfo.pNext = &TypeInfo;
+
+        VULKAN_RESULT(vkCreateSemaphore(m_Device, &SemaphoreInfo, nullptr, &m_Timeline));
+    }
+    else
+    {
+        VkFenceCreateInfo FenceInfo = {};
+        FenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        VULKAN_RESULT(vkCreateFence(m_Device, &FenceInfo, nullptr, &m_Fence));
+    }
+
+    VkBufferCreateInfo BufferInfo = {};
+    BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferInfo.size = StagingSize;
+    BufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VULKAN_RESULT(vkCreateBuffer(m_Device, &BufferInfo, nullptr, &m_StagingBuffer));
+
+    VkMemoryRequirements Requirements;
+    vkGetBufferMemoryRequirements(m_Device, m_StagingBuffer, &Requirements);
+
+    m_StagingRing.Init(Allocator, Requirements,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        VulkanLinearPoolMode::RING, StagingSize);
+
+    const VulkanAllocation& Allocation = m_StagingRing.GetAllocation();
+    VULKAN_RESULT(
+        vkBindBufferMemory(m_Device, m_StagingBuffer, Allocation.Memory, Allocation.Offset));
+
+    DEBUG_DISPLAY("Upload queue: %s (family %u)",
+        IsDedicatedQueue() ? "Dedicated transfer" : "Graphics", m_FamilyIndex);
+    DEBUG_DISPLAY("Staging ring: %llu MB", StagingSize / (1024 * 1024));
+}
+
+void VulkanUploadManager::Destroy()
+{
+    if (!m_Device)
+    {
+        return;
+    }
+
+    Flush();
+    WaitForValue(m_SubmittedValue);
+
+    DEBUG_DISPLAY("Uploaded %.2f MB in %u batches, staging peak %.2f MB",
+        m_UploadedBytes / (1024.0 * 1024.0), m_NumFlushes,
+        m_StagingRing.GetPeakUsedSize() / (1024.0 * 1024.0));
+
+    for (auto& Batch : m_Batches)
+    {
+        vkDestroyCommandPool(m_Device, Batch.CommandPool, nullptr);
+    }
+    m_Batches.clear();
+
+    m_StagingRing.Destroy();
+    vkDestroyBuffer(m_Device, m_StagingBuffer, nullptr);
+    m_StagingBuffer = VK_NULL_HANDLE;
+
+    if (m_Timeline)
+    {
+        vkDestroySemaphore(m_Device, m_Timeline, nullptr);
+        m_Timeline = VK_NULL_HANDLE;
+    }
+
+    if (m_Fence)
+    {
+        vkDestroyFence(m_Device, m_Fence, nullptr);
+        m_Fence = VK_NULL_HANDLE;
+    }
+
+    m_AcquireBufferBarriers.clear();
+    m_AcquireImageBarriers.clear();
+    m_Device = VK_NULL_HANDLE;
+}
+
+void VulkanUploadManager::UploadBuffer(
+    VkBuffer Buffer, VkDeviceSize Offset, const void* Data, VkDeviceSize Size)
+{
+    const uint8_t* Source = static_cast<const uint8_t*>(Data);
+
+    // Anything larger than the ring goes through it in pieces
+    while (Size > 0)
+    {
+        VkDeviceSize ChunkSize = std::min(Size, m_StagingRing.GetSize());
+
+        VkDeviceSize StagingOffset;
+        void* Destination = AllocateStaging(ChunkSize, STAGING_BUFFER_ALIGNMENT, &StagingOffset);
+        memcpy(Destination, Source, ChunkSize);
+
+        VulkanBufferUpload Upload;
+        Upload.Buffer = Buffer;
+        Upload.Region.srcOffset = StagingOffset;
+        Upload.Region.dstOffset = Offset;
+        Upload.Region.size = ChunkSize;
+        m_PendingBufferUploads.push_back(Upload);
+
+        m_UploadedBytes += ChunkSize;
+        Source += ChunkSize;
+        Offset += ChunkSize;
+        Size -= ChunkSize;
+    }
+}
+
+void VulkanUploadManager::UploadImage(VkImage Image, const VkImageSubresourceLayers& Subresource,
+    VkExtent3D Extent, const void* Data, VkDeviceSize Size, VkImageLayout FinalLayout)
+{
+    CHECK(Size <= m_StagingRing.GetSize(), "Image upload of %llu bytes exceeds the staging ring",
+        Size);
+
+    VkDeviceSize StagingOffset;
+    void* Destination = AllocateStaging(Size, STAGING_IMAGE_ALIGNMENT, &StagingOffset);
+    memcpy(Destination, Data, Size);
+
+    VulkanImageUpload Upload;
+    Upload.Image = Image;
+    Upload.Region = {};
+    Upload.Region.bufferOffset = StagingOffset;
+    Upload.Region.imageSubresource = Subresource;
+    Upload.Region.imageExtent = Extent;
+    Upload.FinalLayout = FinalLayout;
+    m_PendingImageUploads.push_back(Upload);
+
+    m_UploadedBytes += Size;
+}
+
+uint64_t VulkanUploadManager::Flush()
+{
+    if (m_PendingBufferUploads.empty() && m_PendingImageUploads.empty())
+    {
+        return m_SubmittedValue;
+    }
+
+    VulkanUploadBatch& Batch = GetFreeBatch();
+
+    VkCommandBufferBeginInfo BeginInfo = {};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VULKAN_RESULT(vkBeginCommandBuffer(Batch.CommandBuffer, &BeginInfo));
+
+    // Every uploaded subresource is overwritten entirely, so its previous contents can be dropped.
+    // A layout may only be transitioned once per barrier command, so overlapping uploads share one
+    // barrier covering all of them
+    std::vector<VkImageMemoryBarrier> UploadBarriers(m_PendingImageUploads.size());
+    std::vector<VkImageMemoryBarrier> ImageBarriers;
+
+    for (uint32_t Index = 0; Index < m_PendingImageUploads.size(); ++Index)
+    {
+        const VulkanImageUpload& Upload = m_PendingImageUploads[Index];
+
+        VkImageMemoryBarrier& Barrier = UploadBarriers[Index];
+        Barrier = {};
+        Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        Barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        Barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.image = Upload.Image;
+        Barrier.subresourceRange.aspectMask = Upload.Region.imageSubresource.aspectMask;
+        Barrier.subresourceRange.baseMipLevel = Upload.Region.imageSubresource.mipLevel;
+        Barrier.subresourceRange.levelCount = 1;
+        Barrier.subresourceRange.baseArrayLayer = Upload.Region.imageSubresource.baseArrayLayer;
+        Barrier.subresourceRange.layerCount = Upload.Region.imageSubresource.layerCount;
+
+        // A widened barrier can reach others, those are folded into it as well. The union of
+        // overlapping layer ranges is still entirely written by this batch
+        VkImageMemoryBarrier Merged = Barrier;
+        for (auto It = ImageBarriers.begin(); It != ImageBarriers.end();)
+        {
+            if (!Overlaps(*It, Merged))
+            {
+                ++It;
+                continue;
+            }
+
+            VkImageSubresourceRange& Range = Merged.subresourceRange;
+            uint32_t EndLayer = std::max(Range.baseArrayLayer + Range.layerCount,
+                It->subresourceRange.baseArrayLayer + It->subresourceRange.layerCount);
+            Range.aspectMask |= It->subresourceRange.aspectMask;
+            Range.baseArrayLayer =
+                std::min(Range.baseArrayLayer, It->subresourceRange.baseArrayLayer);
+            Range.layerCount = EndLayer - Range.baseArrayLayer;
+
+            ImageBarriers.erase(It);
+            It = ImageBarriers.begin();
+        }
+
+        ImageBarriers.push_back(Merged);
+    }
+
+    if (!ImageBarriers.empty())
+    {
+        vkCmdPipelineBarrier(Batch.CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+            static_cast<uint32_t>(ImageBarriers.size()), ImageBarriers.data());
+    }
+
+    // Copies into the same buffer are merged into a single command while their destinations are
+    // disjoint. An overlapping one starts a new command behind a barrier, so the later upload wins
+    std::stable_sort(m_PendingBufferUploads.begin(), m_PendingBufferUploads.end(),
+        [](const auto& A, const auto& B) { return A.Buffer < B.Buffer; });
+
+    std::vector<VkBufferCopy> Regions;
+    std::vector<VkBufferMemoryBarrier> BufferBarriers;
+
+    for (uint32_t Index = 0; Index < m_PendingBufferUploads.size(); ++Index)
+    {
+        const VulkanBufferUpload& Upload = m_PendingBufferUploads[Index];
+
+        bool Overlaps = std::any_of(Regions.begin(), Regions.end(),
+            [&Upload](const VkBufferCopy& Region)
+            {
+                return Region.dstOffset < Upload.Region.dstOffset + Upload.Region.size &&
+                       Upload.Region.dstOffset < Region.dstOffset + Region.size;
+            });
+
+        if (Overlaps)
+        {
+            vkCmdCopyBuffer(Batch.CommandBuffer, m_StagingBuffer, Upload.Buffer,
+                static_cast<uint32_t>(Regions.size()), Regions.data());
+            Regions.clear();
+
+            VkBufferMemoryBarrier Barrier = {};
+            Barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            Barrier.buffer = Upload.Buffer;
+            Barrier.offset = 0;
+            Barrier.size = VK_WHOLE_SIZE;
+
+            vkCmdPipelineBarrier(Batch.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &Barrier, 0, nullptr);
+        }
+
+        Regions.push_back(Upload.Region);
+
+        if (Index + 1 < m_PendingBufferUploads.size() &&
+            m_PendingBufferUploads[Index + 1].Buffer == Upload.Buffer)
+        {
+            continue;
+        }
+
+        vkCmdCopyBuffer(Batch.CommandBuffer, m_StagingBuffer, Upload.Buffer,
+            static_cast<uint32_t>(Regions.size()), Regions.data());
+        Regions.clear();
+
+        VkBufferMemoryBarrier Barrier = {};
+        Barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        Barrier.srcQueueFamilyIndex = m_FamilyIndex;
+        Barrier.dstQueueFamilyIndex = m_GraphicsFamilyIndex;
+        Barrier.buffer = Upload.Buffer;
+        Barrier.offset = 0;
+        Barrier.size = VK_WHOLE_SIZE;
+        BufferBarriers.push_back(Barrier);
+    }
+
+    // Copies into an already written range wait for the earlier ones, so the later upload wins.
+    // Its final layout also wins when uploads to the same subresource disagree
+    std::vector<bool> Written(ImageBarriers.size(), false);
+    std::vector<VkImageLayout> FinalLayouts(ImageBarriers.size());
+
+    for (uint32_t Index = 0; Index < m_PendingImageUploads.size(); ++Index)
+    {
+        const VulkanImageUpload& Upload = m_PendingImageUploads[Index];
+        const VkImageMemoryBarrier& UploadBarrier = UploadBarriers[Index];
+
+        uint32_t BarrierIndex = 0;
+        while (!Overlaps(ImageBarriers[BarrierIndex], UploadBarrier))
+        {
+            BarrierIndex++;
+        }
+
+        if (Written[BarrierIndex])
+        {
+            VkImageMemoryBarrier Barrier = ImageBarriers[BarrierIndex];
+            Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+            vkCmdPipelineBarrier(Batch.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &Barrier);
+        }
+
+        vkCmdCopyBufferToImage(Batch.CommandBuffer, m_StagingBuffer, Upload.Image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Upload.Region);
+
+        Written[BarrierIndex] = true;
+        FinalLayouts[BarrierIndex] = Upload.FinalLayout;
+    }
+
+    for (uint32_t Index = 0; Index < ImageBarriers.size(); ++Index)
+    {
+        VkImageMemoryBarrier& Barrier = ImageBarriers[Index];
+        Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        Barrier.dstAccessMask = 0;
+        Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        Barrier.newLayout = FinalLayouts[Index];
+        Barrier.srcQueueFamilyIndex = m_FamilyIndex;
+        Barrier.dstQueueFamilyIndex = m_GraphicsFamilyIndex;
+    }
+
+    // On a shared family the semaphore wait already makes the copies visible, only the layouts
+    // still have to change. Otherwise these are the release halves of the ownership transfers
+    if (!IsDedicatedQueue())
+    {
+        BufferBarriers.clear();
+        for (auto& Barrier : ImageBarriers)
+        {
+            Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        }
+    }
+
+    if (!BufferBarriers.empty() || !ImageBarriers.empty())
+    {
+        vkCmdPipelineBarrier(Batch.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+            static_cast<uint32_t>(BufferBarriers.size()), BufferBarriers.data(),
+            static_cast<uint32_t>(ImageBarriers.size()), ImageBarriers.data());
+    }
+
+    if (IsDedicatedQueue())
+    {
+        for (auto& Barrier : BufferBarriers)
+        {
+            Barrier.srcAccessMask = 0;
+            Barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+            m_AcquireBufferBarriers.push_back(Barrier);
+        }
+
+        for (auto& Barrier : ImageBarriers)
+        {
+            Barrier.srcAccessMask = 0;
+            Barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+            m_AcquireImageBarriers.push_back(Barrier);
+        }
+    }
+
+    VULKAN_RESULT(vkEndCommandBuffer(Batch.CommandBuffer));
+
+    Batch.Value = ++m_SubmittedValue;
+
+    VkTimelineSemaphoreSubmitInfo TimelineInfo = {};
+    TimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    TimelineInfo.signalSemaphoreValueCount = 1;
+    TimelineInfo.pSignalSemaphoreValues = &Batch.Value;
+
+    VkSubmitInfo SubmitInfo = {};
+    SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.pNext = m_Timeline ? &TimelineInfo : nullptr;
+    SubmitInfo.commandBufferCount = 1;
+    SubmitInfo.pCommandBuffers = &Batch.CommandBuffer;
+    SubmitInfo.signalSemaphoreCount = m_Timeline ? 1 : 0;
+    SubmitInfo.pSignalSemaphores = &m_Timeline;
+
+    VULKAN_RESULT(vkQueueSubmit(m_Queue, 1, &SubmitInfo, m_Fence));
+
+    m_StagingRing.Fence(Batch.Value);
+    m_GraphicsWaitValue = Batch.Value;
+    m_PendingBufferUploads.clear();
+    m_PendingImageUploads.clear();
+    m_NumFlushes++;
+
+    // Without timeline semaphores there is nothing the graphics queue could wait on, the copies
+    // are completed on the CPU instead
+    if (!m_Timeline)
+    {
+        WaitForValue(Batch.Value);
+    }
+
+    return Batch.Value;
+}
+
+uint64_t VulkanUploadManager::GetCompletedValue()
+{
+    if (m_Timeline)
+    {
+        VULKAN_RESULT(vkGetSemaphoreCounterValue(m_Device, m_Timeline, &m_CompletedValue));
+    }
+
+    return m_CompletedValue;
+}
+
+void VulkanUploadManager::WaitForValue(uint64_t Value)
+{
+    DEBUG_ASSERT(Value <= m_SubmittedValue);
+
+    if (Value <= m_CompletedValue)
+    {
+        return;
+    }
+
+    if (m_Timeline)
+    {
+        VkSemaphoreWaitInfo WaitInfo = {};
+        WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        WaitInfo.semaphoreCount = 1;
+        WaitInfo.pSemaphores = &m_Timeline;
+        WaitInfo.pValues = &Value;
+
+        VULKAN_RESULT(vkWaitSemaphores(m_Device, &WaitInfo, UINT64_MAX));
+    }
+    else
+    {
+        // Fence mode completes every batch inside Flush, so only the latest one can be pending
+        VULKAN_RESULT(vkWaitForFences(m_Device, 1, &m_Fence, VK_TRUE, UINT64_MAX));
+        VULKAN_RESULT(vkResetFences(m_Device, 1, &m_Fence));
+    }
+
+    m_CompletedValue = Value;
+}
+
+uint64_t VulkanUploadManager::TakeGraphicsWaitValue()
+{
+    uint64_t Value = m_GraphicsWaitValue;
+    m_GraphicsWaitValue = 0;
+    return m_Timeline ? Value : 0;
+}
+
+bool VulkanUploadManager::HasPendingAcquires() const
+{
+    return !m_AcquireBufferBarriers.empty() || !m_AcquireImageBarriers.empty();
+}
+
+void VulkanUploadManager::RecordAcquireBarriers(VkCommandBuffer CommandBuffer)
+{
+    vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+        static_cast<uint32_t>(m_AcquireBufferBarriers.size()), m_AcquireBufferBarriers.data(),
+        static_cast<uint32_t>(m_AcquireImageBarriers.size()), m_AcquireImageBarriers.data());
+
+    m_AcquireBufferBarriers.clear();
+    m_AcquireImageBarriers.clear();
+}
+
+void* VulkanUploadManager::AllocateStaging(
+    VkDeviceSize Size, VkDeviceSize Alignment, VkDeviceSize* OutOffset)
+{
+    void* MappedData = nullptr;
+
+    m_StagingRing.Retire(GetCompletedValue());
+
+    // A full ring means earlier copies are still in flight, push out what is pending and wait for
+    // the oldest batch to free its range
+    while (!m_StagingRing.Allocate(Size, Alignment, OutOffset, &MappedData))
+    {
+        Flush();
+        WaitForValue(std::min(m_CompletedValue + 1, m_SubmittedValue));
+        m_StagingRing.Retire(m_CompletedValue);
+    }
+
+    return MappedData;
+}
+
+VulkanUploadBatch& VulkanUploadManager::GetFreeBatch()
+{
+    uint64_t CompletedValue = GetCompletedValue();
+
+    for (auto& Batch : m_Batches)
+    {
+        if (Batch.Value <= CompletedValue)
+        {
+            VULKAN_RESULT(vkResetCommandPool(m_Device, Batch.CommandPool, 0));
+            return Batch;
+        }
+    }
+
+    VulkanUploadBatch& Batch = m_Batches.emplace_back();
+
+    VkCommandPoolCreateInfo PoolInfo = {};
+    PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    PoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    PoolInfo.queueFamilyIndex = m_FamilyIndex;
+    VULKAN_RESULT(vkCreateCommandPool(m_Device, &PoolInfo, nullptr, &Batch.CommandPool));
+
+    VkCommandBufferAllocateInfo AllocateInfo = {};
+    AllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    AllocateInfo.commandPool = Batch.CommandPool;
+    AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    AllocateInfo.commandBufferCount = 1;
+    VULKAN_RESULT(vkAllocateCommandBuffers(m_Device, &AllocateInfo, &Batch.CommandBuffer));
+
+    return Batch;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "VulkanMemoryAllocator.h"
+#include "pch.h"
+
+#define DEFAULT_STAGING_RING_SIZE (32ull * 1024 * 1024)
+
+struct VulkanUploadBatch
+{
+    VkCommandPool CommandPool = VK_NULL_HANDLE;
+    VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+    uint64_t Value = 0;
+};
+
+struct VulkanBufferUpload
+{
+    VkBuffer Buffer;
+    VkBufferCopy Region;
+};
+
+struct VulkanImageUpload
+{
+    VkImage Image;
+    VkBufferImageCopy Region;
+    VkImageLayout FinalLayout;
+};
+
+// Streams data to device local resources through a persistently mapped staging ring. Copies are
+// batched until Flush and run on the transfer queue, the graphics queue only waits for them on the
+// GPU. With a dedicated transfer family the resources are released to the graphics family and the
+// matching acquire barriers are recorded by the graphics side
+class VulkanUploadManager
+{
+public:
+    VulkanUploadManager();
+    ~VulkanUploadManager() = default;
+    void Init(VkDevice Device, VulkanMemoryAllocator& Allocator, VkQueue Queue,
+        uint32_t FamilyIndex, uint32_t GraphicsFamilyIndex, bool TimelineSemaphores,
+        VkDeviceSize StagingSize = DEFAULT_STAGING_RING_SIZE);
+    void Destroy();
+
+    void UploadBuffer(VkBuffer Buffer, VkDeviceSize Offset, const void* Data, VkDeviceSize Size);
+    void UploadImage(VkImage Image, const VkImageSubresourceLayers& Subresource,
+        VkExtent3D Extent, const void* Data, VkDeviceSize Size, VkImageLayout FinalLayout);
+    uint64_t Flush();
+    uint64_t GetCompletedValue();
+    void WaitForValue(uint64_t Value);
+
+    bool IsDedicatedQueue() const { return m_FamilyIndex != m_GraphicsFamilyIndex; }
+    VkSemaphore GetTimelineSemaphore() const { return m_Timeline; }
+    uint64_t TakeGraphicsWaitValue();
+    bool HasPendingAcquires() const;
+    void RecordAcquireBarriers(VkCommandBuffer CommandBuffer);
+
+private:
+    void* AllocateStaging(VkDeviceSize Size, VkDeviceSize Alignment, VkDeviceSize* OutOffset);
+    VulkanUploadBatch& GetFreeBatch();
+
+    VkDevice m_Device;
+    VkQueue m_Queue;
+    uint32_t m_FamilyIndex;
+    uint32_t m_GraphicsFamilyIndex;
+    VkSemaphore m_Timeline;
+    VkFence m_Fence;
+    uint64_t m_SubmittedValue;
+    uint64_t m_CompletedValue;
+    uint64_t m_GraphicsWaitValue;
+    VkBuffer m_StagingBuffer;
+    VulkanLinearPool m_StagingRing;
+    std::vector<VulkanUploadBatch> m_Batches;
+    std::vector<VulkanBufferUpload> m_PendingBufferUploads;
+    std::vector<VulkanImageUpload> m_PendingImageUploads;
+    std::vector<VkBufferMemoryBarrier> m_AcquireBufferBarriers;
+    std::vector<VkImageMemoryBarrier> m_AcquireImageBarriers;
+    uint64_t m_UploadedBytes;
+    uint32_t m_NumFlushes;
+};
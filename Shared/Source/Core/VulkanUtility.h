@@ -0,0 +1,16 @@
+#pragma once
+#include "pch.h"
+
+#define VULKAN_RESULT(Expression)                                                            \
+    {                                                                                        \
+        VkResult ResultValue = Expression;                                                   \
+        CHECK(ResultValue == VK_SUCCESS, "Vulkan Error (%d): %s", ResultValue, #Expression); \
+    }
+
+namespace VulkanUtility
+{
+    inline VkDeviceSize AlignUp(VkDeviceSize Value, VkDeviceSize Alignment)
+    {
+        return Alignment > 1 ? (Value + Alignment - 1) & ~(Alignment - 1) : Value;
+    }
+}  // namespace VulkanUtility
@@ -1,17 +1,32 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstdarg>
+#include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
 #include "Core/Utility.h"
-#include "Core/Logger.h"
\ No newline at end of file
+#include "Core/Logger.h"
+#include "Core/Profiler.h"
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "MeshCooker.h"
+
+static void PrintUsage()
+{
+    std::printf(
+        "Usage: MeshCooker <input> <output> [--quantize] [--scale <factor>] [--no-optimize]\n");
+}
+
+int main(int NumArguments, char** Arguments)
+{
+    if (NumArguments < 3)
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path InputPath = Arguments[1];
+    std::filesystem::path OutputPath = Arguments[2];
+    MeshCookerOptions Options;
+
+    for (int Index = 3; Index < NumArguments; ++Index)
+    {
+        std::string_view Argument = Arguments[Index];
+
+        if (Argument == "--quantize")
+        {
+            Options.Quantize = true;
+        }
+        else if (Argument == "--no-optimize")
+        {
+            Options.Optimize = false;
+        }
+        else if (Argument == "--scale" && Index + 1 < NumArguments)
+        {
+            Options.Scale = std::strtof(Arguments[++Index], nullptr);
+        }
+        else
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto Start = std::chrono::steady_clock::now();
+
+    MeshCooker Cooker(Options);
+    if (!Cooker.Import(InputPath) || !Cooker.Write(OutputPath))
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::chrono::duration<double, std::milli> Elapsed = std::chrono::steady_clock::now() - Start;
+
+    std::printf("Cooked %s to %s in %.1f ms\n", InputPath.string().c_str(),
+        OutputPath.string().c_str(), Elapsed.count());
+    Cooker.PrintStatistics();
+    return EXIT_SUCCESS;
+}
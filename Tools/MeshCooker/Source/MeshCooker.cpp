@@ -0,0 +1,405 @@
+#include "MeshCooker.h"
+
+#include <cfloat>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+static uint64_t AlignOffset(uint64_t Offset)
+{
+    return (Offset + MESH_FILE_ALIGNMENT - 1) & ~uint64_t(MESH_FILE_ALIGNMENT - 1);
+}
+
+static uint16_t QuantizeUnorm16(float Value, float Min, float Max)
+{
+    float Normalized = Max > Min ? (Value - Min) / (Max - Min) : 0.0f;
+    return static_cast<uint16_t>(std::lround(std::clamp(Normalized, 0.0f, 1.0f) * 65535.0f));
+}
+
+// A2B10G10R10_SNORM_PACK32, x in the low bits
+static uint32_t PackSnorm1010102(float X, float Y, float Z, float W)
+{
+    auto Pack = [](float Value, float Scale, uint32_t Mask)
+    { return static_cast<uint32_t>(std::lround(std::clamp(Value, -1.0f, 1.0f) * Scale)) & Mask; };
+
+    return Pack(X, 511.0f, 0x3ff) | (Pack(Y, 511.0f, 0x3ff) << 10) |
+           (Pack(Z, 511.0f, 0x3ff) << 20) | (Pack(W, 1.0f, 0x3) << 30);
+}
+
+// Rounds to nearest even, out of range values become infinity
+static uint16_t FloatToHalf(float Value)
+{
+    uint32_t Bits = std::bit_cast<uint32_t>(Value);
+    uint32_t Sign = (Bits >> 16) & 0x8000;
+    uint32_t Mantissa = Bits & 0x7fffff;
+    int32_t Exponent = static_cast<int32_t>((Bits >> 23) & 0xff) - 127 + 15;
+
+    if (((Bits >> 23) & 0xff) == 0xff)
+    {
+        return static_cast<uint16_t>(Sign | 0x7c00 | (Mantissa ? 0x200 : 0));
+    }
+
+    if (Exponent >= 31)
+    {
+        return static_cast<uint16_t>(Sign | 0x7c00);
+    }
+
+    uint32_t Shift = 13;
+    uint32_t Half = Sign | (static_cast<uint32_t>(std::max(Exponent, 0)) << 10);
+
+    // Subnormal, the implicit one becomes part of the mantissa
+    if (Exponent <= 0)
+    {
+        if (Exponent < -10)
+        {
+            return static_cast<uint16_t>(Sign);
+        }
+
+        Mantissa |= 0x800000;
+        Shift = static_cast<uint32_t>(14 - Exponent);
+    }
+
+    uint32_t Remainder = Mantissa & ((1u << Shift) - 1);
+    uint32_t HalfWay = 1u << (Shift - 1);
+    Half |= Mantissa >> Shift;
+
+    // A carry out of the mantissa correctly moves on to the next exponent
+    if (Remainder > HalfWay || (Remainder == HalfWay && (Half & 1)))
+    {
+        Half++;
+    }
+
+    return static_cast<uint16_t>(Half);
+}
+
+MeshCooker::MeshCooker(const MeshCookerOptions& Options) : m_Options(Options), m_Bounds({}) {}
+
+bool MeshCooker::Import(const std::filesystem::path& Path)
+{
+    Assimp::Importer Importer;
+    Importer.SetPropertyInteger(
+        AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+    Importer.SetPropertyFloat(AI_CONFIG_GLOBAL_SCALE_FACTOR_KEY, m_Options.Scale);
+
+    // Pretransforming bakes the node hierarchy and merges the meshes that share a material. UVs
+    // are flipped to the top left origin Vulkan samples with
+    uint32_t Flags = aiProcess_Triangulate | aiProcess_SortByPType |
+                     aiProcess_PreTransformVertices | aiProcess_JoinIdenticalVertices |
+                     aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace | aiProcess_FlipUVs |
+                     aiProcess_GlobalScale | aiProcess_RemoveRedundantMaterials |
+                     aiProcess_FindInvalidData | aiProcess_ValidateDataStructure;
+
+    const aiScene* Scene = Importer.ReadFile(Path.string(), Flags);
+
+    if (!Scene || (Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !Scene->mRootNode)
+    {
+        std::fprintf(stderr, "Failed to import %s: %s\n", Path.string().c_str(),
+            Importer.GetErrorString());
+        return false;
+    }
+
+    for (uint32_t MeshIndex = 0; MeshIndex < Scene->mNumMeshes; ++MeshIndex)
+    {
+        const aiMesh* Mesh = Scene->mMeshes[MeshIndex];
+
+        if ((Mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) == 0 || !Mesh->HasFaces())
+        {
+            continue;
+        }
+
+        MeshSubmesh Submesh = {};
+        Submesh.FirstIndex = static_cast<uint32_t>(m_Indices.size());
+        Submesh.FirstVertex = static_cast<uint32_t>(m_Vertices.size());
+        Submesh.NumVertices = Mesh->mNumVertices;
+        Submesh.MaterialIndex = Mesh->mMaterialIndex;
+
+        for (uint32_t Index = 0; Index < Mesh->mNumVertices; ++Index)
+        {
+            MeshVertex Vertex = {};
+            aiVector3D Position = Mesh->mVertices[Index];
+            aiVector3D Normal = Mesh->HasNormals() ? Mesh->mNormals[Index] : aiVector3D(0, 0, 1);
+
+            Vertex.Position[0] = Position.x;
+            Vertex.Position[1] = Position.y;
+            Vertex.Position[2] = Position.z;
+            Vertex.Normal[0] = Normal.x;
+            Vertex.Normal[1] = Normal.y;
+            Vertex.Normal[2] = Normal.z;
+            Vertex.Tangent[0] = 1.0f;
+            Vertex.Tangent[3] = 1.0f;
+
+            if (Mesh->HasTangentsAndBitangents())
+            {
+                aiVector3D Tangent = Mesh->mTangents[Index];
+                aiVector3D Bitangent = Mesh->mBitangents[Index];
+
+                // Mirrored UVs flip the bitangent, the shader rebuilds it from the sign
+                Vertex.Tangent[0] = Tangent.x;
+                Vertex.Tangent[1] = Tangent.y;
+                Vertex.Tangent[2] = Tangent.z;
+                Vertex.Tangent[3] = ((Normal ^ Tangent) * Bitangent) < 0.0f ? -1.0f : 1.0f;
+            }
+
+            if (Mesh->HasTextureCoords(0))
+            {
+                Vertex.TexCoord[0] = Mesh->mTextureCoords[0][Index].x;
+                Vertex.TexCoord[1] = Mesh->mTextureCoords[0][Index].y;
+            }
+
+            m_Vertices.push_back(Vertex);
+        }
+
+        for (uint32_t FaceIndex = 0; FaceIndex < Mesh->mNumFaces; ++FaceIndex)
+        {
+            const aiFace& Face = Mesh->mFaces[FaceIndex];
+
+            if (Face.mNumIndices == 3)
+            {
+                m_Indices.insert(m_Indices.end(), Face.mIndices, Face.mIndices + 3);
+            }
+        }
+
+        Submesh.NumIndices = static_cast<uint32_t>(m_Indices.size()) - Submesh.FirstIndex;
+        m_Submeshes.push_back(Submesh);
+    }
+
+    if (m_Submeshes.empty())
+    {
+        std::fprintf(stderr, "No triangles in %s\n", Path.string().c_str());
+        return false;
+    }
+
+    if (m_Options.Optimize)
+    {
+        Optimize();
+    }
+
+    ComputeBounds();
+    return true;
+}
+
+bool MeshCooker::Write(const std::filesystem::path& Path) const
+{
+    bool LargeIndices = UsesLargeIndices();
+    std::vector<uint8_t> Vertices = EncodeVertices();
+
+    std::vector<uint8_t> Indices(m_Indices.size() * (LargeIndices ? 4 : 2));
+    for (size_t Index = 0; Index < m_Indices.size(); ++Index)
+    {
+        if (LargeIndices)
+        {
+            std::memcpy(Indices.data() + Index * 4, &m_Indices[Index], 4);
+        }
+        else
+        {
+            uint16_t Value = static_cast<uint16_t>(m_Indices[Index]);
+            std::memcpy(Indices.data() + Index * 2, &Value, 2);
+        }
+    }
+
+    MeshFileHeader Header = {};
+    Header.Magic = MESH_FILE_MAGIC;
+    Header.Version = MESH_FILE_VERSION;
+    Header.Flags = (m_Options.Quantize ? MESH_FLAG_QUANTIZED : 0) |
+                   (LargeIndices ? MESH_FLAG_32BIT_INDICES : 0);
+    Header.VertexStride = static_cast<uint32_t>(
+        m_Options.Quantize ? sizeof(MeshQuantizedVertex) : sizeof(MeshVertex));
+    Header.NumVertices = static_cast<uint32_t>(m_Vertices.size());
+    Header.NumIndices = static_cast<uint32_t>(m_Indices.size());
+    Header.NumSubmeshes = static_cast<uint32_t>(m_Submeshes.size());
+    Header.Bounds = m_Bounds;
+    Header.SubmeshOffset = AlignOffset(sizeof(Header));
+    Header.VertexOffset =
+        AlignOffset(Header.SubmeshOffset + m_Submeshes.size() * sizeof(MeshSubmesh));
+    Header.IndexOffset = AlignOffset(Header.VertexOffset + Vertices.size());
+
+    std::vector<uint8_t> Data(Header.IndexOffset + Indices.size(), 0);
+    std::memcpy(Data.data(), &Header, sizeof(Header));
+    std::memcpy(Data.data() + Header.SubmeshOffset, m_Submeshes.data(),
+        m_Submeshes.size() * sizeof(MeshSubmesh));
+    std::memcpy(Data.data() + Header.VertexOffset, Vertices.data(), Vertices.size());
+    std::memcpy(Data.data() + Header.IndexOffset, Indices.data(), Indices.size());
+
+    // A failed cook leaves the previous output in place
+    std::filesystem::path TemporaryPath = Path;
+    TemporaryPath += ".tmp";
+
+    {
+        std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+        File.write(reinterpret_cast<const char*>(Data.data()), Data.size());
+        File.flush();
+
+        if (!File)
+        {
+            std::fprintf(stderr, "Failed to write %s\n", TemporaryPath.string().c_str());
+            return false;
+        }
+    }
+
+    std::error_code Error;
+    std::filesystem::rename(TemporaryPath, Path, Error);
+
+    if (Error)
+    {
+        std::fprintf(stderr, "Failed to replace %s: %s\n", Path.string().c_str(),
+            Error.message().c_str());
+        std::filesystem::remove(TemporaryPath, Error);
+        return false;
+    }
+
+    return true;
+}
+
+void MeshCooker::PrintStatistics() const
+{
+    size_t VertexSize = m_Options.Quantize ? sizeof(MeshQuantizedVertex) : sizeof(MeshVertex);
+    size_t IndexSize = UsesLargeIndices() ? 4 : 2;
+
+    std::printf("%zu submeshes, %zu vertices of %zu bytes, %zu triangles with %zu byte indices\n",
+        m_Submeshes.size(), m_Vertices.size(), VertexSize, m_Indices.size() / 3, IndexSize);
+    std::printf("Bounds (%.3f %.3f %.3f) to (%.3f %.3f %.3f), radius %.3f\n", m_Bounds.Min[0],
+        m_Bounds.Min[1], m_Bounds.Min[2], m_Bounds.Max[0], m_Bounds.Max[1], m_Bounds.Max[2],
+        m_Bounds.Radius);
+
+    if (m_Options.Optimize)
+    {
+        std::printf("Vertex cache of %u: ACMR %.3f to %.3f, ATVR %.3f to %.3f\n",
+            MESH_OPTIMIZER_CACHE_SIZE, m_CacheBefore.GetACMR(), m_CacheAfter.GetACMR(),
+            m_CacheBefore.GetATVR(), m_CacheAfter.GetATVR());
+    }
+}
+
+void MeshCooker::Optimize()
+{
+    std::vector<MeshVertex> Vertices;
+    Vertices.reserve(m_Vertices.size());
+
+    for (MeshSubmesh& Submesh : m_Submeshes)
+    {
+        std::span<MeshVertex> SubmeshVertices(
+            m_Vertices.data() + Submesh.FirstVertex, Submesh.NumVertices);
+        std::span<uint32_t> SubmeshIndices(
+            m_Indices.data() + Submesh.FirstIndex, Submesh.NumIndices);
+
+        AnalyzeVertexCache(
+            SubmeshIndices, Submesh.NumVertices, MESH_OPTIMIZER_CACHE_SIZE, m_CacheBefore);
+
+        std::vector<uint32_t> Clusters = OptimizeVertexCache(
+            SubmeshIndices, Submesh.NumVertices, MESH_OPTIMIZER_CACHE_SIZE);
+        OptimizeOverdraw(SubmeshIndices, SubmeshVertices, Clusters, MESH_OPTIMIZER_CACHE_SIZE,
+            MESH_OPTIMIZER_OVERDRAW_THRESHOLD);
+
+        AnalyzeVertexCache(
+            SubmeshIndices, Submesh.NumVertices, MESH_OPTIMIZER_CACHE_SIZE, m_CacheAfter);
+
+        // Fetch order last, it renames the vertices and drops the unreferenced ones
+        Submesh.NumVertices = OptimizeVertexFetch(SubmeshVertices, SubmeshIndices);
+        Submesh.FirstVertex = static_cast<uint32_t>(Vertices.size());
+        Vertices.insert(
+            Vertices.end(), SubmeshVertices.begin(), SubmeshVertices.begin() + Submesh.NumVertices);
+    }
+
+    m_Vertices = std::move(Vertices);
+}
+
+void MeshCooker::ComputeBounds()
+{
+    auto Compute = [this](uint32_t FirstVertex, uint32_t NumVertices)
+    {
+        MeshBounds Bounds = {};
+
+        for (uint32_t Axis = 0; Axis < 3; ++Axis)
+        {
+            Bounds.Min[Axis] = FLT_MAX;
+            Bounds.Max[Axis] = -FLT_MAX;
+        }
+
+        for (uint32_t Index = FirstVertex; Index < FirstVertex + NumVertices; ++Index)
+        {
+            for (uint32_t Axis = 0; Axis < 3; ++Axis)
+            {
+                Bounds.Min[Axis] = std::min(Bounds.Min[Axis], m_Vertices[Index].Position[Axis]);
+                Bounds.Max[Axis] = std::max(Bounds.Max[Axis], m_Vertices[Index].Position[Axis]);
+            }
+        }
+
+        for (uint32_t Axis = 0; Axis < 3; ++Axis)
+        {
+            Bounds.Center[Axis] = (Bounds.Min[Axis] + Bounds.Max[Axis]) * 0.5f;
+        }
+
+        // Around the box center, tighter than the half diagonal for most meshes
+        float RadiusSquared = 0.0f;
+        for (uint32_t Index = FirstVertex; Index < FirstVertex + NumVertices; ++Index)
+        {
+            float DistanceSquared = 0.0f;
+            for (uint32_t Axis = 0; Axis < 3; ++Axis)
+            {
+                float Delta = m_Vertices[Index].Position[Axis] - Bounds.Center[Axis];
+                DistanceSquared += Delta * Delta;
+            }
+
+            RadiusSquared = std::max(RadiusSquared, DistanceSquared);
+        }
+
+        Bounds.Radius = std::sqrt(RadiusSquared);
+        return Bounds;
+    };
+
+    for (MeshSubmesh& Submesh : m_Submeshes)
+    {
+        Submesh.Bounds = Compute(Submesh.FirstVertex, Submesh.NumVertices);
+    }
+
+    m_Bounds = Compute(0, static_cast<uint32_t>(m_Vertices.size()));
+}
+
+std::vector<uint8_t> MeshCooker::EncodeVertices() const
+{
+    if (!m_Options.Quantize)
+    {
+        const uint8_t* Data = reinterpret_cast<const uint8_t*>(m_Vertices.data());
+        return std::vector<uint8_t>(Data, Data + m_Vertices.size() * sizeof(MeshVertex));
+    }
+
+    std::vector<uint8_t> Data(m_Vertices.size() * sizeof(MeshQuantizedVertex));
+
+    for (size_t Index = 0; Index < m_Vertices.size(); ++Index)
+    {
+        const MeshVertex& Source = m_Vertices[Index];
+        MeshQuantizedVertex Vertex = {};
+
+        // The shader scales by the extent of the mesh bounds and adds their minimum
+        for (uint32_t Axis = 0; Axis < 3; ++Axis)
+        {
+            Vertex.Position[Axis] =
+                QuantizeUnorm16(Source.Position[Axis], m_Bounds.Min[Axis], m_Bounds.Max[Axis]);
+        }
+
+        Vertex.Normal =
+            PackSnorm1010102(Source.Normal[0], Source.Normal[1], Source.Normal[2], 0.0f);
+        Vertex.Tangent = PackSnorm1010102(
+            Source.Tangent[0], Source.Tangent[1], Source.Tangent[2], Source.Tangent[3]);
+        Vertex.TexCoord[0] = FloatToHalf(Source.TexCoord[0]);
+        Vertex.TexCoord[1] = FloatToHalf(Source.TexCoord[1]);
+
+        std::memcpy(Data.data() + Index * sizeof(MeshQuantizedVertex), &Vertex, sizeof(Vertex));
+    }
+
+    return Data;
+}
+
+bool MeshCooker::UsesLargeIndices() const
+{
+    // Indices are local to their submesh, only a submesh beyond 16 bits needs wide ones
+    for (const MeshSubmesh& Submesh : m_Submeshes)
+    {
+        if (Submesh.NumVertices > 65536)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "Core/MeshFile.h"
+#include "MeshOptimizer.h"
+#include "pch.h"
+
+struct MeshCookerOptions
+{
+    // Writes MeshQuantizedVertex instead of MeshVertex
+    bool Quantize = false;
+    // Applied to the positions at import, for instance 0.01 for centimeter assets
+    float Scale = 1.0f;
+    // Reorders triangles and vertices for the post-transform cache, overdraw and vertex fetch
+    bool Optimize = true;
+};
+
+// Imports a scene with assimp, bakes the node transforms into one vertex and one index list with
+// a submesh per source mesh and material, and writes the result as a mesh file
+class MeshCooker
+{
+public:
+    MeshCooker(const MeshCookerOptions& Options);
+    bool Import(const std::filesystem::path& Path);
+    bool Write(const std::filesystem::path& Path) const;
+    void PrintStatistics() const;
+
+private:
+    void Optimize();
+    void ComputeBounds();
+    std::vector<uint8_t> EncodeVertices() const;
+    bool UsesLargeIndices() const;
+
+    MeshCookerOptions m_Options;
+    std::vector<MeshVertex> m_Vertices;
+    // Relative to the first vertex of their submesh
+    std::vector<uint32_t> m_Indices;
+    std::vector<MeshSubmesh> m_Submeshes;
+    MeshBounds m_Bounds;
+    VertexCacheStatistics m_CacheBefore;
+    VertexCacheStatistics m_CacheAfter;
+};
@@ -0,0 +1,358 @@
+#include "MeshOptimizer.h"
+
+struct TriangleGeometry
+{
+    float Centroid[3];
+    // Cross product of two edges, twice the area in length
+    float Normal[3];
+    float Area;
+};
+
+static TriangleGeometry GetTriangleGeometry(
+    std::span<const uint32_t> Indices, std::span<const MeshVertex> Vertices, uint32_t Triangle)
+{
+    const float* A = Vertices[Indices[Triangle * 3]].Position;
+    const float* B = Vertices[Indices[Triangle * 3 + 1]].Position;
+    const float* C = Vertices[Indices[Triangle * 3 + 2]].Position;
+    float AB[3] = {B[0] - A[0], B[1] - A[1], B[2] - A[2]};
+    float AC[3] = {C[0] - A[0], C[1] - A[1], C[2] - A[2]};
+
+    TriangleGeometry Geometry = {};
+    Geometry.Normal[0] = AB[1] * AC[2] - AB[2] * AC[1];
+    Geometry.Normal[1] = AB[2] * AC[0] - AB[0] * AC[2];
+    Geometry.Normal[2] = AB[0] * AC[1] - AB[1] * AC[0];
+    Geometry.Area = 0.5f * std::sqrt(Geometry.Normal[0] * Geometry.Normal[0] +
+                                     Geometry.Normal[1] * Geometry.Normal[1] +
+                                     Geometry.Normal[2] * Geometry.Normal[2]);
+
+    for (uint32_t Axis = 0; Axis < 3; ++Axis)
+    {
+        Geometry.Centroid[Axis] = (A[Axis] + B[Axis] + C[Axis]) / 3.0f;
+    }
+
+    return Geometry;
+}
+
+void AnalyzeVertexCache(std::span<const uint32_t> Indices, uint32_t NumVertices,
+    uint32_t CacheSize, VertexCacheStatistics& Statistics)
+{
+    // A vertex is cached while fewer than CacheSize others were inserted after it
+    std::vector<uint32_t> CacheTime(NumVertices, 0);
+    std::vector<bool> Used(NumVertices, false);
+    uint32_t Timestamp = CacheSize + 1;
+
+    for (uint32_t Index : Indices)
+    {
+        if (Timestamp - CacheTime[Index] > CacheSize)
+        {
+            CacheTime[Index] = Timestamp++;
+            Statistics.NumTransformed++;
+        }
+
+        if (!Used[Index])
+        {
+            Used[Index] = true;
+            Statistics.NumVertices++;
+        }
+    }
+
+    Statistics.NumTriangles += Indices.size() / 3;
+}
+
+std::vector<uint32_t> OptimizeVertexCache(
+    std::span<uint32_t> Indices, uint32_t NumVertices, uint32_t CacheSize)
+{
+    uint32_t NumTriangles = static_cast<uint32_t>(Indices.size() / 3);
+
+    // Triangles around each vertex, packed by vertex
+    std::vector<uint32_t> LiveTriangles(NumVertices, 0);
+    for (uint32_t Index : Indices)
+    {
+        LiveTriangles[Index]++;
+    }
+
+    std::vector<uint32_t> Offsets(NumVertices + 1, 0);
+    for (uint32_t Vertex = 0; Vertex < NumVertices; ++Vertex)
+    {
+        Offsets[Vertex + 1] = Offsets[Vertex] + LiveTriangles[Vertex];
+    }
+
+    std::vector<uint32_t> Adjacency(Indices.size());
+    std::vector<uint32_t> Fill(Offsets.begin(), Offsets.end() - 1);
+    for (size_t Index = 0; Index < Indices.size(); ++Index)
+    {
+        Adjacency[Fill[Indices[Index]]++] = static_cast<uint32_t>(Index / 3);
+    }
+
+    std::vector<uint32_t> CacheTime(NumVertices, 0);
+    std::vector<bool> Emitted(NumTriangles, false);
+    std::vector<uint32_t> DeadEnds;
+    std::vector<uint32_t> Candidates;
+    std::vector<uint32_t> Output;
+    std::vector<uint32_t> Clusters;
+    uint32_t Timestamp = CacheSize + 1;
+    uint32_t Cursor = 0;
+
+    Output.reserve(Indices.size());
+
+    // Recently emitted vertices first, they may still be cached, then input order
+    auto Restart = [&]()
+    {
+        while (!DeadEnds.empty())
+        {
+            uint32_t Vertex = DeadEnds.back();
+            DeadEnds.pop_back();
+
+            if (LiveTriangles[Vertex] > 0)
+            {
+                return Vertex;
+            }
+        }
+
+        for (; Cursor < NumVertices; ++Cursor)
+        {
+            if (LiveTriangles[Cursor] > 0)
+            {
+                return Cursor;
+            }
+        }
+
+        return UINT32_MAX;
+    };
+
+    uint32_t Fan = Restart();
+    if (Fan != UINT32_MAX)
+    {
+        Clusters.push_back(0);
+    }
+
+    while (Fan != UINT32_MAX)
+    {
+        Candidates.clear();
+
+        for (uint32_t Entry = Offsets[Fan]; Entry < Offsets[Fan + 1]; ++Entry)
+        {
+            uint32_t Triangle = Adjacency[Entry];
+
+            if (Emitted[Triangle])
+            {
+                continue;
+            }
+
+            Emitted[Triangle] = true;
+
+            for (uint32_t Corner = 0; Corner < 3; ++Corner)
+            {
+                uint32_t Vertex = Indices[Triangle * 3 + Corner];
+                Output.push_back(Vertex);
+                DeadEnds.push_back(Vertex);
+                Candidates.push_back(Vertex);
+                LiveTriangles[Vertex]--;
+
+                if (Timestamp - CacheTime[Vertex] > CacheSize)
+                {
+                    CacheTime[Vertex] = Timestamp++;
+                }
+            }
+        }
+
+        // Fan next around the oldest candidate that stays cached while its remaining
+        // triangles are emitted, any live candidate beats a restart
+        uint32_t Next = UINT32_MAX;
+        int64_t BestPriority = -1;
+
+        for (uint32_t Vertex : Candidates)
+        {
+            if (LiveTriangles[Vertex] == 0)
+            {
+                continue;
+            }
+
+            int64_t Age = Timestamp - CacheTime[Vertex];
+            int64_t Priority = Age + 2 * LiveTriangles[Vertex] <= int64_t(CacheSize) ? Age : 0;
+
+            if (Priority > BestPriority)
+            {
+                BestPriority = Priority;
+                Next = Vertex;
+            }
+        }
+
+        if (Next == UINT32_MAX)
+        {
+            Next = Restart();
+
+            if (Next != UINT32_MAX)
+            {
+                Clusters.push_back(static_cast<uint32_t>(Output.size() / 3));
+            }
+        }
+
+        Fan = Next;
+    }
+
+    std::copy(Output.begin(), Output.end(), Indices.begin());
+    return Clusters;
+}
+
+void OptimizeOverdraw(std::span<uint32_t> Indices, std::span<const MeshVertex> Vertices,
+    std::span<const uint32_t> Clusters, uint32_t CacheSize, float Threshold)
+{
+    uint32_t NumTriangles = static_cast<uint32_t>(Indices.size() / 3);
+    uint32_t NumVertices = static_cast<uint32_t>(Vertices.size());
+
+    if (NumTriangles == 0)
+    {
+        return;
+    }
+
+    VertexCacheStatistics Statistics;
+    AnalyzeVertexCache(Indices, NumVertices, CacheSize, Statistics);
+    float TargetACMR = Statistics.GetACMR() * Threshold;
+
+    // Every cluster starts from a cold cache since it may end up after any other, a split is
+    // made as soon as the triangles since the last one reach the target
+    std::vector<uint32_t> Splits;
+    std::vector<uint32_t> CacheTime(NumVertices, 0);
+    uint32_t Timestamp = CacheSize + 1;
+
+    for (size_t Cluster = 0; Cluster < Clusters.size(); ++Cluster)
+    {
+        uint32_t End = Cluster + 1 < Clusters.size() ? Clusters[Cluster + 1] : NumTriangles;
+        uint32_t Start = Clusters[Cluster];
+        uint32_t NumTransformed = 0;
+
+        Splits.push_back(Start);
+        Timestamp += CacheSize + 1;
+
+        for (uint32_t Triangle = Start; Triangle < End; ++Triangle)
+        {
+            for (uint32_t Corner = 0; Corner < 3; ++Corner)
+            {
+                uint32_t Vertex = Indices[Triangle * 3 + Corner];
+
+                if (Timestamp - CacheTime[Vertex] > CacheSize)
+                {
+                    CacheTime[Vertex] = Timestamp++;
+                    NumTransformed++;
+                }
+            }
+
+            if (Triangle + 1 < End && NumTransformed <= TargetACMR * (Triangle + 1 - Start))
+            {
+                Start = Triangle + 1;
+                NumTransformed = 0;
+                Splits.push_back(Start);
+                Timestamp += CacheSize + 1;
+            }
+        }
+    }
+
+    float MeshCenter[3] = {};
+    float MeshArea = 0.0f;
+
+    for (uint32_t Triangle = 0; Triangle < NumTriangles; ++Triangle)
+    {
+        TriangleGeometry Geometry = GetTriangleGeometry(Indices, Vertices, Triangle);
+        MeshArea += Geometry.Area;
+
+        for (uint32_t Axis = 0; Axis < 3; ++Axis)
+        {
+            MeshCenter[Axis] += Geometry.Centroid[Axis] * Geometry.Area;
+        }
+    }
+
+    for (uint32_t Axis = 0; Axis < 3; ++Axis)
+    {
+        MeshCenter[Axis] = MeshArea > 0.0f ? MeshCenter[Axis] / MeshArea : 0.0f;
+    }
+
+    struct ClusterOrder
+    {
+        uint32_t Begin;
+        uint32_t End;
+        float Occlusion;
+    };
+
+    std::vector<ClusterOrder> Order(Splits.size());
+
+    for (size_t Cluster = 0; Cluster < Splits.size(); ++Cluster)
+    {
+        ClusterOrder& Entry = Order[Cluster];
+        Entry.Begin = Splits[Cluster];
+        Entry.End = Cluster + 1 < Splits.size() ? Splits[Cluster + 1] : NumTriangles;
+
+        float Center[3] = {};
+        float Normal[3] = {};
+        float Area = 0.0f;
+
+        for (uint32_t Triangle = Entry.Begin; Triangle < Entry.End; ++Triangle)
+        {
+            TriangleGeometry Geometry = GetTriangleGeometry(Indices, Vertices, Triangle);
+            Area += Geometry.Area;
+
+            for (uint32_t Axis = 0; Axis < 3; ++Axis)
+            {
+                Center[Axis] += Geometry.Centroid[Axis] * Geometry.Area;
+                Normal[Axis] += Geometry.Normal[Axis];
+            }
+        }
+
+        float NormalLength =
+            std::sqrt(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+
+        // How far the cluster lies out along the direction it faces, such clusters tend to
+        // cover the others and are drawn first
+        Entry.Occlusion = 0.0f;
+        if (Area > 0.0f && NormalLength > 0.0f)
+        {
+            for (uint32_t Axis = 0; Axis < 3; ++Axis)
+            {
+                Entry.Occlusion +=
+                    (Center[Axis] / Area - MeshCenter[Axis]) * Normal[Axis] / NormalLength;
+            }
+        }
+    }
+
+    std::stable_sort(Order.begin(), Order.end(),
+        [](const ClusterOrder& A, const ClusterOrder& B) { return A.Occlusion > B.Occlusion; });
+
+    std::vector<uint32_t> Output;
+    Output.reserve(Indices.size());
+
+    for (const ClusterOrder& Entry : Order)
+    {
+        Output.insert(Output.end(), Indices.begin() + Entry.Begin * 3,
+            Indices.begin() + Entry.End * 3);
+    }
+
+    std::copy(Output.begin(), Output.end(), Indices.begin());
+}
+
+uint32_t OptimizeVertexFetch(std::span<MeshVertex> Vertices, std::span<uint32_t> Indices)
+{
+    std::vector<uint32_t> Remap(Vertices.size(), UINT32_MAX);
+    uint32_t NumUsed = 0;
+
+    for (uint32_t& Index : Indices)
+    {
+        if (Remap[Index] == UINT32_MAX)
+        {
+            Remap[Index] = NumUsed++;
+        }
+
+        Index = Remap[Index];
+    }
+
+    std::vector<MeshVertex> Reordered(NumUsed);
+    for (size_t Vertex = 0; Vertex < Vertices.size(); ++Vertex)
+    {
+        if (Remap[Vertex] != UINT32_MAX)
+        {
+            Reordered[Remap[Vertex]] = Vertices[Vertex];
+        }
+    }
+
+    std::copy(Reordered.begin(), Reordered.end(), Vertices.begin());
+    return NumUsed;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "Core/MeshFile.h"
+#include "pch.h"
+
+// Post-transform cache size the index order is tuned for, small enough to suit every GPU
+#define MESH_OPTIMIZER_CACHE_SIZE 16
+// A cluster may end once its own ACMR is within this factor of the whole mesh, higher values
+// give more and smaller clusters to sort against overdraw at the cost of vertex reuse
+#define MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+struct VertexCacheStatistics
+{
+    uint64_t NumTransformed = 0;
+    uint64_t NumTriangles = 0;
+    uint64_t NumVertices = 0;
+
+    // Average cache miss ratio, vertices transformed per triangle, 0.5 at best
+    float GetACMR() const { return NumTriangles ? float(NumTransformed) / NumTriangles : 0.0f; }
+    // Average transform to vertex ratio, 1 at best
+    float GetATVR() const { return NumVertices ? float(NumTransformed) / NumVertices : 0.0f; }
+};
+
+// Simulates a FIFO post-transform cache over a triangle list and accumulates into Statistics
+void AnalyzeVertexCache(std::span<const uint32_t> Indices, uint32_t NumVertices,
+    uint32_t CacheSize, VertexCacheStatistics& Statistics);
+
+// Tipsify (Sander, Nehab and Barczak 2007). Reorders the triangles for vertex reuse and returns
+// the first triangle of every cluster, where the walk had to restart away from the cache
+std::vector<uint32_t> OptimizeVertexCache(
+    std::span<uint32_t> Indices, uint32_t NumVertices, uint32_t CacheSize);
+
+// Splits the clusters further where vertex reuse allows, then draws the outward facing clusters
+// on the outside of the mesh first so they occlude the rest from most directions
+void OptimizeOverdraw(std::span<uint32_t> Indices, std::span<const MeshVertex> Vertices,
+    std::span<const uint32_t> Clusters, uint32_t CacheSize, float Threshold);
+
+// Orders the vertices by first use and remaps the indices, returns the number of vertices still
+// referenced which now come first
+uint32_t OptimizeVertexFetch(std::span<MeshVertex> Vertices, std::span<uint32_t> Indices);
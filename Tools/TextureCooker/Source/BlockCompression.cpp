@@ -0,0 +1,350 @@
+#include "BlockCompression.h"
+
+#include <cfloat>
+
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+
+// Interpolation weights of the 4 bit BC7 indices, out of 64
+static const int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BC7Endpoints
+{
+    // 7 bit values per channel and the shared lowest bit of each endpoint
+    uint8_t Quantized[2][4];
+    uint8_t PBits[2];
+    // The 8 bit values the decoder reconstructs
+    int Expanded[2][4];
+};
+
+struct BC7BitWriter
+{
+    uint8_t* Block;
+    uint32_t Position;
+
+    void Write(uint32_t Value, uint32_t NumBits)
+    {
+        for (uint32_t Bit = 0; Bit < NumBits; ++Bit, ++Position)
+        {
+            Block[Position >> 3] |= static_cast<uint8_t>(((Value >> Bit) & 1) << (Position & 7));
+        }
+    }
+};
+
+// Picks the lowest bit that brings all four channels of the endpoint closest
+static void QuantizeBC7Endpoint(const float Endpoint[4], BC7Endpoints& Out, uint32_t Index)
+{
+    float BestError = FLT_MAX;
+
+    for (uint8_t PBit = 0; PBit < 2; ++PBit)
+    {
+        uint8_t Quantized[4];
+        float Error = 0.0f;
+
+        for (uint32_t Channel = 0; Channel < 4; ++Channel)
+        {
+            long Value = std::lround((Endpoint[Channel] - PBit) * 0.5f);
+            Quantized[Channel] = static_cast<uint8_t>(std::clamp(Value, 0l, 127l));
+
+            float Delta = static_cast<float>((Quantized[Channel] << 1) | PBit) - Endpoint[Channel];
+            Error += Delta * Delta;
+        }
+
+        if (Error < BestError)
+        {
+            BestError = Error;
+            Out.PBits[Index] = PBit;
+
+            for (uint32_t Channel = 0; Channel < 4; ++Channel)
+            {
+                Out.Quantized[Index][Channel] = Quantized[Channel];
+                Out.Expanded[Index][Channel] = (Quantized[Channel] << 1) | PBit;
+            }
+        }
+    }
+}
+
+static uint32_t SelectBC7Indices(
+    const uint8_t* Texels, const BC7Endpoints& Endpoints, uint8_t OutIndices[16])
+{
+    int Palette[16][4];
+    for (uint32_t Index = 0; Index < 16; ++Index)
+    {
+        for (uint32_t Channel = 0; Channel < 4; ++Channel)
+        {
+            Palette[Index][Channel] = ((64 - BC7_WEIGHTS[Index]) * Endpoints.Expanded[0][Channel] +
+                                          BC7_WEIGHTS[Index] * Endpoints.Expanded[1][Channel] +
+                                          32) >>
+                                      6;
+        }
+    }
+
+    uint32_t TotalError = 0;
+
+    for (uint32_t Texel = 0; Texel < 16; ++Texel)
+    {
+        uint32_t BestError = UINT32_MAX;
+
+        for (uint32_t Index = 0; Index < 16; ++Index)
+        {
+            uint32_t Error = 0;
+            for (uint32_t Channel = 0; Channel < 4; ++Channel)
+            {
+                int Delta = Palette[Index][Channel] - Texels[Texel * 4 + Channel];
+                Error += static_cast<uint32_t>(Delta * Delta);
+            }
+
+            if (Error < BestError)
+            {
+                BestError = Error;
+                OutIndices[Texel] = static_cast<uint8_t>(Index);
+            }
+        }
+
+        TotalError += BestError;
+    }
+
+    return TotalError;
+}
+
+// Mode 6 only: one subset, 7 bit RGBA endpoints with a p-bit each and 4 bit indices. It covers
+// opaque and transparent blocks alike, the partitioned modes would add quality on blocks with
+// several distinct colors at a large cost in encoding time
+static void EncodeBC7Block(const uint8_t* Texels, uint8_t* OutBlock)
+{
+    float Mean[4] = {};
+    for (uint32_t Texel = 0; Texel < 16; ++Texel)
+    {
+        for (uint32_t Channel = 0; Channel < 4; ++Channel)
+        {
+            Mean[Channel] += Texels[Texel * 4 + Channel] / 16.0f;
+        }
+    }
+
+    float Covariance[4][4] = {};
+    for (uint32_t Texel = 0; Texel < 16; ++Texel)
+    {
+        for (uint32_t Row = 0; Row < 4; ++Row)
+        {
+            for (uint32_t Column = 0; Column < 4; ++Column)
+            {
+                Covariance[Row][Column] += (Texels[Texel * 4 + Row] - Mean[Row]) *
+                                           (Texels[Texel * 4 + Column] - Mean[Column]);
+            }
+        }
+    }
+
+    // Principal axis by power iteration
+    float Axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for (uint32_t Iteration = 0; Iteration < 8; ++Iteration)
+    {
+        float Next[4] = {};
+        float Length = 0.0f;
+
+        for (uint32_t Row = 0; Row < 4; ++Row)
+        {
+            for (uint32_t Column = 0; Column < 4; ++Column)
+            {
+                Next[Row] += Covariance[Row][Column] * Axis[Column];
+            }
+
+            Length += Next[Row] * Next[Row];
+        }
+
+        if (Length < 1e-8f)
+        {
+            break;
+        }
+
+        for (uint32_t Channel = 0; Channel < 4; ++Channel)
+        {
+            Axis[Channel] = Next[Channel] / std::sqrt(Length);
+        }
+    }
+
+    float MinProjection = FLT_MAX;
+    float MaxProjection = -FLT_MAX;
+    for (uint32_t Texel = 0; Texel < 16; ++Texel)
+    {
+        float Projection = 0.0f;
+        for (uint32_t Channel = 0; Channel < 4; ++Channel)
+        {
+            Projection += (Texels[Texel * 4 + Channel] - Mean[Channel]) * Axis[Channel];
+        }
+
+        MinProjection = std::min(MinProjection, Projection);
+        MaxProjection = std::max(MaxProjection, Projection);
+    }
+
+    float Endpoints[2][4];
+    for (uint32_t Channel = 0; Channel < 4; ++Channel)
+    {
+        Endpoints[0][Channel] =
+            std::clamp(Mean[Channel] + MinProjection * Axis[Channel], 0.0f, 255.0f);
+        Endpoints[1][Channel] =
+            std::clamp(Mean[Channel] + MaxProjection * Axis[Channel], 0.0f, 255.0f);
+    }
+
+    BC7Endpoints Best;
+    uint8_t BestIndices[16];
+    QuantizeBC7Endpoint(Endpoints[0], Best, 0);
+    QuantizeBC7Endpoint(Endpoints[1], Best, 1);
+    uint32_t BestError = SelectBC7Indices(Texels, Best, BestIndices);
+
+    // Least squares endpoints for the chosen indices, kept while they lower the error
+    for (uint32_t Iteration = 0; Iteration < 2 && BestError > 0; ++Iteration)
+    {
+        float A = 0.0f;
+        float B = 0.0f;
+        float C = 0.0f;
+        float X0[4] = {};
+        float X1[4] = {};
+
+        for (uint32_t Texel = 0; Texel < 16; ++Texel)
+        {
+            float Weight = BC7_WEIGHTS[BestIndices[Texel]] / 64.0f;
+            A += (1.0f - Weight) * (1.0f - Weight);
+            B += (1.0f - Weight) * Weight;
+            C += Weight * Weight;
+
+            for (uint32_t Channel = 0; Channel < 4; ++Channel)
+            {
+                X0[Channel] += (1.0f - Weight) * Texels[Texel * 4 + Channel];
+                X1[Channel] += Weight * Texels[Texel * 4 + Channel];
+            }
+        }
+
+        float Determinant = A * C - B * B;
+        if (std::abs(Determinant) < 1e-6f)
+        {
+            break;
+        }
+
+        for (uint32_t Channel = 0; Channel < 4; ++Channel)
+        {
+            Endpoints[0][Channel] =
+                std::clamp((C * X0[Channel] - B * X1[Channel]) / Determinant, 0.0f, 255.0f);
+            Endpoints[1][Channel] =
+                std::clamp((A * X1[Channel] - B * X0[Channel]) / Determinant, 0.0f, 255.0f);
+        }
+
+        BC7Endpoints Refined;
+        uint8_t Indices[16];
+        QuantizeBC7Endpoint(Endpoints[0], Refined, 0);
+        QuantizeBC7Endpoint(Endpoints[1], Refined, 1);
+        uint32_t Error = SelectBC7Indices(Texels, Refined, Indices);
+
+        if (Error >= BestError)
+        {
+            break;
+        }
+
+        Best = Refined;
+        BestError = Error;
+        std::memcpy(BestIndices, Indices, sizeof(Indices));
+    }
+
+    // The first index is stored without its top bit, which therefore has to be zero
+    if (BestIndices[0] & 8)
+    {
+        std::swap(Best.Quantized[0], Best.Quantized[1]);
+        std::swap(Best.PBits[0], Best.PBits[1]);
+
+        for (uint8_t& Index : BestIndices)
+        {
+            Index = static_cast<uint8_t>(15 - Index);
+        }
+    }
+
+    std::memset(OutBlock, 0, 16);
+    BC7BitWriter Writer = {OutBlock, 0};
+    Writer.Write(1 << 6, 7);
+
+    for (uint32_t Channel = 0; Channel < 4; ++Channel)
+    {
+        Writer.Write(Best.Quantized[0][Channel], 7);
+        Writer.Write(Best.Quantized[1][Channel], 7);
+    }
+
+    Writer.Write(Best.PBits[0], 1);
+    Writer.Write(Best.PBits[1], 1);
+
+    for (uint32_t Texel = 0; Texel < 16; ++Texel)
+    {
+        Writer.Write(BestIndices[Texel], Texel == 0 ? 3 : 4);
+    }
+}
+
+const char* GetFormatName(TextureFormat Format)
+{
+    static const char* Names[] = {"rgba8", "bc1", "bc3", "bc5", "bc7"};
+    return Names[static_cast<uint32_t>(Format)];
+}
+
+uint32_t GetBlockSize(TextureFormat Format)
+{
+    switch (Format)
+    {
+    case TextureFormat::BC1:
+        return 8;
+    case TextureFormat::BC3:
+    case TextureFormat::BC5:
+    case TextureFormat::BC7:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+uint32_t GetBlockExtent(TextureFormat Format)
+{
+    return Format == TextureFormat::RGBA8 ? 1 : 4;
+}
+
+VkFormat GetVulkanFormat(TextureFormat Format, bool Srgb)
+{
+    switch (Format)
+    {
+    case TextureFormat::BC1:
+        return Srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    case TextureFormat::BC3:
+        return Srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+    case TextureFormat::BC5:
+        return VK_FORMAT_BC5_UNORM_BLOCK;
+    case TextureFormat::BC7:
+        return Srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    default:
+        return Srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+void EncodeBlock(TextureFormat Format, const uint8_t* Texels, uint8_t* OutBlock)
+{
+    switch (Format)
+    {
+    case TextureFormat::BC1:
+        stb_compress_dxt_block(OutBlock, Texels, 0, STB_DXT_HIGHQUAL);
+        break;
+    case TextureFormat::BC3:
+        stb_compress_dxt_block(OutBlock, Texels, 1, STB_DXT_HIGHQUAL);
+        break;
+    case TextureFormat::BC5:
+    {
+        uint8_t Channels[32];
+        for (uint32_t Texel = 0; Texel < 16; ++Texel)
+        {
+            Channels[Texel * 2] = Texels[Texel * 4];
+            Channels[Texel * 2 + 1] = Texels[Texel * 4 + 1];
+        }
+
+        stb_compress_bc5_block(OutBlock, Channels);
+        break;
+    }
+    case TextureFormat::BC7:
+        EncodeBC7Block(Texels, OutBlock);
+        break;
+    default:
+        std::memcpy(OutBlock, Texels, 4);
+        break;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "pch.h"
+
+enum class TextureFormat
+{
+    RGBA8 = 0,
+    // Color, alpha is dropped
+    BC1,
+    // Color with interpolated alpha
+    BC3,
+    // Two independent channels, normal maps
+    BC5,
+    // Color and alpha at the quality of BC3 and up
+    BC7,
+    COUNT
+};
+
+const char* GetFormatName(TextureFormat Format);
+uint32_t GetBlockSize(TextureFormat Format);
+uint32_t GetBlockExtent(TextureFormat Format);
+VkFormat GetVulkanFormat(TextureFormat Format, bool Srgb);
+
+// Encodes a 4x4 block of RGBA8 texels in row order, or copies a single texel for RGBA8
+void EncodeBlock(TextureFormat Format, const uint8_t* Texels, uint8_t* OutBlock);
@@ -0,0 +1,96 @@
+#include "TextureCooker.h"
+
+static void PrintUsage()
+{
+    std::printf("Usage: TextureCooker <input> <output> [--format rgba8|bc1|bc3|bc5|bc7] [--linear] "
+                "[--normal] [--threads <count>]\n");
+}
+
+static bool ParseFormat(std::string_view Name, TextureFormat& OutFormat)
+{
+    for (uint32_t Index = 0; Index < static_cast<uint32_t>(TextureFormat::COUNT); ++Index)
+    {
+        if (Name == GetFormatName(static_cast<TextureFormat>(Index)))
+        {
+            OutFormat = static_cast<TextureFormat>(Index);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int main(int NumArguments, char** Arguments)
+{
+    if (NumArguments < 3)
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path InputPath = Arguments[1];
+    std::filesystem::path OutputPath = Arguments[2];
+    TextureCookerOptions Options;
+    bool HasFormat = false;
+    uint32_t NumThreads = 0;
+
+    for (int Index = 3; Index < NumArguments; ++Index)
+    {
+        std::string_view Argument = Arguments[Index];
+
+        if (Argument == "--format" && Index + 1 < NumArguments &&
+            ParseFormat(Arguments[Index + 1], Options.Format))
+        {
+            HasFormat = true;
+            ++Index;
+        }
+        else if (Argument == "--linear")
+        {
+            Options.Linear = true;
+        }
+        else if (Argument == "--normal")
+        {
+            Options.Normal = true;
+        }
+        else if (Argument == "--threads" && Index + 1 < NumArguments)
+        {
+            NumThreads = static_cast<uint32_t>(std::strtoul(Arguments[++Index], nullptr, 10));
+        }
+        else
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Two channel normals keep twice the precision of BC7 at the same size
+    if (Options.Normal && !HasFormat)
+    {
+        Options.Format = TextureFormat::BC5;
+    }
+
+    auto Start = std::chrono::steady_clock::now();
+
+    TextureCooker Cooker(Options);
+    if (!Cooker.Import(InputPath))
+    {
+        return EXIT_FAILURE;
+    }
+
+    JobSystem Jobs;
+    Jobs.Init(NumThreads);
+    Cooker.Encode(Jobs);
+    Jobs.Destroy();
+
+    if (!Cooker.Write(OutputPath))
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::chrono::duration<double, std::milli> Elapsed = std::chrono::steady_clock::now() - Start;
+
+    std::printf("Cooked %s to %s in %.1f ms\n", InputPath.string().c_str(),
+        OutputPath.string().c_str(), Elapsed.count());
+    Cooker.PrintStatistics();
+    return EXIT_SUCCESS;
+}
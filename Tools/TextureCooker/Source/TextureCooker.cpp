@@ -0,0 +1,380 @@
+#include "TextureCooker.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define TEXTURE_COOKER_SSE
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// Source texels contributing to one destination texel of a downsample, at most three when an odd
+// size is halved
+struct FilterTaps
+{
+    uint32_t First;
+    uint32_t Count;
+    float Weights[3];
+};
+
+static uint64_t AlignOffset(uint64_t Offset)
+{
+    return (Offset + TEXTURE_FILE_ALIGNMENT - 1) & ~uint64_t(TEXTURE_FILE_ALIGNMENT - 1);
+}
+
+static float SrgbToLinear(float Value)
+{
+    return Value <= 0.04045f ? Value / 12.92f : std::pow((Value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSrgb(float Value)
+{
+    return Value <= 0.0031308f ? Value * 12.92f : 1.055f * std::pow(Value, 1.0f / 2.4f) - 0.055f;
+}
+
+static uint8_t FloatToUnorm8(float Value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(Value, 0.0f, 1.0f) * 255.0f));
+}
+
+// Box filter over the footprint of each destination texel, weighted by coverage so odd sizes
+// keep every source texel at its share
+static std::vector<FilterTaps> ComputeTaps(uint32_t SourceSize, uint32_t DestinationSize)
+{
+    std::vector<FilterTaps> Taps(DestinationSize);
+    float Scale = static_cast<float>(SourceSize) / DestinationSize;
+
+    for (uint32_t Index = 0; Index < DestinationSize; ++Index)
+    {
+        float Begin = Index * Scale;
+        float End = Begin + Scale;
+        FilterTaps& Tap = Taps[Index];
+
+        // The tolerance keeps rounding from adding a tap of zero weight at either end
+        uint32_t Last = static_cast<uint32_t>(std::ceil(End - 1e-4f));
+        Tap.First = static_cast<uint32_t>(Begin + 1e-4f);
+        Tap.Count = std::min({Last, SourceSize, Tap.First + 3}) - Tap.First;
+
+        for (uint32_t Texel = 0; Texel < Tap.Count; ++Texel)
+        {
+            float Position = static_cast<float>(Tap.First + Texel);
+            float Coverage = std::min(End, Position + 1.0f) - std::max(Begin, Position);
+            Tap.Weights[Texel] = Coverage / Scale;
+        }
+    }
+
+    return Taps;
+}
+
+// Weighted sum of RGBA texels Stride floats apart
+static void FilterTexel(const float* Source, size_t Stride, const FilterTaps& Taps, float* Out)
+{
+#ifdef TEXTURE_COOKER_SSE
+    __m128 Sum = _mm_setzero_ps();
+
+    for (uint32_t Index = 0; Index < Taps.Count; ++Index)
+    {
+        __m128 Texel = _mm_loadu_ps(Source + (Taps.First + Index) * Stride);
+        Sum = _mm_add_ps(Sum, _mm_mul_ps(Texel, _mm_set1_ps(Taps.Weights[Index])));
+    }
+
+    _mm_storeu_ps(Out, Sum);
+#else
+    float Sum[4] = {};
+
+    for (uint32_t Index = 0; Index < Taps.Count; ++Index)
+    {
+        const float* Texel = Source + (Taps.First + Index) * Stride;
+
+        for (uint32_t Channel = 0; Channel < 4; ++Channel)
+        {
+            Sum[Channel] += Texel[Channel] * Taps.Weights[Index];
+        }
+    }
+
+    std::memcpy(Out, Sum, sizeof(Sum));
+#endif
+}
+
+TextureCooker::TextureCooker(const TextureCookerOptions& Options)
+    : m_Options(Options), m_NumThreads(0), m_EncodeMilliseconds(0.0)
+{
+}
+
+bool TextureCooker::Import(const std::filesystem::path& Path)
+{
+    int Width = 0;
+    int Height = 0;
+    int NumChannels = 0;
+    stbi_uc* Pixels = stbi_load(Path.string().c_str(), &Width, &Height, &NumChannels, 4);
+
+    if (!Pixels)
+    {
+        std::fprintf(stderr, "Failed to decode %s: %s\n", Path.string().c_str(),
+            stbi_failure_reason());
+        return false;
+    }
+
+    if (std::max(Width, Height) > (1 << (TEXTURE_FILE_MAX_LEVELS - 1)))
+    {
+        std::fprintf(stderr, "%s is %dx%d, larger than a texture file can hold\n",
+            Path.string().c_str(), Width, Height);
+        stbi_image_free(Pixels);
+        return false;
+    }
+
+    // The top level keeps the source texels exactly, the filtering happens on a float copy
+    MipLevel Level = {};
+    Level.Width = static_cast<uint32_t>(Width);
+    Level.Height = static_cast<uint32_t>(Height);
+    Level.Texels.assign(Pixels, Pixels + size_t(Width) * Height * 4);
+    stbi_image_free(Pixels);
+
+    float ToLinear[256];
+    for (uint32_t Value = 0; Value < 256; ++Value)
+    {
+        ToLinear[Value] = IsSrgb() ? SrgbToLinear(Value / 255.0f) : Value / 255.0f;
+    }
+
+    std::vector<float> Image(Level.Texels.size());
+    for (size_t Texel = 0; Texel < Image.size(); Texel += 4)
+    {
+        const uint8_t* Source = &Level.Texels[Texel];
+        float Alpha = Source[3] / 255.0f;
+
+        // Normals are averaged as vectors, anything else premultiplied so transparent texels
+        // do not bleed their color into the smaller levels
+        for (uint32_t Channel = 0; Channel < 3; ++Channel)
+        {
+            Image[Texel + Channel] = m_Options.Normal ? Source[Channel] / 127.5f - 1.0f
+                                                      : ToLinear[Source[Channel]] * Alpha;
+        }
+
+        Image[Texel + 3] = Alpha;
+    }
+
+    m_Levels.clear();
+    m_Levels.push_back(std::move(Level));
+    GenerateLevels(std::move(Image));
+    return true;
+}
+
+void TextureCooker::Encode(JobSystem& Jobs)
+{
+    auto Start = std::chrono::steady_clock::now();
+
+    // All levels are queued at once so the small ones fill in behind the large ones
+    JobCounter Counter;
+    for (MipLevel& Level : m_Levels)
+    {
+        EncodeLevel(Jobs, Level, Counter);
+    }
+
+    Jobs.Wait(Counter);
+
+    std::chrono::duration<double, std::milli> Elapsed = std::chrono::steady_clock::now() - Start;
+    m_NumThreads = Jobs.GetNumThreads();
+    m_EncodeMilliseconds = Elapsed.count();
+}
+
+bool TextureCooker::Write(const std::filesystem::path& Path) const
+{
+    TextureFileHeader Header = {};
+    Header.Magic = TEXTURE_FILE_MAGIC;
+    Header.Version = TEXTURE_FILE_VERSION;
+    Header.Format = GetVulkanFormat(m_Options.Format, IsSrgb());
+    Header.Width = m_Levels[0].Width;
+    Header.Height = m_Levels[0].Height;
+    Header.NumLevels = static_cast<uint32_t>(m_Levels.size());
+    Header.BlockSize = GetBlockSize(m_Options.Format);
+    Header.BlockExtent = GetBlockExtent(m_Options.Format);
+
+    // Smallest level first, a streamer reading front to back gets a usable texture early
+    uint64_t Offset = AlignOffset(sizeof(Header));
+    for (size_t Index = m_Levels.size(); Index-- > 0;)
+    {
+        const MipLevel& Level = m_Levels[Index];
+        TextureLevel& Info = Header.Levels[Index];
+        uint32_t BlocksWide = (Level.Width + Header.BlockExtent - 1) / Header.BlockExtent;
+
+        Info.Offset = Offset;
+        Info.Size = Level.Blocks.size();
+        Info.Width = Level.Width;
+        Info.Height = Level.Height;
+        Info.RowPitch = BlocksWide * Header.BlockSize;
+        Offset = AlignOffset(Offset + Info.Size);
+    }
+
+    std::vector<uint8_t> Data(Offset, 0);
+    std::memcpy(Data.data(), &Header, sizeof(Header));
+
+    for (size_t Index = 0; Index < m_Levels.size(); ++Index)
+    {
+        std::memcpy(Data.data() + Header.Levels[Index].Offset, m_Levels[Index].Blocks.data(),
+            m_Levels[Index].Blocks.size());
+    }
+
+    // A failed cook leaves the previous output in place
+    std::filesystem::path TemporaryPath = Path;
+    TemporaryPath += ".tmp";
+
+    {
+        std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+        File.write(reinterpret_cast<const char*>(Data.data()), Data.size());
+        File.flush();
+
+        if (!File)
+        {
+            std::fprintf(stderr, "Failed to write %s\n", TemporaryPath.string().c_str());
+            return false;
+        }
+    }
+
+    std::error_code Error;
+    std::filesystem::rename(TemporaryPath, Path, Error);
+
+    if (Error)
+    {
+        std::fprintf(stderr, "Failed to replace %s: %s\n", Path.string().c_str(),
+            Error.message().c_str());
+        std::filesystem::remove(TemporaryPath, Error);
+        return false;
+    }
+
+    return true;
+}
+
+void TextureCooker::PrintStatistics() const
+{
+    size_t NumTexels = 0;
+    size_t NumBytes = 0;
+
+    for (const MipLevel& Level : m_Levels)
+    {
+        NumTexels += size_t(Level.Width) * Level.Height;
+        NumBytes += Level.Blocks.size();
+    }
+
+    std::printf("%ux%u %s%s, %zu levels, %.2f MiB (%.2f bits per texel)\n", m_Levels[0].Width,
+        m_Levels[0].Height, GetFormatName(m_Options.Format), IsSrgb() ? " srgb" : "",
+        m_Levels.size(), NumBytes / (1024.0 * 1024.0), NumBytes * 8.0 / NumTexels);
+    std::printf("Encoded %.2f Mtexels in %.1f ms on %u threads, %.1f Mtexels/s\n",
+        NumTexels / 1e6, m_EncodeMilliseconds, m_NumThreads,
+        NumTexels / 1e3 / std::max(m_EncodeMilliseconds, 1e-3));
+}
+
+void TextureCooker::GenerateLevels(std::vector<float> Image)
+{
+    uint32_t Width = m_Levels[0].Width;
+    uint32_t Height = m_Levels[0].Height;
+
+    while (Width > 1 || Height > 1)
+    {
+        uint32_t NextWidth = std::max(Width / 2, 1u);
+        uint32_t NextHeight = std::max(Height / 2, 1u);
+        std::vector<FilterTaps> TapsX = ComputeTaps(Width, NextWidth);
+        std::vector<FilterTaps> TapsY = ComputeTaps(Height, NextHeight);
+
+        // Separable, rows first into a buffer of the final width
+        std::vector<float> Rows(size_t(NextWidth) * Height * 4);
+        for (uint32_t Y = 0; Y < Height; ++Y)
+        {
+            for (uint32_t X = 0; X < NextWidth; ++X)
+            {
+                FilterTexel(&Image[size_t(Y) * Width * 4], 4, TapsX[X],
+                    &Rows[(size_t(Y) * NextWidth + X) * 4]);
+            }
+        }
+
+        std::vector<float> Next(size_t(NextWidth) * NextHeight * 4);
+        for (uint32_t Y = 0; Y < NextHeight; ++Y)
+        {
+            for (uint32_t X = 0; X < NextWidth; ++X)
+            {
+                FilterTexel(&Rows[size_t(X) * 4], size_t(NextWidth) * 4, TapsY[Y],
+                    &Next[(size_t(Y) * NextWidth + X) * 4]);
+            }
+        }
+
+        MipLevel Level = {};
+        Level.Width = NextWidth;
+        Level.Height = NextHeight;
+        Level.Texels.resize(Next.size());
+
+        for (size_t Texel = 0; Texel < Next.size(); Texel += 4)
+        {
+            const float* Source = &Next[Texel];
+            uint8_t* Destination = &Level.Texels[Texel];
+
+            if (m_Options.Normal)
+            {
+                float Length = std::sqrt(
+                    Source[0] * Source[0] + Source[1] * Source[1] + Source[2] * Source[2]);
+                float Scale = Length > 1e-6f ? 1.0f / Length : 0.0f;
+
+                for (uint32_t Channel = 0; Channel < 3; ++Channel)
+                {
+                    Destination[Channel] = FloatToUnorm8(Source[Channel] * Scale * 0.5f + 0.5f);
+                }
+            }
+            else
+            {
+                float Scale = Source[3] > 1e-6f ? 1.0f / Source[3] : 0.0f;
+
+                for (uint32_t Channel = 0; Channel < 3; ++Channel)
+                {
+                    float Value = std::clamp(Source[Channel] * Scale, 0.0f, 1.0f);
+                    Destination[Channel] = FloatToUnorm8(IsSrgb() ? LinearToSrgb(Value) : Value);
+                }
+            }
+
+            Destination[3] = FloatToUnorm8(Source[3]);
+        }
+
+        m_Levels.push_back(std::move(Level));
+        Image = std::move(Next);
+        Width = NextWidth;
+        Height = NextHeight;
+    }
+}
+
+void TextureCooker::EncodeLevel(JobSystem& Jobs, MipLevel& Level, JobCounter& Counter) const
+{
+    TextureFormat Format = m_Options.Format;
+    uint32_t Extent = GetBlockExtent(Format);
+    uint32_t BlockSize = GetBlockSize(Format);
+    uint32_t BlocksWide = (Level.Width + Extent - 1) / Extent;
+    uint32_t BlocksHigh = (Level.Height + Extent - 1) / Extent;
+
+    Level.Blocks.resize(size_t(BlocksWide) * BlocksHigh * BlockSize);
+
+    Jobs.ParallelFor(
+        BlocksHigh, TEXTURE_COOKER_BATCH_SIZE,
+        [&Level, Format, Extent, BlockSize, BlocksWide](uint32_t Begin, uint32_t End)
+        {
+            uint8_t Texels[16 * 4];
+
+            for (uint32_t BlockY = Begin; BlockY < End; ++BlockY)
+            {
+                for (uint32_t BlockX = 0; BlockX < BlocksWide; ++BlockX)
+                {
+                    // Blocks past the edge repeat the last row and column
+                    for (uint32_t Y = 0; Y < Extent; ++Y)
+                    {
+                        uint32_t SourceY = std::min(BlockY * Extent + Y, Level.Height - 1);
+
+                        for (uint32_t X = 0; X < Extent; ++X)
+                        {
+                            uint32_t SourceX = std::min(BlockX * Extent + X, Level.Width - 1);
+                            std::memcpy(&Texels[(Y * Extent + X) * 4],
+                                &Level.Texels[(size_t(SourceY) * Level.Width + SourceX) * 4], 4);
+                        }
+                    }
+
+                    size_t Offset = (size_t(BlockY) * BlocksWide + BlockX) * BlockSize;
+                    EncodeBlock(Format, Texels, &Level.Blocks[Offset]);
+                }
+            }
+        },
+        &Counter);
+}
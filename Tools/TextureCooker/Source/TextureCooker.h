@@ -0,0 +1,51 @@
+#pragma once
+#include "BlockCompression.h"
+#include "Core/JobSystem.h"
+#include "Core/TextureFile.h"
+#include "pch.h"
+
+// Block rows encoded by one job
+#define TEXTURE_COOKER_BATCH_SIZE 4
+
+struct TextureCookerOptions
+{
+    TextureFormat Format = TextureFormat::BC7;
+    // Data textures are filtered as stored, color textures in linear space and written as sRGB
+    bool Linear = false;
+    // Tangent space normal map, the vectors are renormalized at every level
+    bool Normal = false;
+};
+
+// Decodes an image with stb, filters the full mip chain in linear premultiplied space, encodes
+// the levels on the job system and writes the result as a texture file
+class TextureCooker
+{
+public:
+    TextureCooker(const TextureCookerOptions& Options);
+    bool Import(const std::filesystem::path& Path);
+    void Encode(JobSystem& Jobs);
+    bool Write(const std::filesystem::path& Path) const;
+    void PrintStatistics() const;
+
+private:
+    struct MipLevel
+    {
+        uint32_t Width;
+        uint32_t Height;
+        // RGBA8 texels as the encoder consumes them
+        std::vector<uint8_t> Texels;
+        std::vector<uint8_t> Blocks;
+    };
+
+    void GenerateLevels(std::vector<float> Image);
+    void EncodeLevel(JobSystem& Jobs, MipLevel& Level, JobCounter& Counter) const;
+    bool IsSrgb() const
+    {
+        return !m_Options.Linear && !m_Options.Normal && m_Options.Format != TextureFormat::BC5;
+    }
+
+    TextureCookerOptions m_Options;
+    std::vector<MipLevel> m_Levels;
+    uint32_t m_NumThreads;
+    double m_EncodeMilliseconds;
+};